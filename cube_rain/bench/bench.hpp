@@ -0,0 +1,168 @@
+#pragma once
+/*! \file
+Micro benchmark harness. Each benchmark is warmed up, then timed for several
+repetitions, the result is median time per operation with median absolute
+deviation (MAD) and time stamp counter cycles per operation (x86 only).
+
+\code
+bench::suite s{argc, argv};
+s.run("mat4 multiply", ops, [&]{
+	for (size_t i = 0; i < ops; ++i)
+		out[i] = a[i] * b[i];
+	bench::do_not_optimize(out);
+});
+s.report();
+\endcode
+
+command line options (for all benchmark programs using the harness)
+	--reps N  timed repetitions (default 21)
+	--warmup N  untimed repetitions (default 3)
+	--filter TEXT  runs only benchmarks with TEXT in the name
+	--json FILE  writes results as JSON for trend comparison ('-' for stdout) */
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define BENCH_HAS_TSC
+#endif
+
+namespace bench {
+
+//! keeps value (and what it points to) alive, so the compiler can not remove the benchmarked work
+template <typename T>
+inline void do_not_optimize(T const & value)
+{
+	asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct result
+{
+	std::string name;
+	size_t ops;  //!< operations per repetition
+	unsigned reps;
+	double median_ns,  //!< per operation
+		mad_ns,
+		cycles;  //!< per operation, 0 without time stamp counter
+};
+
+class suite
+{
+public:
+	suite(int argc, char * argv[]);
+
+	/*! Runs f (doing ops operations) warmup times, then reps timed times.
+	\return median time per operation in ns */
+	template <typename F>
+	double run(std::string const & name, size_t ops, F && f);
+
+	std::vector<result> const & results() const {return _results;}
+	void report() const;  //!< table to stdout, JSON when asked for
+
+private:
+	static double median(std::vector<double> & values);
+	void write_json(FILE * out) const;
+
+	unsigned _reps = 21,
+		_warmup = 3;
+	std::string _filter,
+		_json;
+	std::vector<result> _results;
+};
+
+inline suite::suite(int argc, char * argv[])
+{
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		std::string const opt = argv[i];
+		if (opt == "--reps")
+			_reps = std::max(std::stoul(argv[++i]), 1ul);
+		else if (opt == "--warmup")
+			_warmup = std::stoul(argv[++i]);
+		else if (opt == "--filter")
+			_filter = argv[++i];
+		else if (opt == "--json")
+			_json = argv[++i];
+	}
+}
+
+template <typename F>
+double suite::run(std::string const & name, size_t ops, F && f)
+{
+	using std::chrono::steady_clock;
+
+	if (!_filter.empty() && name.find(_filter) == std::string::npos)
+		return 0;
+
+	for (unsigned i = 0; i < _warmup; ++i)
+		f();
+
+	std::vector<double> ns(_reps),
+		cycles(_reps, 0.0);
+
+	for (unsigned i = 0; i < _reps; ++i)
+	{
+#ifdef BENCH_HAS_TSC
+		uint64_t const c0 = __rdtsc();
+#endif
+		steady_clock::time_point const t0 = steady_clock::now();
+		f();
+		steady_clock::time_point const t1 = steady_clock::now();
+#ifdef BENCH_HAS_TSC
+		cycles[i] = double(__rdtsc() - c0) / ops;
+#endif
+		ns[i] = std::chrono::duration<double, std::nano>{t1 - t0}.count() / ops;
+	}
+
+	double const med = median(ns);
+	std::vector<double> deviations(_reps);
+	std::transform(begin(ns), end(ns), begin(deviations), [med](double t){return std::fabs(t - med);});
+
+	_results.push_back(result{name, ops, _reps, med, median(deviations), median(cycles)});
+	return med;
+}
+
+inline double suite::median(std::vector<double> & values)
+{
+	size_t const mid = values.size()/2;
+	std::nth_element(begin(values), begin(values) + mid, end(values));
+	return values[mid];
+}
+
+inline void suite::report() const
+{
+	printf("%-40s %12s %10s %10s %10s\n", "benchmark", "ops", "ns/op", "mad ns", "cycles/op");
+	for (result const & r : _results)
+		printf("%-40s %12zu %10.3f %10.3f %10.2f\n", r.name.c_str(), r.ops, r.median_ns, r.mad_ns, r.cycles);
+
+	if (_json.empty())
+		return;
+
+	if (_json == "-")
+		write_json(stdout);
+	else if (FILE * out = fopen(_json.c_str(), "w"))
+	{
+		write_json(out);
+		fclose(out);
+	}
+	else
+		fprintf(stderr, "unable to write '%s'\n", _json.c_str());
+}
+
+inline void suite::write_json(FILE * out) const
+{
+	fprintf(out, "{\"reps\": %u, \"warmup\": %u, \"benchmarks\": [", _reps, _warmup);
+	for (size_t i = 0; i < _results.size(); ++i)
+	{
+		result const & r = _results[i];
+		fprintf(out, "%s\n\t{\"name\": \"%s\", \"ops\": %zu, \"median_ns\": %.4f, \"mad_ns\": %.4f, \"cycles_per_op\": %.3f}",
+			(i > 0) ? "," : "", r.name.c_str(), r.ops, r.median_ns, r.mad_ns, r.cycles);
+	}
+	fprintf(out, "\n]}\n");
+}
+
+}  // bench
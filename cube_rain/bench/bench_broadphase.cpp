@@ -0,0 +1,75 @@
+/* Cube physics step with spatial hash versus sweep and prune broadphase,
+both run from the same raining and piling cubes state.
+usage: bench_broadphase [CUBES] [FRAMES] */
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include "job_system.hpp"
+#include "cube_physics.hpp"
+
+using std::vector,
+	std::generate,
+	std::stoul;
+using std::chrono::steady_clock,
+	std::chrono::duration;
+
+constexpr float dt = 1/60.f;
+
+float average_step_ms(job_system & jobs, vector<cube_object> cubes,
+	cube_physics::broadphase_method method, unsigned frames, cube_physics::counters & stats)
+{
+	cube_physics physics{jobs};
+	physics.broadphase(method);
+	vector<uint8_t> respawned;
+
+	for (unsigned i = 0; i < 60; ++i)  // warm up (buffers, sort order)
+		physics.step(cubes, dt, respawned);
+
+	steady_clock::time_point t0 = steady_clock::now();
+	for (unsigned i = 0; i < frames; ++i)
+		physics.step(cubes, dt, respawned);
+	float const ms = duration<float, std::milli>{steady_clock::now() - t0}.count() / frames;
+
+	stats = physics.stats();
+	return ms;
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned const cube_count = (argc > 1) ? stoul(argv[1]) : 10000,
+		frames = (argc > 2) ? stoul(argv[2]) : 600;
+
+	job_system jobs;
+
+	// piles first
+	vector<cube_object> cubes(cube_count);
+	generate(begin(cubes), end(cubes), new_cube);
+	{
+		cube_physics physics{jobs};
+		vector<uint8_t> respawned;
+		for (unsigned i = 0; i < 600; ++i)
+			physics.step(cubes, dt, respawned);
+	}
+
+	printf("%u cubes, %u frames, %u workers\n", cube_count, frames, jobs.worker_count());
+	printf("%16s %10s %8s %9s %9s\n", "broadphase", "step ms", "awake", "sleeping", "contacts");
+
+	struct {
+		char const * name;
+		cube_physics::broadphase_method method;
+	} const methods[] = {
+		{"spatial hash", cube_physics::broadphase_method::spatial_hash},
+		{"sweep and prune", cube_physics::broadphase_method::sweep_and_prune}
+	};
+
+	for (auto const & m : methods)
+	{
+		cube_physics::counters stats;
+		float const ms = average_step_ms(jobs, cubes, m.method, frames, stats);
+		printf("%16s %10.3f %8u %9u %9u\n", m.name, ms, stats.awake, stats.sleeping, stats.contacts);
+	}
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+/* Force fields pass cost for increasing number of fields compared to a plain
+pass touching the same memory (drift integration without fields), the pass
+stays memory bound while ms per step does not grow with field count.
+usage: bench_force_fields [CUBES] [FRAMES] */
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include "job_system.hpp"
+#include "force_fields.hpp"
+
+using std::vector,
+	std::generate,
+	std::stoul;
+using std::chrono::steady_clock,
+	std::chrono::duration;
+using phys::vec3;
+
+constexpr float dt = 1/60.f;
+
+float average_ms(job_system & jobs, force_fields & fields, vector<cube_object> & cubes, unsigned frames)
+{
+	fields.apply(jobs, cubes, dt, nullptr);  // warm up (buffers)
+
+	steady_clock::time_point t0 = steady_clock::now();
+	for (unsigned i = 0; i < frames; ++i)
+		fields.apply(jobs, cubes, dt, nullptr);
+	return duration<float, std::milli>{steady_clock::now() - t0}.count() / frames;
+}
+
+int main(int argc, char * argv[])
+{
+	size_t const cube_count = (argc > 1) ? stoul(argv[1]) : 100000;
+	unsigned const frames = (argc > 2) ? stoul(argv[2]) : 200;
+
+	job_system jobs;
+	vector<cube_object> cubes(cube_count);
+	generate(begin(cubes), end(cubes), new_cube);
+
+	// per cube position (16B) and drift velocity (12B) read and written
+	double const bytes = cube_count * 2.0 * (sizeof(cube_object) + 3*sizeof(float));
+
+	printf("%zu cubes, %u frames, %u workers\n", cube_count, frames, jobs.worker_count());
+	printf("%8s %12s %10s %10s\n", "fields", "kind", "ms", "GB/s");
+
+	// fields are cycled wind, attractor, turbulence (turbulence is the most expensive)
+	force_field const kinds[] = {
+		force_field{force_field::kind::wind, true, vec3{1, 0, 0.5f}, 2},
+		force_field{force_field::kind::attractor, true, vec3{0, 5, 0}, 4, 2},
+		force_field{force_field::kind::turbulence, true, vec3{}, 3, 2, 1}};
+	char const * names[] = {"mixed", "turbulence"};
+
+	for (int turbulence_only : {0, 1})
+	{
+		for (unsigned count = 0; count <= force_fields::max_fields; ++count)
+		{
+			force_fields fields;
+			for (unsigned i = 0; i < count; ++i)
+				fields.add(turbulence_only ? kinds[2] : kinds[i % 3]);
+
+			float const ms = average_ms(jobs, fields, cubes, frames);
+			printf("%8u %12s %10.3f %10.2f\n", count, names[turbulence_only], ms, bytes / (ms * 1e6));
+		}
+	}
+
+	return 0;
+}
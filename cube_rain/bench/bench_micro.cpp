@@ -0,0 +1,203 @@
+/* Hot function micro benchmarks: phys math, falling cubes simulation step,
+triangle normals and glt uniform setting (hidden window OpenGL ES 3.0 context,
+LIBGL_ALWAYS_SOFTWARE=1 runs it on llvmpipe, skipped without a context).
+usage: bench_micro [--reps N] [--warmup N] [--filter TEXT] [--json FILE] */
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "phys/matrices.h"
+#include "phys/simd.h"
+#include "glt/features.hpp"
+#include "instanced_shaded_shader.hpp"
+#include "cube_simulation.hpp"
+#include "triangle_normals.hpp"
+#include "bench/bench.hpp"
+
+using std::vector,
+	std::generate;
+using phys::vec3,
+	phys::mat4,
+	phys::simd_mat4,
+	phys::Inverse,
+	phys::FastInverse,
+	phys::RigidInverse,
+	phys::AffineInverse,
+	phys::Transpose,
+	phys::Normalized,
+	phys::NormalizeArray,
+	phys::LookAt,
+	phys::Projection,
+	phys::Transform;
+using bench::do_not_optimize;
+
+constexpr size_t batch = 1024;  //!< phys operations per repetition (fits L1)
+constexpr float dt = 1/60.f;
+
+void bench_phys(bench::suite & s)
+{
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> coord{-10, 10}, angle{0, 360};
+
+	vector<vec3> vs(batch), ns(batch);
+	vector<mat4> as(batch), bs(batch), out(batch);
+	for (size_t i = 0; i < batch; ++i)
+	{
+		vs[i] = vec3{coord(rand), coord(rand), coord(rand)};
+		as[i] = Transform(vec3{1, 1, 1}, vec3{angle(rand), angle(rand), angle(rand)}, vs[i]);
+		bs[i] = Projection(60, 4/3.f, 0.1f, 100) * as[i];
+	}
+
+	s.run("phys mat4 multiply", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = as[i] * bs[i];
+		do_not_optimize(out);
+	});
+
+	vector<simd_mat4> sas(begin(as), end(as)), sbs(begin(bs), end(bs)), souts(batch);
+	s.run("phys simd_mat4 multiply", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			souts[i] = sas[i] * sbs[i];
+		do_not_optimize(souts);
+	});
+
+	s.run("phys mat4 Inverse", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = Inverse(bs[i]);
+		do_not_optimize(out);
+	});
+
+	s.run("phys mat4 FastInverse", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = FastInverse(as[i]);
+		do_not_optimize(out);
+	});
+
+	s.run("phys mat4 RigidInverse", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = RigidInverse(as[i]);
+		do_not_optimize(out);
+	});
+
+	s.run("phys mat4 AffineInverse", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = AffineInverse(as[i]);
+		do_not_optimize(out);
+	});
+
+	s.run("phys mat4 Transpose", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = Transpose(as[i]);
+		do_not_optimize(out);
+	});
+
+	s.run("phys vec3 Normalized", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			ns[i] = Normalized(vs[i]);
+		do_not_optimize(ns);
+	});
+
+	s.run("phys vec3 NormalizeArray", batch, [&]{
+		copy(begin(vs), end(vs), begin(ns));
+		NormalizeArray(ns.data(), ns.size());
+		do_not_optimize(ns);
+	});
+
+	s.run("phys LookAt", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = LookAt(vs[i], vec3{0, 0, 0}, vec3{0, 1, 0});
+		do_not_optimize(out);
+	});
+
+	s.run("phys Projection", batch, [&]{
+		for (size_t i = 0; i < batch; ++i)
+			out[i] = Projection(30 + i % 60, 4/3.f, 0.1f, 100);
+		do_not_optimize(out);
+	});
+}
+
+void bench_simulation(bench::suite & s)
+{
+	constexpr size_t cube_count = 100000;
+	vector<cube_object> cubes(cube_count);
+	generate(begin(cubes), end(cubes), new_cube);
+	vector<uint8_t> respawned;
+
+	s.run("fall_cubes step (per cube)", cube_count, [&]{
+		fall_cubes(cubes, dt, respawned);
+		do_not_optimize(cubes);
+	});
+}
+
+void bench_normals(bench::suite & s)
+{
+	constexpr size_t triangle_count = 100000;
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> coord{-1, 1};
+
+	vector<float> positions(triangle_count*9), normals(triangle_count*9);
+	generate(begin(positions), end(positions), [&]{return coord(rand);});
+
+	s.run("calc_triangle_normals (per triangle)", triangle_count, [&]{
+		calc_triangle_normals(positions.data(), triangle_count, normals.data());
+		do_not_optimize(normals);
+	});
+}
+
+void bench_uniforms(bench::suite & s)
+{
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	GLFWwindow * window = glfwCreateWindow(64, 64, __FILE__, nullptr, nullptr);
+	if (!window)
+	{
+		fprintf(stderr, "unable to create OpenGL ES 3.0 context, glt benchmarks skipped\n");
+		glfwTerminate();
+		return;
+	}
+
+	glfwMakeContextCurrent(window);
+	glewInit();
+	glt::init_features();
+	printf("renderer: %s\n", glGetString(GL_RENDERER));
+
+	{
+		gles2::instanced_shaded_shader shader;
+		shader.use();
+
+		vector<mat4> VPs(batch);
+		for (size_t i = 0; i < batch; ++i)
+			VPs[i] = LookAt(vec3{float(i % 10), 5, -10}, vec3{0, 0, 0}, vec3{0, 1, 0}) * Projection(60, 4/3.f, 0.1f, 100);
+
+		s.run("glt uniform mat4 (world_to_screen)", batch, [&]{
+			for (mat4 const & VP : VPs)
+				shader.world_to_screen(VP);
+			glFinish();
+		});
+
+		s.run("glt uniform vec3 (light_direction)", batch, [&]{
+			for (size_t i = 0; i < batch; ++i)
+				shader.light_direction(vec3{0, float(i & 1), 1});
+			glFinish();
+		});
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+}
+
+int main(int argc, char * argv[])
+{
+	bench::suite s{argc, argv};
+	bench_phys(s);
+	bench_simulation(s);
+	bench_normals(s);
+	bench_uniforms(s);
+	s.report();
+	return 0;
+}
@@ -0,0 +1,130 @@
+/* Cube BVH build time for falling cubes (rebuilt each frame) and ray picking
+throughput, picks are checked against testing all cubes with phys::Raycast().
+usage: bench_picking [CUBES] [FRAMES] */
+#include <vector>
+#include <chrono>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cfloat>
+#include "phys/Camera.h"
+#include "job_system.hpp"
+#include "cube_simulation.hpp"
+#include "cube_tumbling.hpp"
+#include "cube_bvh.hpp"
+
+using std::vector,
+	std::generate,
+	std::stoul;
+using std::chrono::steady_clock,
+	std::chrono::duration;
+using phys::vec2,
+	phys::vec3,
+	phys::mat3,
+	phys::Ray,
+	phys::AABB,
+	phys::OBB,
+	phys::OrbitCamera;
+
+constexpr float dt = 1/60.f;
+constexpr unsigned ray_count = 10000;
+
+//! nearest cube by testing all of them
+int pick_brute_force(vector<cube_object> const & cubes, vector<cube_rotation> const & rotations,
+	Ray const & ray)
+{
+	int cube = -1;
+	float nearest = FLT_MAX;
+	for (size_t i = 0; i < cubes.size(); ++i)
+	{
+		float const half_size = cube_rules::half_size * cubes[i].scale;
+		vec3 const size{half_size, half_size, half_size};
+		float t;
+		if (rotations.empty())
+			t = Raycast(AABB{cubes[i].position, size}, ray);
+		else
+		{
+			cube_rotation const & r = rotations[i];
+			t = Raycast(OBB{cubes[i].position, size,
+				mat3{r.x.x, r.x.y, r.x.z, r.y.x, r.y.y, r.y.z, r.z.x, r.z.y, r.z.z}}, ray);
+		}
+
+		if (t >= 0 && t < nearest)
+		{
+			nearest = t;
+			cube = i;
+		}
+	}
+	return cube;
+}
+
+int main(int argc, char * argv[])
+{
+	size_t const cube_count = (argc > 1) ? stoul(argv[1]) : 100000;
+	unsigned const frames = (argc > 2) ? stoul(argv[2]) : 200;
+
+	job_system jobs;
+	vector<cube_object> cubes(cube_count);
+	generate(begin(cubes), end(cubes), new_cube);
+
+	// camera looking at the rain from aside, rays through random pixels
+	OrbitCamera cam;
+	cam.Perspective(60, 800/600.f, 0.01f, 100);
+	cam.SetTarget(vec3{0, 5, 0});
+	cam.SetZoom(25);
+	cam.Update(dt);
+
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> px{0, 800}, py{0, 600};
+	vector<Ray> rays(ray_count);
+	generate(begin(rays), end(rays), [&]{return cam.GetPickRay(vec2{px(rand), py(rand)}, vec2{800, 600});});
+
+	printf("%zu cubes, %u frames, %u workers\n", cube_count, frames, jobs.worker_count());
+	printf("%10s %10s %10s %12s %10s\n", "cubes", "nodes", "build ms", "picks/ms", "mismatch");
+
+	vector<uint8_t> respawned;
+	cube_tumbling tumbling;
+	vector<cube_rotation> rotations;
+
+	for (bool tumble : {false, true})
+	{
+		cube_bvh bvh;
+		float build_ms = 0;
+		for (unsigned i = 0; i < frames; ++i)
+		{
+			fall_cubes(cubes, dt, respawned);
+			if (tumble)
+			{
+				tumbling.resize(cubes.size());
+				tumbling.respawn(respawned);
+				tumbling.integrate(jobs, dt);
+				tumbling.rotations(jobs, rotations);
+			}
+			else
+				rotations.clear();
+
+			steady_clock::time_point t0 = steady_clock::now();
+			bvh.build(jobs, cubes, rotations);
+			if (i > 0)  // first build allocates
+				build_ms += duration<float, std::milli>{steady_clock::now() - t0}.count();
+		}
+		build_ms /= std::max(frames - 1, 1u);
+
+		vector<int> picked(ray_count);
+		steady_clock::time_point t0 = steady_clock::now();
+		for (unsigned i = 0; i < ray_count; ++i)
+			picked[i] = bvh.pick(rays[i], rotations);
+		float const pick_ms = duration<float, std::milli>{steady_clock::now() - t0}.count();
+
+		unsigned mismatch = 0;
+		for (unsigned i = 0; i < ray_count; i += 100)
+			if (picked[i] != pick_brute_force(cubes, rotations, rays[i]))
+				++mismatch;
+
+		printf("%10s %10zu %10.3f %12.1f %6u/%u\n", tumble ? "tumbling" : "aligned", bvh.node_count(), build_ms,
+			ray_count / pick_ms, mismatch, ray_count/100);
+	}
+
+	return 0;
+}
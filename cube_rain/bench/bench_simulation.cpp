@@ -0,0 +1,114 @@
+/* Falling cubes simulation benchmark, CPU (fall_cubes()) versus GPU transform
+feedback (gpu_cube_simulation) for increasing number of cubes.
+usage: bench_simulation [FRAMES] */
+#include <vector>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <exception>
+#include <cstdio>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "glt/features.hpp"
+#include "cube_simulation.hpp"
+#include "gpu_cube_simulation.hpp"
+
+using std::vector,
+	std::generate,
+	std::stoul;
+using std::chrono::steady_clock,
+	std::chrono::duration;
+using std::cerr, std::endl;
+
+constexpr float dt = 1/60.f;
+
+template <typename F>
+float average_ms(unsigned frames, F && step)
+{
+	steady_clock::time_point t0 = steady_clock::now();
+	for (unsigned i = 0; i < frames; ++i)
+		step();
+	return duration<float, std::milli>{steady_clock::now() - t0}.count() / frames;
+}
+
+//! one update() of a few cubes, it must not throw nor leave a GL error
+bool gpu_update_works(gpu_cube_simulation & gpu)
+{
+	try
+	{
+		gpu.resize(16);
+		gpu.update(dt);
+		glFinish();
+	}
+	catch (std::exception const & e)
+	{
+		cerr << "gpu_cube_simulation::update() failed: " << e.what() << endl;
+		return false;
+	}
+
+	if (GLenum const err = glGetError(); err != GL_NO_ERROR)
+	{
+		cerr << "gpu_cube_simulation::update() GL error 0x" << std::hex << err << endl;
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char * argv[])
+{
+	unsigned const frames = (argc > 1) ? stoul(argv[1]) : 100;
+
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	GLFWwindow * window = glfwCreateWindow(64, 64, __FILE__, nullptr, nullptr);
+	if (!window)
+	{
+		cerr << "unable to create OpenGL ES 3.0 context" << endl;
+		return 1;
+	}
+
+	glfwMakeContextCurrent(window);
+	glewInit();
+	glt::init_features();
+
+	if (!gpu_cube_simulation::available())
+	{
+		cerr << "transform feedback not available" << endl;
+		return 1;
+	}
+
+	printf("renderer: %s, %u frames\n", glGetString(GL_RENDERER), frames);
+	printf("%10s %12s %12s %8s\n", "cubes", "cpu ms", "gpu ms", "speedup");
+
+	gpu_cube_simulation gpu;
+	if (!gpu_update_works(gpu))
+		return 1;
+
+	for (unsigned count : {1000u, 10000u, 100000u, 1000000u, 4000000u})
+	{
+		vector<cube_object> cubes(count);
+		generate(begin(cubes), end(cubes), new_cube);
+		vector<uint8_t> respawned;
+		float const cpu_ms = average_ms(frames, [&]{fall_cubes(cubes, dt, respawned);});
+
+		gpu.resize(count);
+		gpu.update(dt);  // spawns cubes
+		glFinish();
+		float const gpu_ms = average_ms(frames, [&, frame = 0u]() mutable {
+			gpu.update(dt);
+			if (++frame == frames)
+				glFinish();  // wait for all submitted updates
+		});
+
+		printf("%10u %12.3f %12.3f %7.1fx\n", count, cpu_ms, gpu_ms, cpu_ms / gpu_ms);
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return 0;
+}
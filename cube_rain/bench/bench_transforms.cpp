@@ -0,0 +1,94 @@
+/* Transform build loop, mat4 chains of out of line calls (Scale() * Translation(),
+Scale() * rotation * Translation()) versus fused ScaleTranslate() and AffineMul(),
+and position integration with operators versus Madd().
+usage: bench_transforms [--reps N] [--warmup N] [--filter TEXT] [--json FILE] */
+#include <vector>
+#include <random>
+#include "phys/matrices.h"
+#include "bench/bench.hpp"
+
+using std::vector;
+using phys::vec3,
+	phys::mat3,
+	phys::mat4,
+	phys::affine,
+	phys::Scale,
+	phys::Translation,
+	phys::YRotation3x3,
+	phys::ScaleTranslate,
+	phys::AffineMul,
+	phys::Madd;
+using bench::do_not_optimize;
+
+constexpr float dt = 1/60.f;
+
+struct cube
+{
+	vec3 position;
+	vec3 velocity;
+	float scale;
+	mat3 rotation;
+};
+
+int main(int argc, char * argv[])
+{
+	constexpr size_t cube_count = 100000;
+
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> coord{-20, 20}, size{0.5f, 1.5f}, angle{0, 360};
+
+	vector<cube> cubes(cube_count);
+	for (cube & c : cubes)
+		c = cube{vec3{coord(rand), coord(rand), coord(rand)}, vec3{0, -size(rand), 0}, size(rand),
+			YRotation3x3(angle(rand))};
+
+	vector<mat4> Ms(cube_count);
+	bench::suite s{argc, argv};
+
+	s.run("Scale * Translation", cube_count, [&]{
+		for (size_t i = 0; i < cube_count; ++i)
+			Ms[i] = Scale(vec3{0.2f, 0.2f, 0.2f} * cubes[i].scale) * Translation(cubes[i].position);
+		do_not_optimize(Ms);
+	});
+
+	s.run("ScaleTranslate", cube_count, [&]{
+		for (size_t i = 0; i < cube_count; ++i)
+			Ms[i] = ScaleTranslate(0.2f * cubes[i].scale, cubes[i].position);
+		do_not_optimize(Ms);
+	});
+
+	s.run("Scale * rotation * Translation", cube_count, [&]{
+		for (size_t i = 0; i < cube_count; ++i)
+		{
+			mat3 const & R = cubes[i].rotation;
+			mat4 const rotation{R._11, R._12, R._13, 0, R._21, R._22, R._23, 0, R._31, R._32, R._33, 0, 0, 0, 0, 1};
+			Ms[i] = Scale(vec3{0.2f, 0.2f, 0.2f} * cubes[i].scale) * rotation * Translation(cubes[i].position);
+		}
+		do_not_optimize(Ms);
+	});
+
+	s.run("AffineMul(scale, rotation translation)", cube_count, [&]{
+		for (size_t i = 0; i < cube_count; ++i)
+		{
+			float const k = 0.2f * cubes[i].scale;
+			affine const scale{mat3{k, 0, 0, 0, k, 0, 0, 0, k}, vec3{}};
+			Ms[i] = mat4(AffineMul(scale, affine{cubes[i].rotation, cubes[i].position}));
+		}
+		do_not_optimize(Ms);
+	});
+
+	s.run("position + velocity * dt", cube_count, [&]{
+		for (cube & c : cubes)
+			c.position = c.position + c.velocity * dt;
+		do_not_optimize(cubes);
+	});
+
+	s.run("Madd(velocity, dt, position)", cube_count, [&]{
+		for (cube & c : cubes)
+			c.position = Madd(c.velocity, dt, c.position);
+		do_not_optimize(cubes);
+	});
+
+	s.report();
+	return 0;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#include "glt/cpu_profiler.hpp"
+#include "cube_batch.hpp"
+
+using std::vector,
+	std::upper_bound;
+using phys::Madd;
+
+static_assert(sizeof(cube_batcher::vertex) == 6*sizeof(float), "tightly packed vertex expected");
+
+cube_batcher::cube_batcher(float const * positions, float const * normals, size_t vertex_count)
+	: _mesh(vertex_count)
+{
+	for (size_t i = 0; i < vertex_count; ++i)
+	{
+		_mesh[i].position = phys::vec3{positions[3*i], positions[3*i+1], positions[3*i+2]};
+		_mesh[i].normal = phys::vec3{normals[3*i], normals[3*i+1], normals[3*i+2]};
+	}
+}
+
+size_t cube_batcher::vertex_count(vector<group> const & groups) const
+{
+	size_t count = 0;
+	for (group const & g : groups)
+		count += g.cube_count * g.vertex_count;
+	return count;
+}
+
+void cube_batcher::transform(job_system & jobs, cube_instance const * cubes,
+	cube_rotation const * rotations, vector<group> const & groups, vertex * out)
+{
+	GLT_PROFILE_ZONE("cube batching");
+
+	if (groups.empty())
+		return;
+
+	// output offset of each group
+	_offsets.resize(groups.size());
+	size_t offset = 0;
+	for (size_t i = 0; i < groups.size(); ++i)
+	{
+		_offsets[i] = offset;
+		offset += groups[i].cube_count * groups[i].vertex_count;
+	}
+
+	group const & last = groups.back();
+	size_t const first_cube = groups.front().first_cube,
+		cube_count = last.first_cube + last.cube_count - first_cube;
+
+	jobs.parallel_for(cube_count, 64, [&](size_t first, size_t last){
+		// group of the first cube in chunk
+		size_t gi = upper_bound(begin(groups), end(groups), first + first_cube,
+			[](size_t cube, group const & g){return cube < g.first_cube;}) - begin(groups) - 1;
+
+		for (size_t i = first + first_cube; i < last + first_cube; ++i)
+		{
+			while (i >= groups[gi].first_cube + groups[gi].cube_count)
+				++gi;
+
+			group const & g = groups[gi];
+			vertex * dst = out + _offsets[gi] + (i - g.first_cube)*g.vertex_count;
+			if (rotations)
+				transform(cubes[i], rotations[i], g, dst);
+			else
+				transform(cubes[i], g, dst);
+		}
+	});
+}
+
+void cube_batcher::transform(cube_instance const & cube, group const & g, vertex * out) const
+{
+	vertex const * src = _mesh.data() + g.first_vertex;
+
+#ifdef __SSE2__
+	// position and normal.x in one register, normal.x is kept (scale 1, offset 0)
+	__m128 const scale = _mm_setr_ps(cube.scale, cube.scale, cube.scale, 1.0f),
+		offset = _mm_setr_ps(cube.position.x, cube.position.y, cube.position.z, 0.0f);
+
+	for (unsigned i = 0; i < g.vertex_count; ++i)
+	{
+		float const * s = reinterpret_cast<float const *>(&src[i]);
+		float * d = reinterpret_cast<float *>(&out[i]);
+		_mm_storeu_ps(d, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(s), scale), offset));
+		d[4] = s[4];
+		d[5] = s[5];
+	}
+#else
+	for (unsigned i = 0; i < g.vertex_count; ++i)
+	{
+		out[i].position = Madd(src[i].position, cube.scale, cube.position);
+		out[i].normal = src[i].normal;
+	}
+#endif
+}
+
+void cube_batcher::transform(cube_instance const & cube, cube_rotation const & r, group const & g,
+	vertex * out) const
+{
+	vertex const * src = _mesh.data() + g.first_vertex;
+
+#ifdef __SSE2__
+	// row vector times rotation rows, position rows are scaled
+	__m128 const rx = _mm_setr_ps(r.x.x, r.x.y, r.x.z, 0.0f),
+		ry = _mm_setr_ps(r.y.x, r.y.y, r.y.z, 0.0f),
+		rz = _mm_setr_ps(r.z.x, r.z.y, r.z.z, 0.0f),
+		scale = _mm_set1_ps(cube.scale),
+		sx = _mm_mul_ps(rx, scale),
+		sy = _mm_mul_ps(ry, scale),
+		sz = _mm_mul_ps(rz, scale),
+		offset = _mm_setr_ps(cube.position.x, cube.position.y, cube.position.z, 0.0f);
+
+	for (unsigned i = 0; i < g.vertex_count; ++i)
+	{
+		float const * s = reinterpret_cast<float const *>(&src[i]);
+		float * d = reinterpret_cast<float *>(&out[i]);
+
+		__m128 const p = _mm_add_ps(offset, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[0]), sx),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[1]), sy), _mm_mul_ps(_mm_set1_ps(s[2]), sz))));
+		__m128 const n = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[3]), rx),
+			_mm_add_ps(_mm_mul_ps(_mm_set1_ps(s[4]), ry), _mm_mul_ps(_mm_set1_ps(s[5]), rz)));
+
+		_mm_storeu_ps(d, p);  // d[3] is overwritten by normal
+		_mm_storel_pi(reinterpret_cast<__m64 *>(d + 3), n);
+		_mm_store_ss(d + 5, _mm_movehl_ps(n, n));
+	}
+#else
+	for (unsigned i = 0; i < g.vertex_count; ++i)
+	{
+		phys::vec3 const & p = src[i].position,
+			& n = src[i].normal;
+		out[i].position = Madd(Madd(r.x, p.x, Madd(r.y, p.y, r.z*p.z)), cube.scale, cube.position);
+		out[i].normal = Madd(r.x, n.x, Madd(r.y, n.y, r.z*n.z));
+	}
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "phys/vectors.h"
+#include "render_thread.hpp"
+#include "job_system.hpp"
+
+/*! Pre-transforms cube meshes into one vertex stream on CPU, so contexts
+without instanced arrays (plain GLES2) draw all cubes with a single draw call
+instead of one draw call per cube. Cubes are scaled, rotated (optional) and
+translated, without rotation normals are copied as they are.
+
+\code
+cube_batcher b{positions, normals, vertex_count};
+vector<cube_batcher::group> groups = ...;  // mesh vertex range for consecutive cubes
+span<cube_batcher::vertex> out = stream.map<cube_batcher::vertex>(b.vertex_count(groups));
+b.transform(jobs, cubes, rotations, groups, out.begin());  // rotations can be nullptr
+\endcode */
+class cube_batcher
+{
+public:
+	struct vertex  //!< interleaved position and normal
+	{
+		phys::vec3 position,
+			normal;
+	};
+
+	struct group  //!< consecutive cubes drawn with the same mesh vertices
+	{
+		unsigned first_cube,
+			cube_count,
+			first_vertex,  //!< in mesh
+			vertex_count;
+	};
+
+	cube_batcher(float const * positions, float const * normals, size_t vertex_count);
+
+	size_t vertex_count(std::vector<group> const & groups) const;  //!< \return number of vertices written by transform()
+
+	/*! Writes vertices of all cubes in groups (in groups order) to out, cubes are
+	transformed in parallel (SSE2 when available).
+	\param rotations rotation for each cube or nullptr for axis aligned cubes */
+	void transform(job_system & jobs, cube_instance const * cubes, cube_rotation const * rotations,
+		std::vector<group> const & groups, vertex * out);
+
+private:
+	void transform(cube_instance const & cube, group const & g, vertex * out) const;
+	void transform(cube_instance const & cube, cube_rotation const & r, group const & g,
+		vertex * out) const;
+
+	std::vector<vertex> _mesh;
+	std::vector<size_t> _offsets;  //!< first output vertex for each group (transform() scratch)
+};
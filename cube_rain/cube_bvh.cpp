@@ -0,0 +1,410 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#include "glt/cpu_profiler.hpp"
+#include "cube_bvh.hpp"
+
+using std::vector,
+	std::min,
+	std::max;
+using phys::vec3,
+	phys::mat3,
+	phys::OBB,
+	phys::Ray;
+
+constexpr size_t reduce_chunk = 4096;  // cubes per centroid bounds chunk
+constexpr uint32_t subtree_leaves = 256;  // leaves per parallel build job
+constexpr unsigned morton_bits = 5;  // per axis, 15 bit codes sorted in 2 radix passes (cells about cube size)
+constexpr float sqrt3 = 1.7320508f;
+
+static_assert(sizeof(cube_rotation) == 9*sizeof(float), "unexpected cube_rotation layout");
+
+//! spreads 8 bits so there are two zero bits between them
+constexpr uint32_t expand_bits(uint32_t v)
+{
+	v = (v * 0x00000101u) & 0x0F00F00Fu;
+	v = (v * 0x00000011u) & 0xC30C30C3u;
+	v = (v * 0x00000005u) & 0x49249249u;
+	return v;
+}
+
+struct expanded_bits_table
+{
+	uint32_t bits[1u << morton_bits];
+
+	constexpr expanded_bits_table() : bits{}
+	{
+		for (uint32_t i = 0; i < (1u << morton_bits); ++i)
+			bits[i] = expand_bits(i);
+	}
+};
+
+constexpr expanded_bits_table expanded;
+
+//! \param q position quantized to [0, 2^morton_bits) per axis
+uint32_t morton_code(vec3 const & q)
+{
+	return (expanded.bits[uint32_t(q.x)] << 2) | (expanded.bits[uint32_t(q.y)] << 1)
+		| expanded.bits[uint32_t(q.z)];
+}
+
+cube_bvh::cube_bvh()
+	: _rotated{false}
+{}
+
+void cube_bvh::build(job_system & jobs, vector<cube_object> const & cubes,
+	vector<cube_rotation> const & rotations)
+{
+	GLT_PROFILE_ZONE("cube bvh");
+
+	size_t const n = cubes.size();
+	_rotated = !rotations.empty();
+	_nodes.clear();
+	if (n == 0)
+		return;
+
+	// centroid bounds
+	size_t const chunk_count = (n + reduce_chunk - 1) / reduce_chunk;
+	_chunk_min.resize(chunk_count);
+	_chunk_max.resize(chunk_count);
+	jobs.parallel_for(chunk_count, 1, [&](size_t first, size_t last){
+		for (size_t c = first; c < last; ++c)
+		{
+			size_t const begin = c*reduce_chunk,
+				end = min(begin + reduce_chunk, n);
+#ifdef __SSE2__
+			// cube_object is position followed by scale, so it loads as a vector
+			static_assert(sizeof(cube_object) == 4*sizeof(float), "unexpected cube_object layout");
+			__m128 lo = _mm_loadu_ps(&cubes[begin].position.x),
+				hi = lo;
+			for (size_t i = begin + 1; i < end; ++i)
+			{
+				__m128 const p = _mm_loadu_ps(&cubes[i].position.x);
+				lo = _mm_min_ps(lo, p);
+				hi = _mm_max_ps(hi, p);
+			}
+			float lo_xyzs[4], hi_xyzs[4];
+			_mm_storeu_ps(lo_xyzs, lo);
+			_mm_storeu_ps(hi_xyzs, hi);
+			_chunk_min[c] = vec3{lo_xyzs[0], lo_xyzs[1], lo_xyzs[2]};
+			_chunk_max[c] = vec3{hi_xyzs[0], hi_xyzs[1], hi_xyzs[2]};
+#else
+			vec3 lo = cubes[begin].position,
+				hi = lo;
+			for (size_t i = begin + 1; i < end; ++i)
+			{
+				vec3 const & p = cubes[i].position;
+				lo = vec3{min(lo.x, p.x), min(lo.y, p.y), min(lo.z, p.z)};
+				hi = vec3{max(hi.x, p.x), max(hi.y, p.y), max(hi.z, p.z)};
+			}
+			_chunk_min[c] = lo;
+			_chunk_max[c] = hi;
+#endif
+		}
+	});
+
+	vec3 lo = _chunk_min[0],
+		hi = _chunk_max[0];
+	for (size_t c = 1; c < chunk_count; ++c)
+	{
+		lo = vec3{min(lo.x, _chunk_min[c].x), min(lo.y, _chunk_min[c].y), min(lo.z, _chunk_min[c].z)};
+		hi = vec3{max(hi.x, _chunk_max[c].x), max(hi.y, _chunk_max[c].y), max(hi.z, _chunk_max[c].z)};
+	}
+
+	// Morton order
+	float const cells = float(1u << morton_bits) - 0.01f;
+	vec3 const extent = hi - lo,
+		scale{extent.x > 0 ? cells/extent.x : 0, extent.y > 0 ? cells/extent.y : 0,
+			extent.z > 0 ? cells/extent.z : 0};
+
+	_order.resize(n);
+	jobs.parallel_for(n, 2048, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+		{
+			vec3 const & p = cubes[i].position;
+			vec3 const q{(p.x - lo.x) * scale.x, (p.y - lo.y) * scale.y, (p.z - lo.z) * scale.z};
+			_order[i] = sort_item{morton_code(q), uint32_t(i)};
+		}
+	});
+
+	parallel_radix_sort(jobs, _order, _sort_temp, 3*morton_bits);
+
+	/* cube boxes in Morton order, the last leaf is padded with copies of the
+	last cube (so leaf bounds and hits are not affected) */
+	size_t const padded = (n + leaf_size - 1) / leaf_size * leaf_size;
+	_boxes.resize(padded);
+	_cubes.resize(padded);
+	_leaf_keys.resize(padded / leaf_size);
+
+	float const extent_scale = _rotated ? sqrt3 : 1;
+	jobs.parallel_for(padded, 2048, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+		{
+			uint32_t const cube = _order[min(i, n-1)].index;
+			cube_object const & c = cubes[cube];
+			_boxes[i] = box{c.position, cube_rules::half_size * c.scale * extent_scale};
+			_cubes[i] = cube;
+			if (i % leaf_size == 0)  // leaf code is code of its first cube
+				_leaf_keys[i / leaf_size] = _order[i].key;
+		}
+	});
+
+	build_tree(jobs);
+}
+
+int cube_bvh::pick(Ray const & ray, vector<cube_rotation> const & rotations, float * distance) const
+{
+	float const * d = ray.direction.asArray;
+	vec3 const inv_dir{1.0f / (d[0] == 0 ? 0.00001f : d[0]), 1.0f / (d[1] == 0 ? 0.00001f : d[1]),
+		1.0f / (d[2] == 0 ? 0.00001f : d[2])};
+
+	float nearest = FLT_MAX;
+	int cube = -1;
+
+#ifdef __SSE2__
+	__m128 const origin = _mm_setr_ps(ray.origin.x, ray.origin.y, ray.origin.z, 0),
+		inv = _mm_setr_ps(inv_dir.x, inv_dir.y, inv_dir.z, 0),
+		zero = _mm_setzero_ps();
+#endif
+
+	for (uint32_t i = 0; i < _nodes.size();)
+	{
+		node const & n = _nodes[i];
+
+		// slab test (x, y and z at once), only hits nearer than the nearest cube so far count
+#ifdef __SSE2__
+		__m128 const t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&n.min.x), origin), inv),
+			t2 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&n.max.x), origin), inv),
+			tmin = _mm_min_ps(t1, t2),
+			tmax = _mm_max_ps(t1, t2);
+
+		__m128 const t_near = _mm_max_ss(_mm_max_ss(tmin, _mm_shuffle_ps(tmin, tmin, _MM_SHUFFLE(1,1,1,1))),
+				_mm_max_ss(_mm_shuffle_ps(tmin, tmin, _MM_SHUFFLE(2,2,2,2)), zero)),
+			t_far = _mm_min_ss(_mm_min_ss(tmax, _mm_shuffle_ps(tmax, tmax, _MM_SHUFFLE(1,1,1,1))),
+				_mm_min_ss(_mm_shuffle_ps(tmax, tmax, _MM_SHUFFLE(2,2,2,2)), _mm_set_ss(nearest)));
+
+		bool const hit = _mm_comile_ss(t_near, t_far);
+#else
+		float t_near = 0,
+			t_far = nearest;
+		for (int k = 0; k < 3; ++k)
+		{
+			float const t1 = (n.min.asArray[k] - ray.origin.asArray[k]) * inv_dir.asArray[k],
+				t2 = (n.max.asArray[k] - ray.origin.asArray[k]) * inv_dir.asArray[k];
+			t_near = max(t_near, min(t1, t2));
+			t_far = min(t_far, max(t1, t2));
+		}
+
+		bool const hit = t_near <= t_far;
+#endif
+
+		if (!hit)
+		{
+			i = n.skip;
+			continue;
+		}
+
+		if (n.leaf != internal_node)
+			test_leaf(n.leaf, ray, inv_dir, rotations, nearest, cube);
+
+		++i;  // leaf skip is the next node, internal node continues with left child
+	}
+
+	if (distance)
+		*distance = nearest;
+
+	return cube;
+}
+
+size_t cube_bvh::node_count() const
+{
+	return _nodes.size();
+}
+
+void cube_bvh::build_tree(job_system & jobs)
+{
+	uint32_t const leaf_count = _cubes.size() / leaf_size;
+	_nodes.resize(2*leaf_count - 1);
+
+	// top of the tree is split serially into subtrees built in parallel
+	_subtrees.clear();
+	_top.clear();
+	split_top(0, 0, leaf_count);
+
+	jobs.parallel_for(_subtrees.size(), 1, [this](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+			build_node(_subtrees[i].node, _subtrees[i].first_leaf, _subtrees[i].last_leaf);
+	});
+
+	// parents are before children
+	for (auto it = _top.rbegin(); it != _top.rend(); ++it)
+		merge_children(*it);
+}
+
+void cube_bvh::split_top(uint32_t idx, uint32_t first_leaf, uint32_t last_leaf)
+{
+	if (last_leaf - first_leaf <= subtree_leaves)
+	{
+		_subtrees.push_back(subtree{idx, first_leaf, last_leaf});
+		return;
+	}
+
+	node & n = _nodes[idx];
+	n.skip = idx + 2*(last_leaf - first_leaf) - 1;
+	n.leaf = internal_node;
+	_top.push_back(idx);
+
+	uint32_t const split = find_split(first_leaf, last_leaf);
+	split_top(idx + 1, first_leaf, split);
+	split_top(idx + 2*(split - first_leaf), split, last_leaf);
+}
+
+void cube_bvh::build_node(uint32_t idx, uint32_t first_leaf, uint32_t last_leaf)
+{
+	node & n = _nodes[idx];
+	n.skip = idx + 2*(last_leaf - first_leaf) - 1;  // subtree over L leaves has 2L-1 nodes
+
+	if (last_leaf - first_leaf == 1)
+	{
+		n.leaf = first_leaf;
+		n.min = vec3{FLT_MAX, FLT_MAX, FLT_MAX};
+		n.max = vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+		for (size_t i = first_leaf * leaf_size; i < (first_leaf + 1) * leaf_size; ++i)
+		{
+			box const & b = _boxes[i];
+			n.min = vec3{min(n.min.x, b.center.x - b.half_size), min(n.min.y, b.center.y - b.half_size),
+				min(n.min.z, b.center.z - b.half_size)};
+			n.max = vec3{max(n.max.x, b.center.x + b.half_size), max(n.max.y, b.center.y + b.half_size),
+				max(n.max.z, b.center.z + b.half_size)};
+		}
+		return;
+	}
+
+	n.leaf = internal_node;
+	uint32_t const split = find_split(first_leaf, last_leaf);
+	build_node(idx + 1, first_leaf, split);
+	build_node(idx + 2*(split - first_leaf), split, last_leaf);
+	merge_children(idx);
+}
+
+uint32_t cube_bvh::find_split(uint32_t first_leaf, uint32_t last_leaf) const
+{
+	uint32_t const diff = leaf_key(first_leaf) ^ leaf_key(last_leaf - 1);
+	if (diff == 0)  // same codes, split in the middle
+		return (first_leaf + last_leaf) / 2;
+
+	// highest differing bit (bits bellow the highest one set, then cleared)
+	uint32_t bit = diff;
+	bit |= bit >> 1;
+	bit |= bit >> 2;
+	bit |= bit >> 4;
+	bit |= bit >> 8;
+	bit |= bit >> 16;
+	bit ^= bit >> 1;
+
+	// leaves share code bits above the highest differing one, so it is 0 up to the split and 1 after
+	uint32_t lo = first_leaf,  // bit is 0
+		hi = last_leaf - 1;  // bit is 1
+	while (hi - lo > 1)
+	{
+		uint32_t const mid = (lo + hi) / 2;
+		if (leaf_key(mid) & bit)
+			hi = mid;
+		else
+			lo = mid;
+	}
+
+	return hi;
+}
+
+uint32_t cube_bvh::leaf_key(uint32_t leaf) const
+{
+	return _leaf_keys[leaf];
+}
+
+void cube_bvh::merge_children(uint32_t idx)
+{
+	node & n = _nodes[idx];
+	node const & left = _nodes[idx + 1],
+		& right = _nodes[left.skip];  // right child follows left subtree
+	n.min = vec3{min(left.min.x, right.min.x), min(left.min.y, right.min.y), min(left.min.z, right.min.z)};
+	n.max = vec3{max(left.max.x, right.max.x), max(left.max.y, right.max.y), max(left.max.z, right.max.z)};
+}
+
+void cube_bvh::test_leaf(uint32_t leaf, Ray const & ray, vec3 const & inv_dir,
+	vector<cube_rotation> const & rotations, float & nearest, int & cube) const
+{
+	size_t const k = leaf * leaf_size;
+	float t_near[leaf_size];
+	unsigned hits = 0;  // bit per leaf cube
+
+#ifdef __SSE2__
+	static_assert(leaf_size == 4, "SSE leaf test expects 4 cubes per leaf");
+
+	// slab test of 4 boxes at once, boxes transposed to center x, y, z and half size vectors
+	__m128 cx = _mm_loadu_ps(&_boxes[k].center.x), cy = _mm_loadu_ps(&_boxes[k+1].center.x),
+		cz = _mm_loadu_ps(&_boxes[k+2].center.x), h = _mm_loadu_ps(&_boxes[k+3].center.x);
+	_MM_TRANSPOSE4_PS(cx, cy, cz, h);
+
+	__m128 const ox = _mm_set1_ps(ray.origin.x), oy = _mm_set1_ps(ray.origin.y), oz = _mm_set1_ps(ray.origin.z),
+		ix = _mm_set1_ps(inv_dir.x), iy = _mm_set1_ps(inv_dir.y), iz = _mm_set1_ps(inv_dir.z);
+
+	__m128 const tx1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cx, h), ox), ix),
+		tx2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cx, h), ox), ix),
+		ty1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cy, h), oy), iy),
+		ty2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cy, h), oy), iy),
+		tz1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(cz, h), oz), iz),
+		tz2 = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(cz, h), oz), iz);
+
+	__m128 const t_min = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx1, tx2), _mm_min_ps(ty1, ty2)),
+			_mm_max_ps(_mm_min_ps(tz1, tz2), _mm_setzero_ps())),
+		t_max = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx1, tx2), _mm_max_ps(ty1, ty2)),
+			_mm_min_ps(_mm_max_ps(tz1, tz2), _mm_set1_ps(nearest)));
+
+	hits = _mm_movemask_ps(_mm_cmple_ps(t_min, t_max));
+	_mm_storeu_ps(t_near, t_min);
+#else
+	vec3 const & o = ray.origin;
+	for (size_t i = 0; i < leaf_size; ++i)
+	{
+		vec3 const & c = _boxes[k+i].center;
+		float const h = _boxes[k+i].half_size;
+		float const tx1 = (c.x - h - o.x) * inv_dir.x, tx2 = (c.x + h - o.x) * inv_dir.x,
+			ty1 = (c.y - h - o.y) * inv_dir.y, ty2 = (c.y + h - o.y) * inv_dir.y,
+			tz1 = (c.z - h - o.z) * inv_dir.z, tz2 = (c.z + h - o.z) * inv_dir.z;
+
+		t_near[i] = max(max(min(tx1, tx2), min(ty1, ty2)), max(min(tz1, tz2), 0.0f));
+		float const t_far = min(min(max(tx1, tx2), max(ty1, ty2)), min(max(tz1, tz2), nearest));
+		if (t_near[i] <= t_far)
+			hits |= 1u << i;
+	}
+#endif
+
+	for (size_t i = 0; hits; ++i, hits >>= 1)
+	{
+		if (!(hits & 1))
+			continue;
+
+		float t = t_near[i];
+		if (_rotated)  // box bounds rotated cube, test the cube itself
+		{
+			float const half_size = _boxes[k+i].half_size / sqrt3;
+			cube_rotation const & r = rotations[_cubes[k+i]];
+			OBB const cube_box{_boxes[k+i].center, vec3{half_size, half_size, half_size},
+				mat3{r.x.x, r.x.y, r.x.z, r.y.x, r.y.y, r.y.z, r.z.x, r.z.y, r.z.z}};
+
+			t = Raycast(cube_box, ray);
+			if (t < 0)
+				continue;
+		}
+
+		if (t < nearest)
+		{
+			nearest = t;
+			cube = _cubes[k+i];
+		}
+	}
+}
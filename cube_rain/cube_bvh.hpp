@@ -0,0 +1,95 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "phys/collision.h"
+#include "job_system.hpp"
+#include "parallel_sort.hpp"
+#include "cube_simulation.hpp"
+#include "render_thread.hpp"
+
+/*! Linear bounding volume hierarchy of cubes for ray picking.
+
+Rebuilt from scratch every frame (cubes move). Cubes are sorted by Morton
+code of their positions (parallel_radix_sort()), grouped by leaf_size into
+leaves and the hierarchy is made by splitting leaf ranges at the highest
+differing Morton code bit. A binary tree over L leaves has 2L-1 nodes, so
+each subtree knows where its nodes go (nodes are stored in depth first
+order) and subtrees are built in parallel.
+
+Traversal is stackless, each node stores index of the node after its subtree
+(skip) where to continue on miss. Ray is tested against node box axes at once
+and against all leaf_size cube boxes of a leaf at once (SSE2 when available).
+
+\code
+cube_bvh bvh;
+bvh.build(jobs, cubes, rotations);  // each frame after simulation
+int cube = bvh.pick(cam.GetPickRay(cursor, viewport), rotations);
+\endcode */
+class cube_bvh
+{
+public:
+	static constexpr unsigned leaf_size = 4;  //!< cubes per leaf
+
+	cube_bvh();
+
+	/*! \param rotations cube rotations (same order as cubes) or empty for axis
+	aligned cubes, rotated cubes are bounded by their circumscribed boxes */
+	void build(job_system & jobs, std::vector<cube_object> const & cubes,
+		std::vector<cube_rotation> const & rotations);
+
+	/*! \return index of the nearest cube hit by the ray or -1 (cubes from
+	the last build())
+	\param rotations the same rotations as passed to the last build()
+	\param distance distance of the hit along the ray, can be nullptr */
+	int pick(phys::Ray const & ray, std::vector<cube_rotation> const & rotations,
+		float * distance = nullptr) const;
+
+	size_t node_count() const;
+
+private:
+	struct node
+	{
+		phys::vec3 min;
+		uint32_t skip;  //!< next node index after subtree
+		phys::vec3 max;
+		uint32_t leaf;  //!< leaf index or internal_node
+	};
+
+	static constexpr uint32_t internal_node = ~0u;
+
+	struct box  //!< cube bounding box
+	{
+		phys::vec3 center;
+		float half_size;
+	};
+
+	struct subtree  //!< parallel build job
+	{
+		uint32_t node,
+			first_leaf,
+			last_leaf;
+	};
+
+	void build_tree(job_system & jobs);
+	void split_top(uint32_t idx, uint32_t first_leaf, uint32_t last_leaf);  //!< collects subtrees for parallel build
+	void build_node(uint32_t idx, uint32_t first_leaf, uint32_t last_leaf);
+	uint32_t find_split(uint32_t first_leaf, uint32_t last_leaf) const;  //!< \return first leaf of the right child
+	uint32_t leaf_key(uint32_t leaf) const;
+	void merge_children(uint32_t idx);  //!< node bounds from its children bounds
+	void test_leaf(uint32_t leaf, phys::Ray const & ray, phys::vec3 const & inv_dir,
+		std::vector<cube_rotation> const & rotations, float & nearest, int & cube) const;
+
+	bool _rotated;
+	std::vector<sort_item> _order,  //!< Morton code and cube index
+		_sort_temp;
+	std::vector<node> _nodes;
+	std::vector<phys::vec3> _chunk_min, _chunk_max;  //!< centroid bounds reduction
+
+	// cubes in Morton order padded to multiple of leaf_size
+	std::vector<box> _boxes;
+	std::vector<uint32_t> _cubes,  //!< cube index
+		_leaf_keys;  //!< Morton code of the first leaf cube
+
+	std::vector<subtree> _subtrees;
+	std::vector<uint32_t> _top;  //!< nodes above subtrees in depth first order
+};
@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include "phys/collision.h"
+#include "glt/cpu_profiler.hpp"
+#include "cube_physics.hpp"
+
+using std::vector,
+	std::min,
+	std::max,
+	std::find,
+	std::fill,
+	std::clamp;
+using phys::vec3,
+	phys::AABB,
+	phys::CollisionManifold,
+	phys::FindCollisionFeatures;
+
+constexpr float rest_distance = 0.002f,  // moving less during step means cube is at rest
+	broadphase_margin = 0.05f,  // cubes closer are neighbours
+	support_distance = 0.01f;  // cube closer to the cube bellow lies on it
+
+cube_physics::cube_physics(job_system & jobs)
+	: _jobs{jobs}
+	, _broadphase{broadphase_method::spatial_hash}
+	, _awake_grid{cell_size}
+	, _sleeping_grid{cell_size}
+	, _sleeping_dirty{true}
+	, _next_island{0}
+{}
+
+void cube_physics::step(vector<cube_object> & cubes, float dt, vector<uint8_t> & respawned)
+{
+	GLT_PROFILE_ZONE("cube physics");
+
+	resize(cubes.size());
+	respawned.assign(cubes.size(), 0);
+	respawn_sleeping(cubes, dt, respawned);
+
+	_awake.clear();
+	_sleeping.clear();
+	for (uint32_t i = 0; i < cubes.size(); ++i)
+		(_asleep[i] ? _sleeping : _awake).push_back(i);
+
+	// fall
+	_jobs.parallel_for(cubes.size(), 1024, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+		{
+			cube_object const & cube = cubes[i];
+			_start[i] = cube.position;
+			_positions[i] = cube.position;
+			_half_sizes[i] = cube_rules::half_size * cube.scale;
+			if (!_asleep[i] && !_supported[i])
+				_positions[i].y -= cube_fall(cube, dt);
+			_fallen[i] = _positions[i];
+		}
+	});
+
+	if (_broadphase == broadphase_method::spatial_hash)
+	{
+		if (_sleeping_dirty)
+		{
+			_sleeping_grid.build(_jobs, _positions, _sleeping);
+			_sleeping_dirty = false;
+		}
+
+		_awake_grid.build(_jobs, _positions, _awake);
+		find_neighbours();
+	}
+	else
+		find_neighbours_sap();
+
+	solve(max_correction(dt));
+
+	for (uint32_t i : _awake)
+		cubes[i].position = _positions[i];
+
+	update_islands(dt);
+
+	for (size_t i = 0; i < cubes.size(); ++i)
+		_pinned[i] = _asleep[i] | _supported[i];
+
+	_stats.awake = _awake.size();
+	_stats.sleeping = _sleeping.size();
+}
+
+float cube_physics::max_correction(float dt)
+{
+	return max_correction_speed * dt;
+}
+
+void cube_physics::broadphase(broadphase_method m)
+{
+	_broadphase = m;
+	_sleeping_dirty = true;  // not maintained by sweep and prune
+}
+
+cube_physics::broadphase_method cube_physics::broadphase() const
+{
+	return _broadphase;
+}
+
+void cube_physics::wake()
+{
+	fill(begin(_asleep), end(_asleep), 0);
+	fill(begin(_supported), end(_supported), 0);
+	fill(begin(_pinned), end(_pinned), 0);
+	fill(begin(_rest_time), end(_rest_time), 0.0f);
+	_sleeping_dirty = true;
+}
+
+cube_physics::counters const & cube_physics::stats() const
+{
+	return _stats;
+}
+
+vector<uint8_t> const & cube_physics::supported() const
+{
+	return _supported;
+}
+
+vector<uint8_t> const & cube_physics::pinned() const
+{
+	return _pinned;
+}
+
+void cube_physics::resize(size_t cube_count)
+{
+	if (cube_count == _asleep.size())
+		return;
+
+	_positions.resize(cube_count);
+	_corrected.resize(cube_count);
+	_start.resize(cube_count);
+	_fallen.resize(cube_count);
+	_asleep.resize(cube_count, 0);
+	_supported.resize(cube_count, 0);
+	_pinned.resize(cube_count, 0);
+	_rest_time.resize(cube_count, 0);
+	_island_rest.resize(cube_count);
+	_half_sizes.resize(cube_count);
+	_islands.resize(cube_count);
+	_parents.resize(cube_count);
+	_neighbours.resize(cube_count * max_neighbours);
+	_neighbour_counts.resize(cube_count);
+	_sleeping_neighbours.resize(cube_count);
+	_sleeping_dirty = true;  // removed cubes can be there
+}
+
+void cube_physics::respawn_sleeping(vector<cube_object> & cubes, float dt, vector<uint8_t> & respawned)
+{
+	_wake_islands.clear();
+	for (uint32_t i = 0; i < cubes.size(); ++i)
+	{
+		if (!_asleep[i])
+			continue;
+
+		_rest_time[i] += dt;
+		float const lifetime = sleep_lifetime + (i % 16) * 0.25f;  // not all at once
+		if (_rest_time[i] < lifetime)
+			continue;
+
+		if (find(begin(_wake_islands), end(_wake_islands), _islands[i]) == end(_wake_islands))
+			_wake_islands.push_back(_islands[i]);
+
+		cubes[i] = new_cube();
+		_supported[i] = 0;
+		respawned[i] = 1;
+	}
+
+	if (_wake_islands.empty())
+		return;
+
+	// cubes above respawned one needs to fall
+	for (uint32_t i = 0; i < cubes.size(); ++i)
+	{
+		if (_asleep[i] && find(begin(_wake_islands), end(_wake_islands), _islands[i]) != end(_wake_islands))
+		{
+			_asleep[i] = 0;
+			_rest_time[i] = 0;
+		}
+	}
+
+	_sleeping_dirty = true;
+}
+
+void cube_physics::find_neighbours()
+{
+	GLT_PROFILE_ZONE("broadphase");
+
+	_jobs.parallel_for(_awake.size(), 256, [&](size_t first, size_t last){
+		for (size_t n = first; n < last; ++n)
+		{
+			uint32_t const i = _awake[n];
+			vec3 const & p = _positions[i];
+			float const reach = _half_sizes[i] + broadphase_margin;
+			uint32_t * slots = &_neighbours[i * max_neighbours];
+			uint8_t count = 0,
+				sleeping = 0;
+
+			auto add = [&](uint32_t j, bool asleep){
+				if (j == i || count == max_neighbours)
+					return;
+
+				vec3 const d = _positions[j] - p;
+				float const r = reach + _half_sizes[j];
+				if (fabsf(d.x) < r && fabsf(d.y) < r && fabsf(d.z) < r)
+				{
+					if (asleep)
+						sleeping |= 1u << count;
+					slots[count++] = j;
+				}
+			};
+
+			_awake_grid.query(p, [&](uint32_t j){add(j, false);});
+			_sleeping_grid.query(p, [&](uint32_t j){add(j, true);});
+
+			_neighbour_counts[i] = count;
+			_sleeping_neighbours[i] = sleeping;
+		}
+	});
+}
+
+void cube_physics::find_neighbours_sap()
+{
+	GLT_PROFILE_ZONE("broadphase");
+
+	_sap.update(_positions, _half_sizes, broadphase_margin);
+
+	for (uint32_t i : _awake)
+	{
+		_neighbour_counts[i] = 0;
+		_sleeping_neighbours[i] = 0;
+	}
+
+	for (sweep_and_prune::pair const & p : _sap.find_pairs(_asleep))  // sleeping pairs skipped
+	{
+		add_neighbour(p.a, p.b);
+		add_neighbour(p.b, p.a);
+	}
+}
+
+void cube_physics::add_neighbour(uint32_t i, uint32_t j)
+{
+	uint8_t & count = _neighbour_counts[i];
+	if (_asleep[i] || count == max_neighbours)
+		return;
+
+	if (_asleep[j])
+		_sleeping_neighbours[i] |= 1u << count;
+	_neighbours[i * max_neighbours + count++] = j;
+}
+
+void cube_physics::solve(float correction)
+{
+	GLT_PROFILE_ZONE("narrowphase");
+
+	for (unsigned iteration = 0; iteration < solver_iterations; ++iteration)
+	{
+		_jobs.parallel_for(_awake.size(), 256, [&](size_t first, size_t last){
+			for (size_t n = first; n < last; ++n)
+			{
+				uint32_t const i = _awake[n];
+				vec3 const & p = _positions[i];
+				float const h = _half_sizes[i];
+				AABB const box{p, vec3{h, h, h}};
+
+				// the biggest push in each direction from awake neighbours
+				vec3 push_pos, push_neg;
+				uint32_t const * slots = &_neighbours[i * max_neighbours];
+				for (unsigned k = 0; k < _neighbour_counts[i]; ++k)
+				{
+					if (_sleeping_neighbours[i] & (1u << k))
+						continue;
+
+					uint32_t const j = slots[k];
+					float const hj = _half_sizes[j];
+					CollisionManifold const m = FindCollisionFeatures(AABB{_positions[j], vec3{hj, hj, hj}}, box);
+					if (!m.colliding)
+						continue;
+
+					// shock propagation, lower cube carries the upper one
+					float share = (m.normal.y > 0) ? 1.0f : ((m.normal.y < 0) ? 0.0f : 0.5f);
+					if (_positions[j] == p)  // the same position, only one moves
+						share = (j < i) ? 1.0f : 0.0f;
+					vec3 const push = m.normal * (m.depth * share);
+					for (int a = 0; a < 3; ++a)
+					{
+						push_pos.asArray[a] = max(push_pos.asArray[a], push.asArray[a]);
+						push_neg.asArray[a] = min(push_neg.asArray[a], push.asArray[a]);
+					}
+				}
+
+				vec3 q = p + push_pos + push_neg;
+
+				// sleeping cubes and ground are hard constraints
+				for (unsigned k = 0; k < _neighbour_counts[i]; ++k)
+				{
+					if (!(_sleeping_neighbours[i] & (1u << k)))
+						continue;
+
+					uint32_t const j = slots[k];
+					float const hj = _half_sizes[j];
+					CollisionManifold const m = FindCollisionFeatures(AABB{_positions[j], vec3{hj, hj, hj}},
+						AABB{q, vec3{h, h, h}});
+					if (m.colliding)
+						q = q + m.normal * m.depth;
+				}
+
+				// limited, so cubes stay in occlusion culling bounds (deep overlaps take more steps)
+				vec3 const & f = _fallen[i];
+				q = vec3{clamp(q.x, f.x - correction, f.x + correction),
+					clamp(q.y, f.y - correction, f.y + correction),
+					clamp(q.z, f.z - correction, f.z + correction)};
+
+				q.y = max(q.y, h);
+				_corrected[i] = q;
+			}
+		});
+
+		for (uint32_t i : _awake)
+			_positions[i] = _corrected[i];
+	}
+
+	// cubes lying on the ground or other cube do not fall next step
+	_jobs.parallel_for(_awake.size(), 256, [&](size_t first, size_t last){
+		for (size_t n = first; n < last; ++n)
+		{
+			uint32_t const i = _awake[n];
+			vec3 const & p = _positions[i];
+			float const h = _half_sizes[i];
+			bool supported = p.y - h <= support_distance;
+
+			uint32_t const * slots = &_neighbours[i * max_neighbours];
+			for (unsigned k = 0; k < _neighbour_counts[i] && !supported; ++k)
+			{
+				uint32_t const j = slots[k];
+				vec3 const d = p - _positions[j];
+				float const s = h + _half_sizes[j];
+				supported = fabsf(d.x) < s - support_distance && fabsf(d.z) < s - support_distance
+					&& fabsf(d.y - s) <= support_distance;
+			}
+
+			_supported[i] = supported ? 1 : 0;
+		}
+	});
+}
+
+void cube_physics::update_islands(float dt)
+{
+	GLT_PROFILE_ZONE("islands");
+
+	// rest detection and islands of touching awake cubes
+	unsigned contacts = 0;
+	for (uint32_t i : _awake)
+	{
+		bool const at_rest = phys::DistanceSq(_positions[i], _start[i]) < rest_distance*rest_distance;
+		_rest_time[i] = at_rest ? _rest_time[i] + dt : 0;
+		_parents[i] = i;
+	}
+
+	for (uint32_t i : _awake)
+	{
+		uint32_t const * slots = &_neighbours[i * max_neighbours];
+		contacts += _neighbour_counts[i];
+		for (unsigned k = 0; k < _neighbour_counts[i]; ++k)
+		{
+			if (_sleeping_neighbours[i] & (1u << k))
+				continue;
+
+			uint32_t const a = find_root(i),
+				b = find_root(slots[k]);
+			if (a != b)
+				_parents[max(a, b)] = min(a, b);
+		}
+	}
+
+	_stats.contacts = contacts;
+
+	// island rest time is the shortest rest time of its cubes (kept in root)
+	for (uint32_t i : _awake)
+		_island_rest[i] = FLT_MAX;
+
+	for (uint32_t i : _awake)
+	{
+		uint32_t const root = find_root(i);
+		_island_rest[root] = min(_island_rest[root], _rest_time[i]);
+	}
+
+	// whole islands at rest falls asleep
+	for (uint32_t i : _awake)
+		if (_parents[i] == i && _island_rest[i] >= sleep_delay)
+			_islands[i] = _next_island++;
+
+	// island touching sleeping cubes joins their island, so respawn of a cube
+	// below wakes cubes lying on it (merges map bigger ID to smaller one)
+	_island_merges.clear();
+	for (uint32_t i : _awake)
+	{
+		uint32_t const root = find_root(i);
+		if (_island_rest[root] < sleep_delay || !_sleeping_neighbours[i])
+			continue;
+
+		uint32_t const * slots = &_neighbours[i * max_neighbours];
+		for (unsigned k = 0; k < _neighbour_counts[i]; ++k)
+		{
+			if (!(_sleeping_neighbours[i] & (1u << k)))
+				continue;
+
+			uint32_t const a = merged_island(_islands[root]),
+				b = merged_island(_islands[slots[k]]);
+			if (a != b)
+				_island_merges.emplace_back(max(a, b), min(a, b));
+		}
+	}
+
+	for (uint32_t i : _awake)
+	{
+		uint32_t const root = find_root(i);
+		if (_island_rest[root] < sleep_delay)
+			continue;
+
+		_islands[i] = _islands[root];
+		_asleep[i] = 1;
+		_rest_time[i] = 0;
+		_sleeping_dirty = true;
+	}
+
+	if (!_island_merges.empty())
+		for (uint32_t i = 0; i < _islands.size(); ++i)
+			if (_asleep[i])
+				_islands[i] = merged_island(_islands[i]);
+}
+
+uint32_t cube_physics::merged_island(uint32_t island) const
+{
+	for (bool merged = true; merged;)  // chains are short, only a few islands fall asleep per step
+	{
+		merged = false;
+		for (auto const & [from, to] : _island_merges)
+		{
+			if (from == island)
+			{
+				island = to;
+				merged = true;
+				break;
+			}
+		}
+	}
+	return island;
+}
+
+uint32_t cube_physics::find_root(uint32_t i)
+{
+	while (_parents[i] != i)
+	{
+		_parents[i] = _parents[_parents[i]];  // path halving
+		i = _parents[i];
+	}
+	return i;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "phys/vectors.h"
+#include "job_system.hpp"
+#include "spatial_hash.hpp"
+#include "sweep_and_prune.hpp"
+#include "cube_simulation.hpp"
+
+/*! Falling cubes landing on the ground (y = 0) and piling up.
+
+Each step awake cubes fall, then broadphase finds nearby cubes with uniform
+grid spatial_hash (or sweep_and_prune, see broadphase()) and overlaps (phys::FindCollisionFeatures()) are resolved
+by a few Jacobi iterations of position projection run in parallel per cube.
+Cubes are only pushed out of each other (awake cubes take half of the
+penetration each), there are no velocities nor rotations. Push out in a step
+is limited by max_correction() per axis, so cube moves at most by its fall and
+max_correction() in a step (e.g. for culling bounds).
+
+Touching awake cubes form islands (union-find), an island where all the cubes
+are at rest for sleep_delay falls asleep (joining islands of sleeping cubes it
+touches). Sleeping cubes are static and kept in
+a separate spatial hash rebuilt only when they change, so resting piles cost
+nothing except lookups from awake neighbours. Sleeping cubes respawn after
+sleep_lifetime and wake up their island, so it keeps raining.
+\note Cubes are axis aligned. */
+class cube_physics
+{
+public:
+	static constexpr float cell_size = 0.6f,  //!< >= biggest cube size
+		sleep_delay = 0.3f,  //!< s
+		sleep_lifetime = 6.0f,  //!< s
+		max_correction_speed = 8.0f;  //!< m/s, faster than the fastest fall (landing pushes cube back by its fall)
+	static constexpr unsigned solver_iterations = 4,
+		max_neighbours = 8;  //!< per cube, the rest is ignored
+
+	enum class broadphase_method
+	{
+		spatial_hash,
+		sweep_and_prune
+	};
+
+	struct counters
+	{
+		unsigned awake = 0,
+			sleeping = 0,
+			contacts = 0;  //!< awake-awake and awake-sleeping pairs (counted from both sides)
+	};
+
+	explicit cube_physics(job_system & jobs);
+
+	/*! One simulation step, cubes can be added or removed between steps
+	(new cubes are awake).
+	\param respawned set to 1 for respawned cubes, 0 otherwise */
+	void step(std::vector<cube_object> & cubes, float dt, std::vector<uint8_t> & respawned);
+
+	static float max_correction(float dt);  //!< the biggest push out per axis in dt step
+
+	void broadphase(broadphase_method m);
+	broadphase_method broadphase() const;
+	void wake();  //!< wakes all cubes (e.g. after cubes were moved without step())
+	counters const & stats() const;
+
+	//! 1 for cubes lying on the ground or other cube (state before falling asleep for sleeping cubes)
+	std::vector<uint8_t> const & supported() const;
+
+	/*! 1 for sleeping or supported cubes, 0 otherwise. Pinned cubes must not be
+	moved between steps (sleeping cubes are cached in a spatial hash). */
+	std::vector<uint8_t> const & pinned() const;
+
+	cube_physics(cube_physics const &) = delete;
+	void operator=(cube_physics const &) = delete;
+
+private:
+	void resize(size_t cube_count);
+	void respawn_sleeping(std::vector<cube_object> & cubes, float dt, std::vector<uint8_t> & respawned);
+	void find_neighbours();  //!< spatial hash
+	void find_neighbours_sap();
+	void add_neighbour(uint32_t i, uint32_t j);
+	void solve(float correction);
+	void update_islands(float dt);
+	uint32_t find_root(uint32_t i);
+	uint32_t merged_island(uint32_t island) const;  //!< island ID after _island_merges
+
+	job_system & _jobs;
+	broadphase_method _broadphase;
+	spatial_hash _awake_grid,
+		_sleeping_grid;
+	sweep_and_prune _sap;
+	bool _sleeping_dirty;  //!< sleeping set changed, rebuild _sleeping_grid
+
+	// per cube state
+	std::vector<phys::vec3> _positions,  //!< solver positions
+		_corrected,
+		_start,  //!< position before step
+		_fallen;  //!< position after fall, solver moves cube max_correction() around it
+	std::vector<uint8_t> _asleep,
+		_supported,  //!< lies on the ground or other cube
+		_pinned;  //!< asleep or supported
+	std::vector<float> _rest_time,  //!< for how long cube is at rest (awake) or sleeps
+		_island_rest,  //!< island rest time (in root cube)
+		_half_sizes;
+	std::vector<uint32_t> _islands,  //!< island ID for sleeping cubes
+		_parents,  //!< union-find
+		_neighbours,  //!< max_neighbours slots per cube
+		_awake,
+		_sleeping;
+	std::vector<uint8_t> _neighbour_counts,
+		_sleeping_neighbours;  //!< bit set for sleeping neighbour slot
+	std::vector<uint32_t> _wake_islands;
+	std::vector<std::pair<uint32_t, uint32_t>> _island_merges;  //!< (from, to) island IDs merged this step
+	uint32_t _next_island;
+	counters _stats;
+};
@@ -5,7 +5,12 @@
 #include <random>
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <cassert>
+#include <cstdio>
+#include <cfloat>
+#include <cstddef>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include "imgui/imgui.h"
@@ -13,17 +18,48 @@
 #include "imgui/examples/imgui_impl_opengl3.h"
 #include "phys/matrices.h"
 #include "phys/Camera.h"
+#include "glt/features.hpp"
+#include "glt/debug.hpp"
+#include "glt/gpu_profiler.hpp"
+#include "glt/cpu_profiler.hpp"
+#include "glt/stream_buffer.hpp"
+#include "glt/state.hpp"
+#include "glt/render_queue.hpp"
 #include "flat_shader.hpp"
 #include "flat_shaded_shader.hpp"
-
-using std::transform;
+#include "instanced_shaded_shader.hpp"
+#include "impostor_shader.hpp"
+#include "render_thread.hpp"
+#include "job_system.hpp"
+#include "parallel_sort.hpp"
+#include "occlusion_culler.hpp"
+#include "cube_batch.hpp"
+#include "cube_simulation.hpp"
+#include "gpu_cube_simulation.hpp"
+#include "cube_physics.hpp"
+#include "cube_tumbling.hpp"
+#include "force_fields.hpp"
+#include "cube_bvh.hpp"
+#include "triangle_normals.hpp"
+
+using std::transform,
+	std::copy,
+	std::nth_element,
+	std::fill_n,
+	std::size;
+using std::string,
+	std::stoul;
 using std::vector;
+using std::unique_ptr,
+	std::make_unique;
+using std::mutex,
+	std::lock_guard;
 using std::chrono::steady_clock,
 	std::chrono::duration,
 	std::chrono::duration_cast;
 using std::random_device,
 	std::default_random_engine;
-using std::cout, std::endl;
+using std::cout, std::cerr, std::endl;
 using namespace std::chrono_literals;
 
 using phys::mat4,
@@ -41,6 +77,15 @@ using phys::OrbitCamera;
 constexpr GLuint WIDTH = 800,
 	HEIGHT = 600;
 
+constexpr float Z_NEAR = 0.01f,
+	Z_FAR = 1000.0f;
+
+constexpr float ground_size = 8.0f;  // ground plane half size (cubes are spawned above -7 .. 7)
+
+// overdraw mode adds overdraw_step to red channel per fragment
+constexpr unsigned overdraw_step_bits = 8;
+constexpr float overdraw_step = overdraw_step_bits/255.0f;
+
 // 2 triangles
 constexpr float xz_plane_verts[] = {
 	// triangle 1
@@ -119,7 +164,11 @@ void draw_triangles(GLuint position_vbo, GLuint normal_vbo, GLint position_loc,
 	GLint normal_loc, size_t triangle_count);
 void draw_triangles(GLuint position_vbo, GLint position_loc, size_t triangle_count);
 GLuint push_data(void const * data, size_t size_in_bytes);
-void calc_triangle_normals(float const * positions, size_t triangle_count, float * normals);
+void gpu_profiler_info(glt::gpu_profiler::timings const & prof);
+struct overdraw_stats;
+void overdraw_info(overdraw_stats const & overdraw);
+void force_fields_info(force_fields & forces);  //!< force fields editor
+void dump_trace();
 
 namespace glt::shader {
 
@@ -144,14 +193,46 @@ void set_uniform<vec3>(GLint loc, vec3 const & val)
 }  // gtl::shader
 
 
-// flyweight
-struct cube_object
-{
-	vec3 position;
-	float scale;  // value from 0.8 to 1.2 used to scale unit cube
-};
-
-cube_object new_cube();
+/*! \param extent_scale bounding box half size relative to cube half size
+(e.g. sqrt(3) to bound any rotated cube) */
+occlusion_culler::box cube_bounds(cube_object const & cube, float extent_scale = 1);
+
+/*! Sorts drawn cubes by view depth quantized to 16 bits.
+\param drawn indices of cubes to sort
+\param order index of cube and its depth key sorted front to back */
+void sort_cubes_front_to_back(job_system & jobs, vector<cube_object> const & cubes,
+	vector<uint32_t> const & drawn, mat4 const & world_to_screen, vector<sort_item> & order,
+	vector<sort_item> & temp);
+
+/*! Occlusion culls cubes, nearest occluder_count cubes are rasterized as
+occluders. Cubes are expected to fall for dt after culling (bounding boxes are
+extended by the fall, occluders shrinked).
+\param correction how far cubes can be pushed along each axis after culling
+(e.g. cube_physics::max_correction()), bounding boxes are extended by it and
+occluders shrinked
+\param rotated cubes are rotated (bounding boxes are extended to bound any
+rotation, occluders shrinked to a box inside any rotation)
+\param visible nonzero for visible cube */
+void cull_cubes(job_system & jobs, occlusion_culler & culler, vector<cube_object> const & cubes,
+	mat4 const & world_to_screen, float dt, float correction, bool rotated, unsigned occluder_count,
+	vector<sort_item> & nearest, vector<uint8_t> & visible);
+
+/*! Picks cube LOD by its projected size in pixels.
+\param rotation cube rotation or nullptr for axis aligned cube (octant of
+faces LOD is in cube local space)
+\param eye camera position
+\param point_scale size in pixels of the unit at unit depth
+\param faces_size, impostor_size LOD size thresholds in pixels */
+unsigned cube_lod_of(cube_object const & cube, cube_rotation const * rotation, vec3 const & eye,
+	mat4 const & world_to_screen, float point_scale, float faces_size, float impostor_size);
+
+/*! Fills packet cubes and rotations (in draw order) grouped by LOD, draw order
+is kept within LOD group.
+\param rotations rotation for each cube or empty for axis aligned cubes
+\param order cube indices in draw order */
+void fill_cube_instances(job_system & jobs, vector<cube_object> const & cubes,
+	vector<cube_rotation> const & rotations, vector<uint32_t> const & order, vec3 const & eye,
+	float faces_size, float impostor_size, int highlight, vector<uint8_t> & lods, render_packet & packet);
 
 vec3 random_cube_position();
 
@@ -166,6 +247,8 @@ bool g_rotate_camera = false,
 	g_pan_camera = false;
 vec2 g_cursor_position = vec2{0,0};
 bool g_animation = true;
+bool g_toggle_trace = false;
+bool g_pick = false;  // pick cube under cursor
 
 class orbit_camera : public OrbitCamera
 {
@@ -181,7 +264,7 @@ class axes_model
 {
 public:
 	axes_model(GLuint axes_vbo);
-	void draw(gles2::flat_shader & program, mat4 const & local_to_world);
+	void draw(gles2::flat_shader & program, glt::state_cache & state, mat4 const & local_to_world);
 
 private:
 	GLuint _axes_vbo;
@@ -191,39 +274,631 @@ axes_model::axes_model(GLuint axes_vbo)
 	: _axes_vbo{axes_vbo}
 {}
 
-void axes_model::draw(gles2::flat_shader & program, mat4 const & local_to_world)
+void axes_model::draw(gles2::flat_shader & program, glt::state_cache & state,
+	mat4 const & local_to_world)
 {
 	program.local_to_world(local_to_world);
-
-	GLint position_loc = program.position_location();
-
-	glEnableVertexAttribArray(position_loc);
-	glBindBuffer(GL_ARRAY_BUFFER, _axes_vbo);
+	state.attribute_pointer(program.position_location(), _axes_vbo, 3);
 
 	// x
 	program.model_color(vec3{1,0,0});
-	glVertexAttribPointer(position_loc, 3, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
-	glDrawArrays(GL_LINES, 0, 2);
+	state.draw_arrays(GL_LINES, 0, 2);
 
 	// y
 	program.model_color(vec3{0,1,0});
-	glVertexAttribPointer(position_loc, 3, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
-	glDrawArrays(GL_LINES, 2, 2);
+	state.draw_arrays(GL_LINES, 2, 2);
 
 	// z
 	program.model_color(vec3{0,0,1});
-	glVertexAttribPointer(position_loc, 3, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
-	glDrawArrays(GL_LINES, 4, 2);
+	state.draw_arrays(GL_LINES, 4, 2);
+}
+
+
+//! Fragments per pixel measured in overdraw mode.
+struct overdraw_stats
+{
+	static constexpr unsigned max_layers = 8;  //!< last histogram bucket counts max_layers and more
+
+	bool valid = false;
+	float average = 0;  //!< fragments per covered pixel
+	float histogram[max_layers+1] = {};  //!< pixels per number of fragments
+};
+
+//! GPU pass timings handed over from render thread to GUI
+struct render_stats
+{
+	std::mutex locker;
+	glt::gpu_profiler::timings gpu;
+	bool instanced = false;  //!< cubes drawn with a single instanced draw call
+	bool fenced = false;  //!< instance buffer sync mode (fences or orphaning)
+	unsigned stream_stalls = 0;  //!< instance buffer map() calls waiting for GPU
+	size_t draw_items = 0;  //!< render queue size
+	glt::state_cache::counters state;  //!< state changes in a frame
+	overdraw_stats overdraw;
+};
+
+/*! Scene GL resources and drawing, lives in render thread. Scene is drawn
+through a render queue sorted by program, mesh, material and depth. */
+class scene_renderer
+{
+public:
+	scene_renderer(render_stats & stats, job_system & jobs);
+	~scene_renderer();
+	void render(render_packet & p);
+
+private:
+	struct lod_draw  //!< draw item data for a LOD group
+	{
+		scene_renderer * renderer;
+		GLint first_vertex;  //!< cube or cube faces mesh
+		GLsizei vertex_count;
+		unsigned first_instance,
+			instance_count;
+	};
+
+	void register_draw_states();
+	void read_overdraw();  //!< \note stalls until GPU finishes the frame
+	void upload_instances(render_packet const & p);
+	void push_cubes_instanced(render_packet const & p);
+	void push_cubes_batched(render_packet const & p);  //!< fallback without instanced arrays
+	void push_impostors(render_packet const & p);
+	void push_gpu_cubes(render_packet const & p);
+	char const * pass_name(unsigned program) const;  //!< GPU profiler pass for render queue program
+
+	static void draw_axes(glt::state_cache & state, void const * data);
+	static void draw_ground(glt::state_cache & state, void const * data);
+	static void draw_cubes_instanced(glt::state_cache & state, void const * data);
+	static void draw_cubes_batched(glt::state_cache & state, void const * data);
+	static void draw_impostors(glt::state_cache & state, void const * data);
+	static void draw_gpu_cubes(glt::state_cache & state, void const * data);
+
+	gles2::flat_shader _flat;
+	gles2::flat_shaded_shader _shaded;
+	gles2::instanced_shaded_shader _instanced;
+	gles2::impostor_shader _impostor;
+	glt::gpu_profiler _gpu_prof;
+	glt::state_cache _state;
+	glt::render_queue _queue;
+	glt::stream_buffer _instance_stream;
+	unique_ptr<glt::stream_buffer> _batch_stream;  //!< without instanced arrays only
+	unique_ptr<cube_batcher> _batcher;
+	unique_ptr<gpu_cube_simulation> _gpu_simulation;  //!< created on first use
+	GLuint _cube_position_vbo,
+		_cube_normal_vbo,
+		_axes_position_vbo,
+		_ground_position_vbo,
+		_ground_normal_vbo;
+	axes_model _axes;
+	render_stats & _stats;
+	job_system & _jobs;
+
+	// render queue program, mesh and material ids
+	unsigned _flat_id,
+		_shaded_id,
+		_instanced_id,
+		_impostor_id,
+		_axes_mesh_id,
+		_ground_mesh_id,
+		_cube_batch_mesh_id,
+		_cube_instances_mesh_id,
+		_cube_material_id,
+		_ground_material_id,
+		_cube_instanced_material_id,
+		_impostor_material_id,
+		_overdraw_material_id,
+		_overdraw_instanced_material_id,
+		_overdraw_impostor_material_id;
+
+	render_packet const * _packet;  //!< packet in render
+	GLintptr _instance_offset,  //!< cube instances offset in _instance_stream for current frame
+		_rotation_offset;  //!< cube rotations offset in _instance_stream for current frame
+	lod_draw _lod_draws[cube_lod::count];
+	vector<cube_batcher::group> _batch_groups;
+	GLintptr _batch_offset;  //!< batched cube vertices offset in _batch_stream for current frame
+	GLsizei _batch_vertex_count;
+	vector<uint8_t> _overdraw_pixels;
+	overdraw_stats _overdraw;
+};
+
+//! cube and cube faces (per octant) mesh vertices
+constexpr GLsizei cube_vertex_count = 12*3,
+	cube_faces_vertex_count = 6*3;
+
+constexpr GLint cube_faces_first_vertex(unsigned octant)
+{
+	return cube_vertex_count + octant*cube_faces_vertex_count;
+}
+
+scene_renderer::scene_renderer(render_stats & stats, job_system & jobs)
+	: _instance_stream{GL_ARRAY_BUFFER, 1500*sizeof(cube_instance)}
+	, _cube_position_vbo{0}
+	, _cube_normal_vbo{0}
+	, _axes_position_vbo{push_axes()}
+	, _ground_position_vbo{push_xz_plane()}
+	, _ground_normal_vbo{0}
+	, _axes{_axes_position_vbo}
+	, _stats{stats}
+	, _jobs{jobs}
+	, _packet{nullptr}
+	, _instance_offset{0}
+	, _rotation_offset{0}
+	, _lod_draws{}
+	, _batch_offset{0}
+	, _batch_vertex_count{0}
+{
+	if (!_gpu_prof.available())
+		cout << "GPU timer queries not available, only CPU pass times measured" << endl;
+
+	if (!_state.instancing())
+		cout << "instanced arrays not available, cube vertices batched on CPU" << endl;
+
+	glFrontFace(GL_CCW);
+	glCullFace(GL_BACK);
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glViewport(0, 0, WIDTH, HEIGHT);
+
+	if (!glt::features().gles)
+		glEnable(GL_PROGRAM_POINT_SIZE);  // always on in ES
+
+	// cube mesh followed by 3 face meshes for each octant
+	vector<float> positions(cube_verts, cube_verts + cube_vertex_count*3);
+	for (unsigned octant = 0; octant < 8; ++octant)
+	{
+		// first vertex of -z, +z, -x, +x, -y and +y faces in cube_verts
+		constexpr unsigned z_faces[2] = {0, 12},
+			x_faces[2] = {18, 6},
+			y_faces[2] = {24, 30};
+
+		for (unsigned face : {x_faces[octant & 1], y_faces[(octant >> 1) & 1], z_faces[(octant >> 2) & 1]})
+			positions.insert(end(positions), cube_verts + face*3, cube_verts + (face+6)*3);
+	}
+
+	size_t const triangle_count = positions.size()/9;
+	vector<float> normals(positions.size());
+	calc_triangle_normals(positions.data(), triangle_count, normals.data());
+
+	_cube_position_vbo = push_data(positions.data(), positions.size()*sizeof(float));
+	_cube_normal_vbo = push_data(normals.data(), normals.size()*sizeof(float));
+
+	glt::debug::label(glt::debug::object::buffer, _cube_position_vbo, "cube positions");
+	glt::debug::label(glt::debug::object::buffer, _cube_normal_vbo, "cube normals");
+	glt::debug::label(glt::debug::object::buffer, _axes_position_vbo, "axes positions");
+
+	float ground_normals[size(xz_plane_verts)];
+	calc_triangle_normals(xz_plane_verts, size(xz_plane_verts)/9, ground_normals);
+	_ground_normal_vbo = push_data(ground_normals, sizeof(ground_normals));
+	glt::debug::label(glt::debug::object::buffer, _ground_position_vbo, "ground positions");
+	glt::debug::label(glt::debug::object::buffer, _ground_normal_vbo, "ground normals");
+	glt::debug::label(glt::debug::object::buffer, _instance_stream.id(), "cube instances");
+
+	if (!_state.instancing())
+	{
+		_batcher = make_unique<cube_batcher>(positions.data(), normals.data(), positions.size()/3);
+		_batch_stream = make_unique<glt::stream_buffer>(GL_ARRAY_BUFFER,
+			1500*cube_vertex_count*sizeof(cube_batcher::vertex));
+		glt::debug::label(glt::debug::object::buffer, _batch_stream->id(), "batched cubes");
+	}
+
+	register_draw_states();
+}
+
+scene_renderer::~scene_renderer()
+{
+	glDeleteBuffers(1, &_cube_position_vbo);
+	glDeleteBuffers(1, &_cube_normal_vbo);
+	glDeleteBuffers(1, &_axes_position_vbo);
+	glDeleteBuffers(1, &_ground_position_vbo);
+	glDeleteBuffers(1, &_ground_normal_vbo);
+}
+
+void scene_renderer::register_draw_states()
+{
+	// programs (per frame uniforms)
+	_flat_id = _queue.add_program([this](glt::state_cache & s){
+		s.use(_flat);
+		s.enable_attributes(1u << _flat.position_location());
+		_flat.world_to_screen(_packet->world_to_screen);
+	});
+
+	_shaded_id = _queue.add_program([this](glt::state_cache & s){
+		s.use(_shaded);
+		s.enable_attributes((1u << _shaded.position_location()) | (1u << _shaded.normal_location()));
+		_shaded.light_direction(_packet->light_direction);
+		_shaded.world_to_screen(_packet->world_to_screen);
+	});
+
+	_instanced_id = _queue.add_program([this](glt::state_cache & s){
+		s.use(_instanced);
+		bool const rotated = !_packet->rotations.empty();
+		s.enable_attributes(_instanced.attribute_mask(rotated));
+		if (!rotated)
+			_instanced.identity_rotation();
+		_instanced.light_direction(_packet->light_direction);
+		_instanced.world_to_screen(_packet->world_to_screen);
+		if (_packet->highlight >= 0 && !_packet->overdraw)
+			_instanced.highlight(_packet->cubes[_packet->highlight].position);
+		else
+			_instanced.no_highlight();
+	});
+
+	_impostor_id = _queue.add_program([this](glt::state_cache & s){
+		s.use(_impostor);
+		s.enable_attributes(1u << _impostor.instance_location());
+		_impostor.light_direction(_packet->light_direction);
+		_impostor.world_to_screen(_packet->world_to_screen);
+		_impostor.point_scale(_packet->point_scale);
+	});
+
+	// meshes
+	_axes_mesh_id = _queue.add_mesh([this](glt::state_cache & s){
+		s.attribute_pointer(_flat.position_location(), _axes_position_vbo, 3);
+	});
+
+	_ground_mesh_id = _queue.add_mesh([this](glt::state_cache & s){
+		s.attribute_pointer(_shaded.position_location(), _ground_position_vbo, 3);
+		s.attribute_pointer(_shaded.normal_location(), _ground_normal_vbo, 3);
+	});
+
+	_cube_batch_mesh_id = _queue.add_mesh([this](glt::state_cache & s){  // interleaved, changes every frame
+		GLsizei const stride = sizeof(cube_batcher::vertex);
+		s.attribute_pointer(_shaded.position_location(), _batch_stream->id(), 3, stride, _batch_offset);
+		s.attribute_pointer(_shaded.normal_location(), _batch_stream->id(), 3, stride,
+			_batch_offset + offsetof(cube_batcher::vertex, normal));
+	});
+
+	_cube_instances_mesh_id = _queue.add_mesh([this](glt::state_cache & s){  // instance pointer set by draw
+		s.attribute_pointer(_instanced.position_location(), _cube_position_vbo, 3);
+		s.attribute_pointer(_instanced.normal_location(), _cube_normal_vbo, 3);
+	});
+
+	// materials
+	vec3 const cube_color = vec3{1,0,0};
+
+	_cube_material_id = _queue.add_material([this, cube_color](glt::state_cache &){
+		_shaded.model_color(cube_color);
+	});
+
+	_ground_material_id = _queue.add_material([this](glt::state_cache &){
+		_shaded.model_color(vec3{0.5f, 0.5f, 0.5f});
+	});
+
+	_cube_instanced_material_id = _queue.add_material([this, cube_color](glt::state_cache &){
+		_instanced.model_color(cube_color);
+	});
+
+	_impostor_material_id = _queue.add_material([this, cube_color](glt::state_cache &){
+		_impostor.model_color(cube_color);
+	});
+
+	/* Overdraw mode material, with zero light direction is shaded color
+	max(dot(n, 0), 0.2)*color so each fragment adds overdraw_step to red channel
+	(with additive blending). */
+	vec3 const overdraw_color = vec3{overdraw_step/0.2f, 0, 0};
+
+	_overdraw_material_id = _queue.add_material([this, overdraw_color](glt::state_cache &){
+		_shaded.model_color(overdraw_color);
+		_shaded.light_direction(vec3{0,0,0});
+	});
+
+	_overdraw_instanced_material_id = _queue.add_material([this, overdraw_color](glt::state_cache &){
+		_instanced.model_color(overdraw_color);
+		_instanced.light_direction(vec3{0,0,0});
+	});
+
+	_overdraw_impostor_material_id = _queue.add_material([this, overdraw_color](glt::state_cache &){
+		_impostor.model_color(overdraw_color);
+		_impostor.light_direction(vec3{0,0,0});
+	});
+}
+
+void scene_renderer::render(render_packet & p)
+{
+	_gpu_prof.begin_frame();
+	_state.reset_stats();
+	_packet = &p;
+
+	glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+
+	{
+		GLT_PROFILE_ZONE("build render queue");
+		_queue.clear();
+		if (!p.overdraw)
+			_queue.push(glt::sort_key::make(0, _flat_id, _axes_mesh_id, 0, 0), draw_axes, this);
+
+		if (p.ground && !p.overdraw)
+			_queue.push(glt::sort_key::make(0, _shaded_id, _ground_mesh_id, _ground_material_id, 1),
+				draw_ground, this);
+
+		if (p.gpu_cubes > 0)
+			push_gpu_cubes(p);
+		else
+		{
+			upload_instances(p);
+
+			if (_state.instancing())
+				push_cubes_instanced(p);
+			else
+				push_cubes_batched(p);
+
+			push_impostors(p);
+		}
+
+		_queue.sort();
+	}
+
+	if (p.overdraw)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+	}
+
+	_queue.submit(_state, [this](unsigned program, bool begin){
+		if (begin)
+			_gpu_prof.begin(pass_name(program));
+		else
+			_gpu_prof.end();
+	});
+
+	if (p.overdraw)
+	{
+		glDisable(GL_BLEND);
+		read_overdraw();
+	}
+	else
+		_overdraw.valid = false;
+
+	if (ImDrawData * gui = p.gui.draw_data())
+	{
+		glt::gpu_profiler::scope pass{_gpu_prof, "imgui"};
+		GLT_PROFILE_ZONE("draw imgui");
+		ImGui_ImplOpenGL3_RenderDrawData(gui);
+		_state.invalidate();  // ImGui backend changes GL state behind our back
+	}
+
+	_instance_stream.end_frame();
+	if (_batch_stream)
+		_batch_stream->end_frame();
+	_packet = nullptr;
+
+	lock_guard<mutex> lock{_stats.locker};
+	_stats.gpu = _gpu_prof.results();
+	_stats.instanced = _state.instancing();
+	_stats.fenced = _instance_stream.fenced();
+	_stats.stream_stalls = _instance_stream.stalls();
+	_stats.draw_items = _queue.items().size();
+	_stats.state = _state.stats();
+	_stats.overdraw = _overdraw;
+}
+
+char const * scene_renderer::pass_name(unsigned program) const
+{
+	if (program == _flat_id)
+		return "axes";
+	else if (program == _shaded_id)
+		return _state.instancing() ? "ground" : "ground, cubes";  // batched cubes share the program
+	else if (program == _instanced_id)
+		return "cubes";
+	else if (program == _impostor_id)
+		return "impostors";
+	else
+		return "other";
+}
+
+void scene_renderer::read_overdraw()
+{
+	GLT_PROFILE_ZONE("read overdraw");
+
+	_overdraw_pixels.resize(WIDTH*HEIGHT*4);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, _overdraw_pixels.data());
+
+	unsigned histogram[overdraw_stats::max_layers+1] = {};
+	unsigned fragments = 0;
+	for (size_t i = 0; i < _overdraw_pixels.size(); i += 4)
+	{
+		unsigned layers = (_overdraw_pixels[i] + overdraw_step_bits/2) / overdraw_step_bits;  // red channel
+		fragments += layers;
+		++histogram[std::min(layers, overdraw_stats::max_layers)];
+	}
+
+	unsigned const covered = WIDTH*HEIGHT - histogram[0];
+	_overdraw.valid = true;
+	_overdraw.average = covered ? fragments / float(covered) : 0;
+	for (unsigned i = 0; i <= overdraw_stats::max_layers; ++i)
+		_overdraw.histogram[i] = histogram[i];
+}
+
+void scene_renderer::upload_instances(render_packet const & p)
+{
+	// LOD groups
+	unsigned first = 0;
+	for (unsigned lod = 0; lod < cube_lod::count; ++lod)
+	{
+		lod_draw & d = _lod_draws[lod];
+		d.renderer = this;
+		d.first_instance = first;
+		d.instance_count = p.lod_counts[lod];
+		d.first_vertex = (lod == cube_lod::full) ? 0 : cube_faces_first_vertex(lod - cube_lod::faces);
+		d.vertex_count = (lod == cube_lod::full) ? cube_vertex_count : cube_faces_vertex_count;
+		first += d.instance_count;
+	}
+
+	if (p.cubes.empty())
+		return;
+
+	GLT_PROFILE_ZONE("instance upload");
+	_instance_stream.reserve(glt::stream_buffer::map_size<cube_instance>(p.cubes.size())
+		+ glt::stream_buffer::map_size<cube_rotation>(p.rotations.size()));  // both maps in one region
+
+	glt::span<cube_instance> instances = _instance_stream.map<cube_instance>(p.cubes.size());
+	copy(begin(p.cubes), end(p.cubes), instances.begin());
+	_instance_offset = _instance_stream.unmap();
+
+	if (!p.rotations.empty())
+	{
+		glt::span<cube_rotation> rotations = _instance_stream.map<cube_rotation>(p.rotations.size());
+		copy(begin(p.rotations), end(p.rotations), rotations.begin());
+		_rotation_offset = _instance_stream.unmap();
+	}
 }
 
+void scene_renderer::push_cubes_instanced(render_packet const & p)
+{
+	unsigned const material = p.overdraw ? _overdraw_instanced_material_id : _cube_instanced_material_id;
+
+	for (unsigned lod = cube_lod::full; lod < cube_lod::impostor; ++lod)
+	{
+		if (_lod_draws[lod].instance_count > 0)
+		{
+			_queue.push(glt::sort_key::make(0, _instanced_id, _cube_instances_mesh_id, material, 0),
+				draw_cubes_instanced, &_lod_draws[lod]);
+		}
+	}
+}
+
+void scene_renderer::push_cubes_batched(render_packet const & p)
+{
+	_batch_groups.clear();
+	for (unsigned lod = cube_lod::full; lod < cube_lod::impostor; ++lod)
+	{
+		lod_draw const & d = _lod_draws[lod];
+		if (d.instance_count > 0)
+			_batch_groups.push_back(cube_batcher::group{d.first_instance, d.instance_count,
+				(unsigned)d.first_vertex, (unsigned)d.vertex_count});
+	}
+
+	_batch_vertex_count = _batcher->vertex_count(_batch_groups);
+	if (_batch_vertex_count == 0)
+		return;
+
+	// vertices are transformed directly into the mapped buffer by workers
+	glt::span<cube_batcher::vertex> vertices = _batch_stream->map<cube_batcher::vertex>(_batch_vertex_count);
+	_batcher->transform(_jobs, p.cubes.data(), p.rotations.empty() ? nullptr : p.rotations.data(),
+		_batch_groups, vertices.begin());
+	_batch_offset = _batch_stream->unmap();
+
+	unsigned const material = p.overdraw ? _overdraw_material_id : _cube_material_id;
+	_queue.push(glt::sort_key::make(0, _shaded_id, _cube_batch_mesh_id, material, 0),
+		draw_cubes_batched, this);
+}
 
+void scene_renderer::push_impostors(render_packet const & p)
+{
+	if (_lod_draws[cube_lod::impostor].instance_count == 0)
+		return;
+
+	unsigned const material = p.overdraw ? _overdraw_impostor_material_id : _impostor_material_id;
+	_queue.push(glt::sort_key::make(0, _impostor_id, 0, material, 1), draw_impostors,
+		&_lod_draws[cube_lod::impostor]);
+}
+
+void scene_renderer::push_gpu_cubes(render_packet const & p)
+{
+	if (!_gpu_simulation)
+		_gpu_simulation = make_unique<gpu_cube_simulation>();
+
+	_gpu_simulation->resize(p.gpu_cubes);
+
+	{
+		glt::gpu_profiler::scope pass{_gpu_prof, "gpu simulation"};
+		_gpu_simulation->update(p.dt);
+	}
+	_state.invalidate();  // simulation binds its own program and buffers
+
+	unsigned const material = p.overdraw ? _overdraw_instanced_material_id : _cube_instanced_material_id;
+	_queue.push(glt::sort_key::make(0, _instanced_id, _cube_instances_mesh_id, material, 0),
+		draw_gpu_cubes, this);
+}
+
+void scene_renderer::draw_axes(glt::state_cache & state, void const * data)
+{
+	scene_renderer * self = (scene_renderer *)data;
+	mat4 M_axes = Translation(vec3{0,0,0});
+	self->_axes.draw(self->_flat, state, M_axes);
+}
+
+void scene_renderer::draw_ground(glt::state_cache & state, void const * data)
+{
+	scene_renderer * self = (scene_renderer *)data;
+	self->_shaded.local_to_world(Scale(vec3{ground_size, 1, ground_size}));
+	state.draw_arrays(GL_TRIANGLES, 0, size(xz_plane_verts)/3);
+}
+
+void scene_renderer::draw_cubes_instanced(glt::state_cache & state, void const * data)
+{
+	lod_draw const & d = *(lod_draw const *)data;
+	scene_renderer * self = d.renderer;
+
+	// no base instance in ES, so instance data offset is set per draw
+	state.attribute_pointer(self->_instanced.instance_location(), self->_instance_stream.id(), 4, 0,
+		self->_instance_offset + d.first_instance*sizeof(cube_instance), 1);
+
+	if (!self->_packet->rotations.empty())
+	{
+		GLintptr const offset = self->_rotation_offset + d.first_instance*sizeof(cube_rotation);
+		for (unsigned row = 0; row < 3; ++row)
+			state.attribute_pointer(self->_instanced.rotation_location(row), self->_instance_stream.id(), 3,
+				sizeof(cube_rotation), offset + row*sizeof(vec3), 1);
+	}
+
+	state.draw_arrays_instanced(GL_TRIANGLES, d.first_vertex, d.vertex_count, d.instance_count);
+}
+
+void scene_renderer::draw_cubes_batched(glt::state_cache & state, void const * data)
+{
+	scene_renderer * self = (scene_renderer *)data;
+	self->_shaded.local_to_world(mat4{});  // vertices are already in world space
+	state.draw_arrays(GL_TRIANGLES, 0, self->_batch_vertex_count);
+}
+
+void scene_renderer::draw_gpu_cubes(glt::state_cache & state, void const * data)
+{
+	scene_renderer * self = (scene_renderer *)data;
+	gpu_cube_simulation const & sim = *self->_gpu_simulation;
+
+	// simulation output is drawn directly
+	state.attribute_pointer(self->_instanced.instance_location(), sim.instances(), 4, 0, 0, 1);
+	state.draw_arrays_instanced(GL_TRIANGLES, 0, cube_vertex_count, sim.size());
+}
+
+void scene_renderer::draw_impostors(glt::state_cache & state, void const * data)
+{
+	lod_draw const & d = *(lod_draw const *)data;
+	scene_renderer * self = d.renderer;
+
+	// instance data drawn directly as points
+	state.attribute_pointer(self->_impostor.instance_location(), self->_instance_stream.id(), 4, 0,
+		self->_instance_offset);
+	state.draw_arrays(GL_POINTS, d.first_instance, d.instance_count);
+}
+
+
+/*! Usage: cube_rain [--trace-frames N]
+
+--trace-frames N: bench mode, captures CPU profiler zones for the first N
+frames and writes them into cube_rain_trace.json (press T to start/stop the
+capture on demand). */
 int main(int argc, char * argv[]) 
 {
+	unsigned trace_frames = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (string{argv[i]} == "--trace-frames" && i+1 < argc)
+			trace_frames = stoul(argv[++i]);
+	}
+
+	glt::profile::thread_name("main");
+	if (trace_frames > 0)
+		glt::profile::start_capture();
+
 	glfwInit();
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
-	
+#ifndef NDEBUG
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+
 	GLFWwindow * window = glfwCreateWindow(WIDTH, HEIGHT, __FILE__, NULL, NULL);
 	assert(window);
 	glfwMakeContextCurrent(window);
@@ -240,6 +915,12 @@ int main(int argc, char * argv[])
 
 	bool err = glewInit() != GLEW_OK;
 
+	glt::init_features();
+#ifndef NDEBUG
+	if (!glt::debug::install(glt::debug::severity::low))
+		cout << "KHR_debug not available, glGetError() checks used" << endl;
+#endif
+
 	// Setup Dear ImGui context
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -249,57 +930,111 @@ int main(int argc, char * argv[])
 	// Setup Platform/Renderer bindings
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init();
+	ImGui_ImplOpenGL3_CreateDeviceObjects();  // fonts needs to be ready before render thread starts
+
+	// from now on context is owned by render thread
+	glfwMakeContextCurrent(nullptr);
+
+	render_stats stats;
+	job_system jobs;
+	unique_ptr<scene_renderer> renderer;
+	render_thread renderer_thread{window,
+		[&renderer, &stats, &jobs]{renderer = make_unique<scene_renderer>(stats, jobs);},
+		[&renderer, window](render_packet & p){
+			renderer->render(p);
+			GLT_PROFILE_ZONE("swap");
+			glfwSwapBuffers(window);
+		},
+		[&renderer]{
+			renderer.reset();
+			ImGui_ImplOpenGL3_Shutdown();
+		}};
 
-	gles2::flat_shader flat;
-	gles2::flat_shaded_shader shaded;
-
-	vec3 cube_color = vec3{1,0,0},
-		axis_color = vec3{1,0,0},
-		light_source_color = vec3{1,1,0};
-	
-	// light
-	vec3 const light_position = vec3{10, 10, -10},
-		light_direction = Normalized(light_position);
-	
 	orbit_camera cam;
-	cam.Perspective(60, WIDTH/(float)HEIGHT, 0.01f, 1000.0f);
+	cam.Perspective(60, WIDTH/(float)HEIGHT, Z_NEAR, Z_FAR);
 	cam.SetTarget(vec3{0,0,0});
-	
-	glFrontFace(GL_CCW);
-	glCullFace(GL_BACK);
-	glEnable(GL_DEPTH_TEST);
-	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-	glViewport(0, 0, WIDTH, HEIGHT);
 
-	// positions
-	GLuint cube_position_vbo = push_cube(),
-		axes_position_vbo = push_axes();
-	axes_model axes{axes_position_vbo};
-	
-	// prepare normal data
-	GLfloat normals[12*3*3];  // for 12 triangles
-	calc_triangle_normals(cube_verts, 12, normals);
-	GLuint cube_normal_vbo = push_data(normals, sizeof(normals));
-		
 	steady_clock::time_point last_tp = steady_clock::now();
-	
+
+	vector<sort_item> depth_order,
+		sort_temp;
+	bool front_to_back = true,
+		show_overdraw = false;
+
+	occlusion_culler culler;
+	vector<cube_object> cull_snapshot;
+	vector<sort_item> cull_order;
+	vector<uint8_t> cube_visible,
+		respawned;
+	vector<uint32_t> drawn,  // indices of cubes to draw
+		draw_order;
+	vector<uint8_t> cube_lods;
+	bool lod = true;
+	bool gpu_simulation = false;
+	cube_physics physics{jobs};
+	bool ground = true;  // cubes land on the ground and pile up
+	cube_tumbling tumbling;
+	vector<cube_rotation> cube_rotations;
+	bool tumble = true;  // cubes rotate while falling
+	force_fields forces;
+	forces.add(force_field{force_field::kind::wind, false, vec3{1, 0, 0.3f}, 2});
+	forces.add(force_field{force_field::kind::turbulence, false, vec3{}, 3, 4, 1});
+	int gpu_cube_count = 100000;
+	float faces_lod_size = 24,  // px
+		impostor_lod_size = 6;
+	bool occlusion_culling = true;
+	int occluder_count = 32;
+
 	int cube_count = 300;
 	vector<cube_object> cubes(cube_count);
 	for (cube_object & cube : cubes)
 		cube = new_cube();
 
-	float light_angle = 0,
-		cube_angle = 0;
+	cube_bvh bvh;  // for picking
+	int picked = -1;  // picked cube index
+	bool frozen = false;  // picked cube stays in place
+	vec3 frozen_position;
+
+	glt::gpu_profiler::timings gpu_timings;
+	bool instanced = false,
+		fenced = false;
+	unsigned stream_stalls = 0;
+	size_t draw_items = 0;
+	glt::state_cache::counters state_changes;
+	overdraw_stats overdraw;
+	unsigned frame = 0;
+
+	float light_angle = 0;
 		
 	vec2 prev_cursor_position = g_cursor_position;
 
 	while (!glfwWindowShouldClose(window))
 	{
 		// input
-		glfwPollEvents();
+		{
+			GLT_PROFILE_ZONE("input");
+			glfwPollEvents();
+		}
+
+		glt::debug::pump([](glt::debug::message const & m){
+			cerr << m << "\n";
+		});
 
 		vec2 cursor_move = g_cursor_position - prev_cursor_position;
 		prev_cursor_position = g_cursor_position;
+
+		if (g_toggle_trace)  // on demand trace
+		{
+			if (glt::profile::capturing())
+			{
+				glt::profile::stop_capture();
+				dump_trace();
+			}
+			else
+				glt::profile::start_capture();
+
+			g_toggle_trace = false;
+		}
 		
 		// update
 
@@ -315,6 +1050,8 @@ int main(int argc, char * argv[])
 		{
 			int prev_cube_count = cubes.size();
 			cubes.resize(cube_count);
+			if (picked >= cube_count)
+				picked = -1;
 
 			if (cube_count > prev_cube_count)
 			{
@@ -328,43 +1065,93 @@ int main(int argc, char * argv[])
 			one_second_counter -= 1;
 		}
 
-		cam.SetZoom(g_camera_zoom);
-		if (cursor_move != vec2{0,0})
 		{
-			if (g_rotate_camera)
-				cam.Rotate(cursor_move, dt);
-			else if (g_pan_camera)
-				cam.Pan(cursor_move, dt);
-		}
+			GLT_PROFILE_ZONE("camera update");
+			cam.SetZoom(g_camera_zoom);
+			if (cursor_move != vec2{0,0})
+			{
+				if (g_rotate_camera)
+					cam.Rotate(cursor_move, dt);
+				else if (g_pan_camera)
+					cam.Pan(cursor_move, dt);
+			}
 
-		cam.Update(dt);
+			cam.Update(dt);
+		}
 
-		// draw gui
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
+		if (gpu_simulation)  // no per cube work on CPU
+		{
+			drawn.clear();
+			picked = -1;
+			g_pick = false;
+		}
+		else
+		{
+			// force fields move cubes before culling, so culled boxes need to be extended only by the fall
+			// and by contact push out of ground physics (see cube_physics::max_correction())
+			if (g_animation && forces.active())
+				forces.apply(jobs, cubes, dt, ground ? &physics.pinned() : nullptr);
+
+			// occlusion culling runs in parallel with simulation (with cube positions before simulation step)
+			job_counter culling;
+			if (occlusion_culling)
+			{
+				cull_snapshot = cubes;
+				mat4 const VP = cam.GetViewProjectionMatrix();
+				float const fall_dt = g_animation ? dt : 0,
+					correction = ground ? cube_physics::max_correction(fall_dt) : 0;
+				jobs.run(culling, [&, VP, fall_dt, correction, tumble]{
+					cull_cubes(jobs, culler, cull_snapshot, VP, fall_dt, correction, tumble, occluder_count,
+						cull_order, cube_visible);
+				});
+			}
 
-		ImGui::Begin("Info");  // begin window
+			// falling cubes simulation
+			if (g_animation && ground)
+				physics.step(cubes, dt, respawned);  // respawned cubes are not known to culling
+			else if (g_animation)
+				fall_cubes(cubes, dt, respawned);
+			else
+				respawned.assign(cubes.size(), 0);
 
-		// ...
-		ImGui::SliderInt("Number of cubes", &cube_count, 100, 1500);
+			forces.respawn(respawned);
 
-		ImGui::End();  // end window
+			if (picked >= 0 && frozen)  // moved by simulation and forces, put it back
+				cubes[picked].position = frozen_position;
+			else if (picked >= 0 && respawned[picked])
+				picked = -1;
 
-		ImGui::Render();
+			// respawned cubes start axis aligned, landed cubes stop tumbling
+			if (tumble)
+			{
+				tumbling.resize(cubes.size());
+				tumbling.respawn(respawned);
+				if (g_animation)
+				{
+					if (ground)
+						tumbling.land(physics.supported());
+					tumbling.integrate(jobs, dt);
+				}
+				tumbling.rotations(jobs, cube_rotations);
+			}
+			else
+				cube_rotations.clear();
 
-		// draw scene
+			bvh.build(jobs, cubes, cube_rotations);
+			if (g_pick)
+			{
+				picked = bvh.pick(cam.GetPickRay(g_cursor_position, vec2{WIDTH, HEIGHT}), cube_rotations);
+				frozen = false;
+				g_pick = false;
+			}
 
-		glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
-		
-		mat4 world_to_screen = cam.GetViewMatrix() * cam.GetProjectionMatrix();
+			jobs.wait(culling);
 
-		// axis
-		flat.use();
-		flat.model_color(axis_color);
-		flat.world_to_screen(world_to_screen);
-		mat4 M_axes = Translation(vec3{0,0,0});
-		axes.draw(flat, M_axes);
+			drawn.clear();
+			for (uint32_t i = 0; i < cubes.size(); ++i)
+				if (!occlusion_culling || cube_visible[i] || respawned[i])
+					drawn.push_back(i);
+		}
 
 		// change light direction
 		float const angular_velocity = DEG2RAD(30.f);  // rad/s
@@ -372,63 +1159,166 @@ int main(int argc, char * argv[])
 		light_angle = DEG2RAD(60.f);
 		if (light_angle >= DEG2RAD(90.f))
 			light_angle = 0.f;
-		vec3 light_direction = Normalized(
-			vec3{0, sinf(light_angle), -cosf(light_angle)});
-
-		// light source
-		constexpr float light_distance = 5.f;
-		flat.model_color(light_source_color);
-		mat4 M_light = Scale(vec3{0.1f, 0.1f, 0.1f}) * Translation(light_direction * light_distance);
-		flat.local_to_world(M_light);
-//		draw_triangles(cube_position_vbo, flat.position_location(), 12);
-
-		// draw cube
-		shaded.use();
-		shaded.model_color(cube_color);
-		shaded.light_direction(light_direction);
-		shaded.world_to_screen(world_to_screen);
-
-		constexpr float cube_angular_velocity = 360/8.f;  // deg/s
-		if (g_animation)
-			cube_angle += cube_angular_velocity * dt;
-
-		mat4 M_cube = YRotation(cube_angle) * Translation(vec3{3,0,0});
-		shaded.local_to_world(M_cube);
-
-//		draw_triangles(cube_position_vbo, cube_normal_vbo, shaded.position_location(),
-//			shaded.normal_location(), 12);
-		
-		// draw falling cubes
-		for (cube_object & cube : cubes)
+
+		// fill render packet for the next frame (while render thread draws the current one)
+		render_packet & packet = renderer_thread.packet();
+		packet.world_to_screen = cam.GetViewProjectionMatrix();
+		packet.light_direction = Normalized(vec3{0, sinf(light_angle), -cosf(light_angle)});
+		packet.overdraw = show_overdraw;
+		packet.ground = ground && !gpu_simulation;
+
+		packet.point_scale = HEIGHT / (2*tanf(DEG2RAD(cam.GetFov())/2));
+		packet.gpu_cubes = gpu_simulation ? gpu_cube_count : 0;
+		packet.dt = g_animation ? dt : 0;
+
+		if (gpu_simulation)
+		{
+			packet.cubes.clear();
+			packet.rotations.clear();
+			packet.highlight = -1;
+			fill_n(packet.lod_counts, cube_lod::count, 0);
+		}
+		else
 		{
-			constexpr float fall_speed = 3.f;
-			if (g_animation)
-				cube.position.y -= fall_speed * (2.f - cube.scale) * dt;
-			
-			// reuse fallen cubes
-			if (cube.position.y < -10.f)
+			GLT_PROFILE_ZONE("instance data");
+			if (front_to_back)  // less overdraw thanks to early depth test
 			{
-				cube = new_cube();
-				continue;
+				sort_cubes_front_to_back(jobs, cubes, drawn, packet.world_to_screen, depth_order,
+					sort_temp);
+				draw_order.resize(depth_order.size());
+				transform(begin(depth_order), end(depth_order), begin(draw_order),
+					[](sort_item const & item){return item.index;});
 			}
-		
-			mat4 M = Scale(vec3{0.2f, 0.2f, 0.2f}*cube.scale) * Translate(cube.position);
-			shaded.local_to_world(M);
+			else
+				draw_order = drawn;
+
+			mat4 const & camera_world = cam.GetWorldMatrix();
+			vec3 const eye{camera_world._41, camera_world._42, camera_world._43};
+			float const faces_size = lod ? faces_lod_size : 0,
+				impostor_size = lod ? impostor_lod_size : 0;
+			fill_cube_instances(jobs, cubes, cube_rotations, draw_order, eye, faces_size, impostor_size,
+				picked, cube_lods, packet);
+		}
 
-			draw_triangles(cube_position_vbo, cube_normal_vbo, shaded.position_location(),
-				shaded.normal_location(), 12);
+		// draw gui
+		{
+			GLT_PROFILE_ZONE("imgui build");
+
+			{
+				lock_guard<mutex> lock{stats.locker};
+				gpu_timings = stats.gpu;
+				instanced = stats.instanced;
+				fenced = stats.fenced;
+				stream_stalls = stats.stream_stalls;
+				draw_items = stats.draw_items;
+				state_changes = stats.state;
+				overdraw = stats.overdraw;
+			}
+
+			ImGui_ImplOpenGL3_NewFrame();
+			ImGui_ImplGlfw_NewFrame();
+			ImGui::NewFrame();
+
+			ImGui::Begin("Info");  // begin window
+
+			// ...
+			if (gpu_cube_simulation::available())
+				ImGui::Checkbox("GPU simulation", &gpu_simulation);
+			if (gpu_simulation)
+			{
+				ImGui::DragInt("Number of cubes", &gpu_cube_count, 1000, 1000, 4000000);
+				ImGui::Text("cubes simulated with transform feedback, no culling and LOD");
+			}
+			else
+			{
+				ImGui::SliderInt("Number of cubes", &cube_count, 100, ground ? 10000 : 1500);
+				ImGui::Checkbox("Tumbling", &tumble);
+				if (ImGui::Checkbox("Ground", &ground) && ground)
+					physics.wake();  // cubes moved without physics
+				if (ground)
+				{
+					int method = (int)physics.broadphase();
+					bool const hash = ImGui::RadioButton("Spatial hash", &method,
+						(int)cube_physics::broadphase_method::spatial_hash);
+					ImGui::SameLine();
+					bool const sap = ImGui::RadioButton("Sweep and prune", &method,
+						(int)cube_physics::broadphase_method::sweep_and_prune);
+					if (hash || sap)
+						physics.broadphase((cube_physics::broadphase_method)method);
+
+					cube_physics::counters const & ps = physics.stats();
+					ImGui::Text("%u awake, %u sleeping cubes, %u contacts", ps.awake, ps.sleeping,
+						ps.contacts);
+				}
+				force_fields_info(forces);
+
+				if (picked >= 0)
+				{
+					cube_object const & cube = cubes[picked];
+					ImGui::Text("cube %d at (%.2f, %.2f, %.2f), scale %.2f%s", picked, cube.position.x,
+						cube.position.y, cube.position.z, cube.scale,
+						(ground && physics.pinned()[picked]) ? ", resting" : "");
+					if (ImGui::Checkbox("Freeze", &frozen) && frozen)
+						frozen_position = cube.position;
+					ImGui::SameLine();
+					if (ImGui::Button("Release"))
+						picked = -1;
+				}
+				else
+					ImGui::Text("Ctrl + click to pick a cube (%zu BVH nodes)", bvh.node_count());
+			}
+			ImGui::Checkbox("Front to back", &front_to_back);
+			ImGui::SameLine();
+			ImGui::Checkbox("Overdraw", &show_overdraw);
+			ImGui::Checkbox("Occlusion culling", &occlusion_culling);
+			if (occlusion_culling)
+			{
+				ImGui::SliderInt("Occluders", &occluder_count, 1, 128);
+				ImGui::Text("%zu of %zu cubes visible", drawn.size(), cubes.size());
+			}
+			ImGui::Checkbox("LOD", &lod);
+			if (lod)
+			{
+				ImGui::SliderFloat("3 faces below (px)", &faces_lod_size, 1, 200);
+				ImGui::SliderFloat("Impostor below (px)", &impostor_lod_size, 1, 50);
+				unsigned faces_count = 0;
+				for (unsigned i = cube_lod::faces; i < cube_lod::impostor; ++i)
+					faces_count += packet.lod_counts[i];
+				ImGui::Text("LOD: %u full, %u 3 faces, %u impostors", packet.lod_counts[cube_lod::full],
+					faces_count, packet.lod_counts[cube_lod::impostor]);
+			}
+			if (show_overdraw)
+				overdraw_info(overdraw);
+			if (instanced)
+				ImGui::Text("cubes: instanced, %s instance buffer, %u stalls",
+					fenced ? "fenced" : "orphaned", stream_stalls);
+			else
+				ImGui::Text("cubes: batched on CPU, %s vertex buffer", fenced ? "fenced" : "orphaned");
+			ImGui::Text("%zu draw items, state changes: %u programs, %u buffers, %u attributes",
+				draw_items, state_changes.programs, state_changes.buffers, state_changes.attributes);
+			ImGui::Text("%u draw calls, %u redundant changes skipped", state_changes.draws,
+				state_changes.skipped);
+			gpu_profiler_info(gpu_timings);
+
+			ImGui::End();  // end window
+
+			ImGui::Render();
+			packet.gui.copy(ImGui::GetDrawData());
+		}
+
+		renderer_thread.submit();
+
+		++frame;
+		if (trace_frames > 0 && frame == trace_frames)  // bench mode trace
+		{
+			glt::profile::stop_capture();
+			dump_trace();
 		}
-		
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-		glfwSwapBuffers(window);
-		
 		std::this_thread::sleep_for(10ms);
 	}
-	
-	glDeleteBuffers(1, &cube_position_vbo);
-	glDeleteBuffers(1, &cube_normal_vbo);
-	glDeleteBuffers(1, &axes_position_vbo);
+
+	renderer_thread.stop();
 	glfwTerminate();
 	
 	return 0;
@@ -444,7 +1334,9 @@ void mouse_button_handler(GLFWwindow * window, int button, int action, int mods)
 	if (ImGui::GetIO().WantCaptureMouse)
 		return;
 
-	if (button == GLFW_MOUSE_BUTTON_LEFT)
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS && (mods & GLFW_MOD_CONTROL))
+		g_pick = true;
+	else if (button == GLFW_MOUSE_BUTTON_LEFT)
 		g_rotate_camera = action == GLFW_PRESS;
 	else if (button == GLFW_MOUSE_BUTTON_RIGHT)
 		g_pan_camera = action == GLFW_PRESS;
@@ -461,21 +1353,18 @@ void key_handler(GLFWwindow * window, int key, int scancode, int action, int mod
 	{
 		if (key == GLFW_KEY_SPACE)
 			g_animation = !g_animation;
+		else if (key == GLFW_KEY_T)
+			g_toggle_trace = true;
 	}
 }
 
-cube_object new_cube()
+void dump_trace()
 {
-	static random_device rd;
-	static default_random_engine rand{rd()};
-
-	return cube_object{
-		vec3{
-			(rand() % 15) - 7.f,
-			7.f + (rand() % 30),
-			(rand() % 15) - 7.f},
-		0.7f + ((rand() % 70)/100.f)  // scale between 0.7 and 1.3
-	};
+	constexpr char trace_file[] = "cube_rain_trace.json";
+	if (glt::profile::dump_chrome_trace(trace_file))
+		cout << "trace written to '" << trace_file << "'" << endl;
+	else
+		cerr << "unable to write '" << trace_file << "' trace" << endl;
 }
 
 vec3 random_cube_position()
@@ -514,27 +1403,267 @@ GLuint push_data(void const * data, size_t size_in_bytes)
 	return vbo;
 }
 
-void calc_triangle_normals(float const * positions, size_t triangle_count, float * normals)
+void gpu_profiler_info(glt::gpu_profiler::timings const & prof)
+{
+	using glt::gpu_profiler;
+
+	if (!ImGui::CollapsingHeader("Passes", ImGuiTreeNodeFlags_DefaultOpen))
+		return;
+
+	if (!prof.available)
+		ImGui::TextDisabled("GPU timer queries not available, CPU times only");
+
+	float cpu_total = 0,
+		gpu_total = 0;
+
+	for (gpu_profiler::pass const & p : prof.passes)
+	{
+		float cpu_ms = prof.cpu_average(p),
+			gpu_ms = prof.gpu_average(p);
+
+		cpu_total += cpu_ms;
+		gpu_total += gpu_ms;
+
+		ImGui::Text("%s: cpu %.3f ms, gpu %.3f ms", p.name.c_str(), cpu_ms, gpu_ms);
+
+		char label[64];
+		snprintf(label, sizeof(label), "cpu##%s", p.name.c_str());
+		ImGui::PlotHistogram(label, p.cpu_ms, gpu_profiler::history_size,
+			prof.history_offset(), nullptr, 0, FLT_MAX, ImVec2{0, 30});
+
+		if (prof.available)
+		{
+			snprintf(label, sizeof(label), "gpu##%s", p.name.c_str());
+			ImGui::PlotHistogram(label, p.gpu_ms, gpu_profiler::history_size,
+				prof.history_offset(), nullptr, 0, FLT_MAX, ImVec2{0, 30});
+		}
+	}
+
+	if (prof.available)
+		ImGui::Text("total: cpu %.3f ms, gpu %.3f ms (%s bound)", cpu_total, gpu_total,
+			(gpu_total > cpu_total) ? "GPU" : "CPU");
+}
+
+void overdraw_info(overdraw_stats const & overdraw)
+{
+	if (!overdraw.valid)
+		return;
+
+	ImGui::Text("overdraw: %.2f fragments per covered pixel", overdraw.average);
+	ImGui::PlotHistogram("pixels##overdraw", overdraw.histogram, overdraw_stats::max_layers+1,
+		0, "0 .. 8+ fragments", 0, FLT_MAX, ImVec2{0, 50});
+}
+
+void force_fields_info(force_fields & forces)
 {
-	for (size_t i = 0; i < triangle_count; ++i)
+	if (!ImGui::CollapsingHeader("Force fields"))
+		return;
+
+	char const * names[] = {"wind", "attractor", "turbulence"};
+
+	vector<force_field> & fields = forces.fields();
+	for (unsigned i = 0; i < fields.size(); ++i)
 	{
-		size_t idx = 3*3*i;
-		vec3 v1{positions[idx], positions[idx+1], positions[idx+2]},
-			v2{positions[idx+3], positions[idx+4], positions[idx+5]},
-			v3{positions[idx+6], positions[idx+7], positions[idx+8]};
-			
-		vec3 n = Normalized(Cross(v3 - v1, v2 - v1));  // do oposite cross for left hand coordinate system
-	
-		GLfloat * p = &normals[idx];
-		for (size_t j = 0; j < 3; ++j)  // for all three vertices
+		force_field & f = fields[i];
+		ImGui::PushID(i);
+		ImGui::Checkbox(names[(int)f.type], &f.enabled);
+		ImGui::SameLine();
+		bool const removed = ImGui::SmallButton("remove");
+		switch (f.type)
 		{
-			*p++ = n.x;
-			*p++ = n.y;
-			*p++ = n.z;
+			case force_field::kind::wind:
+				ImGui::DragFloat3("direction", &f.vector.x, 0.05f);
+				ImGui::SliderFloat("strength", &f.strength, 0, 20);
+				break;
+
+			case force_field::kind::attractor:
+				ImGui::DragFloat3("position", &f.vector.x, 0.1f);
+				ImGui::SliderFloat("strength", &f.strength, -20, 20);
+				ImGui::SliderFloat("radius", &f.scale, 0.1f, 10);
+				break;
+
+			case force_field::kind::turbulence:
+				ImGui::SliderFloat("strength", &f.strength, 0, 20);
+				ImGui::SliderFloat("wavelength", &f.scale, 0.5f, 20);
+				ImGui::SliderFloat("speed", &f.speed, 0, 5);
+				break;
 		}
-		
-// 		cout << "n=" << n << "\n";
-	}	
+		ImGui::PopID();
+
+		if (removed)
+		{
+			forces.remove(i);
+			break;  // fields changed
+		}
+	}
+
+	if (fields.size() < force_fields::max_fields)
+	{
+		for (int kind = 0; kind < (int)size(names); ++kind)
+		{
+			if (kind > 0)
+				ImGui::SameLine();
+			char label[32];
+			snprintf(label, sizeof(label), "+ %s", names[kind]);
+			if (ImGui::Button(label))
+				forces.add(force_field{(force_field::kind)kind});
+		}
+	}
+}
+
+occlusion_culler::box cube_bounds(cube_object const & cube, float extent_scale)
+{
+	float const half_size = cube_rules::half_size*cube.scale*extent_scale;  // unit cube is from -1 to 1
+	vec3 const extent{half_size, half_size, half_size};
+	return occlusion_culler::box{cube.position - extent, cube.position + extent};
+}
+
+//! quantized view depth, clip space w is view space depth (row vector times VP 4th column)
+uint32_t depth_key(vec3 const & p, mat4 const & VP)
+{
+	constexpr float depth_scale = 65535.0f / Z_FAR;
+	float depth = p.x*VP._14 + p.y*VP._24 + p.z*VP._34 + VP._44;
+	depth = std::min(std::max(depth, 0.0f), Z_FAR);
+	return uint32_t(depth * depth_scale);
+}
+
+void sort_cubes_front_to_back(job_system & jobs, vector<cube_object> const & cubes,
+	vector<uint32_t> const & drawn, mat4 const & world_to_screen, vector<sort_item> & order,
+	vector<sort_item> & temp)
+{
+	GLT_PROFILE_ZONE("depth sort");
+
+	order.resize(drawn.size());
+	jobs.parallel_for(drawn.size(), 512, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+			order[i] = sort_item{depth_key(cubes[drawn[i]].position, world_to_screen), drawn[i]};
+	});
+
+	parallel_radix_sort(jobs, order, temp, 16);
+}
+
+unsigned cube_lod_of(cube_object const & cube, cube_rotation const * rotation, vec3 const & eye,
+	mat4 const & world_to_screen, float point_scale, float faces_size, float impostor_size)
+{
+	mat4 const & VP = world_to_screen;
+	vec3 const & p = cube.position;
+	float const depth = p.x*VP._14 + p.y*VP._24 + p.z*VP._34 + VP._44;
+	if (depth < Z_NEAR)
+		return cube_lod::full;
+
+	float const size = 2*cube_rules::half_size*cube.scale * point_scale / depth;  // projected size in pixels
+	if (size < impostor_size)
+		return cube_lod::impostor;
+
+	if (size < faces_size)  // only faces towards camera
+	{
+		vec3 d = eye - p;
+		if (rotation)  // to local space, inverse rotation is transposed rotation
+			d = vec3{Dot(d, rotation->x), Dot(d, rotation->y), Dot(d, rotation->z)};
+
+		unsigned const octant = (d.x > 0 ? 1 : 0) | (d.y > 0 ? 2 : 0) | (d.z > 0 ? 4 : 0);
+		return cube_lod::faces + octant;
+	}
+
+	return cube_lod::full;
+}
+
+void fill_cube_instances(job_system & jobs, vector<cube_object> const & cubes,
+	vector<cube_rotation> const & rotations, vector<uint32_t> const & order, vec3 const & eye,
+	float faces_size, float impostor_size, int highlight, vector<uint8_t> & lods, render_packet & packet)
+{
+	bool const rotated = !rotations.empty();
+
+	lods.resize(order.size());
+	jobs.parallel_for(order.size(), 512, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+		{
+			uint32_t const cube = order[i];
+			if ((int)cube == highlight)  // highlighted by instanced shader
+				lods[i] = cube_lod::full;
+			else
+				lods[i] = cube_lod_of(cubes[cube], rotated ? &rotations[cube] : nullptr, eye,
+					packet.world_to_screen, packet.point_scale, faces_size, impostor_size);
+		}
+	});
+
+	// counting sort by LOD (stable)
+	fill_n(packet.lod_counts, cube_lod::count, 0);
+	for (uint8_t l : lods)
+		++packet.lod_counts[l];
+
+	unsigned offsets[cube_lod::count];
+	for (unsigned l = 0, sum = 0; l < cube_lod::count; ++l)
+	{
+		offsets[l] = sum;
+		sum += packet.lod_counts[l];
+	}
+
+	packet.cubes.resize(order.size());
+	packet.rotations.resize(rotated ? order.size() : 0);
+	packet.highlight = -1;
+	for (size_t i = 0; i < order.size(); ++i)
+	{
+		cube_object const & cube = cubes[order[i]];
+		unsigned const slot = offsets[lods[i]]++;
+		packet.cubes[slot] = cube_instance{cube.position, cube_rules::half_size*cube.scale};
+		if ((int)order[i] == highlight)
+			packet.highlight = slot;
+		if (rotated)
+			packet.rotations[slot] = rotations[order[i]];
+	}
+}
+
+void cull_cubes(job_system & jobs, occlusion_culler & culler, vector<cube_object> const & cubes,
+	mat4 const & world_to_screen, float dt, float correction, bool rotated, unsigned occluder_count,
+	vector<sort_item> & nearest, vector<uint8_t> & visible)
+{
+	// rotated cube is inside its circumscribed sphere and contains its inscribed one
+	float const sqrt3 = 1.7320508f,
+		bounds_scale = rotated ? sqrt3 : 1,
+		occluder_scale = rotated ? 1/sqrt3 : 1;
+
+	GLT_PROFILE_ZONE("occlusion culling");
+
+	visible.resize(cubes.size());
+	if (cubes.empty())
+		return;
+
+	// nearest cubes as occluders
+	nearest.resize(cubes.size());
+	for (uint32_t i = 0; i < cubes.size(); ++i)
+		nearest[i] = sort_item{depth_key(cubes[i].position, world_to_screen), i};
+
+	occluder_count = std::min<size_t>(occluder_count, nearest.size());
+	nth_element(begin(nearest), begin(nearest) + (occluder_count - 1), end(nearest),
+		[](sort_item const & a, sort_item const & b){return a.key < b.key;});
+
+	culler.begin(world_to_screen);
+	{
+		GLT_PROFILE_ZONE("draw occluders");
+		for (unsigned i = 0; i < occluder_count; ++i)
+		{
+			cube_object const & cube = cubes[nearest[i].index];
+			occlusion_culler::box b = cube_bounds(cube, occluder_scale);
+			b.max.y -= cube_fall(cube, dt);  // only part occluding during whole fall
+			b.min = b.min + vec3{correction, correction, correction};  // and wherever it is pushed
+			b.max = b.max - vec3{correction, correction, correction};
+			if (b.max.x > b.min.x && b.max.y > b.min.y)
+				culler.draw_occluder(b);
+		}
+	}
+	culler.build_hiz();
+
+	jobs.parallel_for(cubes.size(), 256, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+		{
+			occlusion_culler::box b = cube_bounds(cubes[i], bounds_scale);
+			b.min.y -= cube_fall(cubes[i], dt);
+			b.min = b.min - vec3{correction, correction, correction};
+			b.max = b.max + vec3{correction, correction, correction};
+			visible[i] = culler.visible(b) ? 1 : 0;
+		}
+	});
 }
 
 void draw_triangles(GLuint position_vbo, GLint position_loc, size_t triangle_count)
@@ -0,0 +1,46 @@
+#include <random>
+#include "glt/cpu_profiler.hpp"
+#include "cube_simulation.hpp"
+
+using std::vector,
+	std::random_device,
+	std::default_random_engine;
+using phys::vec3;
+
+cube_object new_cube()
+{
+	static random_device rd;
+	static default_random_engine rand{rd()};
+
+	return cube_object{
+		vec3{
+			(rand() % 15) - 7.f,
+			7.f + (rand() % 30),
+			(rand() % 15) - 7.f},
+		0.7f + ((rand() % 70)/100.f)  // scale between 0.7 and 1.3
+	};
+}
+
+float cube_fall(cube_object const & cube, float dt)
+{
+	return cube_rules::fall_speed * (2.f - cube.scale) * dt;
+}
+
+void fall_cubes(vector<cube_object> & cubes, float dt, vector<uint8_t> & respawned)
+{
+	GLT_PROFILE_ZONE("cube simulation");
+
+	respawned.assign(cubes.size(), 0);
+	for (size_t i = 0; i < cubes.size(); ++i)
+	{
+		cube_object & cube = cubes[i];
+		cube.position.y -= cube_fall(cube, dt);
+
+		// reuse fallen cubes
+		if (cube.position.y < cube_rules::respawn_height)
+		{
+			cube = new_cube();
+			respawned[i] = 1;
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "phys/vectors.h"
+
+// flyweight
+struct cube_object
+{
+	phys::vec3 position;
+	float scale;  // value from 0.7 to 1.3 used to scale unit cube
+};
+
+/*! Falling cube rules shared by CPU simulation and gpu_cube_simulation
+(update shader needs to be kept in sync). */
+namespace cube_rules {
+
+constexpr float fall_speed = 3.f,  //!< for unit scale cube
+	respawn_height = -10.f,  //!< cubes bellow are respawned
+	half_size = 0.2f;  //!< unit scale cube half size
+
+}  // cube_rules
+
+cube_object new_cube();  //!< random cube above the scene
+float cube_fall(cube_object const & cube, float dt);  //!< \return how much cube falls in dt
+
+/*! One simulation step, fallen cubes are respawned.
+\param respawned set to 1 for respawned cubes, 0 otherwise */
+void fall_cubes(std::vector<cube_object> & cubes, float dt, std::vector<uint8_t> & respawned);
@@ -0,0 +1,191 @@
+#include <cmath>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#include "glt/cpu_profiler.hpp"
+#include "cube_tumbling.hpp"
+
+using std::vector,
+	std::random_device;
+using phys::vec3;
+
+constexpr size_t lanes = 4;  // cubes per SIMD batch
+
+cube_tumbling::cube_tumbling()
+	: _count{0}
+	, _rand{random_device{}()}
+	, _speed{-max_angular_speed, max_angular_speed}
+{}
+
+void cube_tumbling::resize(size_t cube_count)
+{
+	if (cube_count == _count)
+		return;
+
+	size_t const padded = (cube_count + lanes - 1) / lanes * lanes;
+	for (vector<float> * a : {&_qx, &_qy, &_qz, &_wx, &_wy, &_wz})
+		a->resize(padded, 0);
+	_qw.resize(padded, 1);
+
+	for (size_t i = _count; i < cube_count; ++i)
+		spin(i);
+
+	// cubes removed from the last batch become padding
+	for (size_t i = cube_count; i < padded; ++i)
+		stop(i);
+
+	_count = cube_count;
+}
+
+void cube_tumbling::respawn(vector<uint8_t> const & respawned)
+{
+	for (size_t i = 0; i < _count; ++i)
+		if (respawned[i])
+			spin(i);
+}
+
+void cube_tumbling::land(vector<uint8_t> const & supported)
+{
+	for (size_t i = 0; i < _count; ++i)
+		if (supported[i])
+			stop(i);
+}
+
+void cube_tumbling::integrate(job_system & jobs, float dt)
+{
+	GLT_PROFILE_ZONE("cube tumbling");
+
+	float const h = 0.5f * dt;
+
+	// q += 0.5*dt*(w, 0)*q, then q is normalized
+	jobs.parallel_for(_qx.size() / lanes, 256, [&](size_t first, size_t last){
+#ifdef __SSE2__
+		__m128 const hv = _mm_set1_ps(h),
+			half = _mm_set1_ps(0.5f),
+			three_halves = _mm_set1_ps(1.5f);
+
+		for (size_t i = first*lanes; i < last*lanes; i += lanes)
+		{
+			__m128 const x = _mm_loadu_ps(&_qx[i]), y = _mm_loadu_ps(&_qy[i]),
+				z = _mm_loadu_ps(&_qz[i]), w = _mm_loadu_ps(&_qw[i]),
+				wx = _mm_loadu_ps(&_wx[i]), wy = _mm_loadu_ps(&_wy[i]), wz = _mm_loadu_ps(&_wz[i]);
+
+			__m128 const dx = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(wx, w), _mm_mul_ps(wy, z)), _mm_mul_ps(wz, y)),
+				dy = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(wy, w), _mm_mul_ps(wx, z)), _mm_mul_ps(wz, x)),
+				dz = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(wx, y), _mm_mul_ps(wy, x)), _mm_mul_ps(wz, w)),
+				dw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wx, x), _mm_mul_ps(wy, y)), _mm_mul_ps(wz, z));
+
+			__m128 const nx = _mm_add_ps(x, _mm_mul_ps(hv, dx)),
+				ny = _mm_add_ps(y, _mm_mul_ps(hv, dy)),
+				nz = _mm_add_ps(z, _mm_mul_ps(hv, dz)),
+				nw = _mm_sub_ps(w, _mm_mul_ps(hv, dw));
+
+			// reciprocal square root estimate refined by one Newton-Raphson step
+			__m128 const len_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)),
+				_mm_add_ps(_mm_mul_ps(nz, nz), _mm_mul_ps(nw, nw)));
+			__m128 r = _mm_rsqrt_ps(len_sq);
+			r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, len_sq), _mm_mul_ps(r, r))));
+
+			_mm_storeu_ps(&_qx[i], _mm_mul_ps(nx, r));
+			_mm_storeu_ps(&_qy[i], _mm_mul_ps(ny, r));
+			_mm_storeu_ps(&_qz[i], _mm_mul_ps(nz, r));
+			_mm_storeu_ps(&_qw[i], _mm_mul_ps(nw, r));
+		}
+#else
+		for (size_t i = first*lanes; i < last*lanes; ++i)
+		{
+			float const x = _qx[i], y = _qy[i], z = _qz[i], w = _qw[i],
+				wx = _wx[i], wy = _wy[i], wz = _wz[i];
+
+			float const nx = x + h*(wx*w + wy*z - wz*y),
+				ny = y + h*(wy*w - wx*z + wz*x),
+				nz = z + h*(wx*y - wy*x + wz*w),
+				nw = w - h*(wx*x + wy*y + wz*z);
+
+			float const r = 1.0f / sqrtf(nx*nx + ny*ny + nz*nz + nw*nw);
+			_qx[i] = nx*r;
+			_qy[i] = ny*r;
+			_qz[i] = nz*r;
+			_qw[i] = nw*r;
+		}
+#endif
+	});
+}
+
+void cube_tumbling::rotations(job_system & jobs, vector<cube_rotation> & out) const
+{
+	GLT_PROFILE_ZONE("cube rotations");
+
+	out.resize(_count);
+
+	// same matrix as phys::ToMat3()
+	jobs.parallel_for(_qx.size() / lanes, 256, [&](size_t first, size_t last){
+		for (size_t i = first*lanes; i < last*lanes; i += lanes)
+		{
+			float m[9][lanes];  // matrix elements of the batch
+
+#ifdef __SSE2__
+			__m128 const x = _mm_loadu_ps(&_qx[i]), y = _mm_loadu_ps(&_qy[i]),
+				z = _mm_loadu_ps(&_qz[i]), w = _mm_loadu_ps(&_qw[i]);
+
+			__m128 const x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z),
+				xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2),
+				xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2),
+				wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2),
+				one = _mm_set1_ps(1.0f);
+
+			_mm_storeu_ps(m[0], _mm_sub_ps(one, _mm_add_ps(yy, zz)));
+			_mm_storeu_ps(m[1], _mm_add_ps(xy, wz));
+			_mm_storeu_ps(m[2], _mm_sub_ps(xz, wy));
+			_mm_storeu_ps(m[3], _mm_sub_ps(xy, wz));
+			_mm_storeu_ps(m[4], _mm_sub_ps(one, _mm_add_ps(xx, zz)));
+			_mm_storeu_ps(m[5], _mm_add_ps(yz, wx));
+			_mm_storeu_ps(m[6], _mm_add_ps(xz, wy));
+			_mm_storeu_ps(m[7], _mm_sub_ps(yz, wx));
+			_mm_storeu_ps(m[8], _mm_sub_ps(one, _mm_add_ps(xx, yy)));
+#else
+			for (size_t k = 0; k < lanes; ++k)
+			{
+				float const x = _qx[i+k], y = _qy[i+k], z = _qz[i+k], w = _qw[i+k];
+				m[0][k] = 1 - 2*(y*y + z*z);
+				m[1][k] = 2*(x*y + w*z);
+				m[2][k] = 2*(x*z - w*y);
+				m[3][k] = 2*(x*y - w*z);
+				m[4][k] = 1 - 2*(x*x + z*z);
+				m[5][k] = 2*(y*z + w*x);
+				m[6][k] = 2*(x*z + w*y);
+				m[7][k] = 2*(y*z - w*x);
+				m[8][k] = 1 - 2*(x*x + y*y);
+			}
+#endif
+
+			for (size_t k = 0; k < lanes && i + k < _count; ++k)
+			{
+				out[i+k] = cube_rotation{
+					vec3{m[0][k], m[1][k], m[2][k]},
+					vec3{m[3][k], m[4][k], m[5][k]},
+					vec3{m[6][k], m[7][k], m[8][k]}};
+			}
+		}
+	});
+}
+
+size_t cube_tumbling::size() const
+{
+	return _count;
+}
+
+void cube_tumbling::stop(size_t i)
+{
+	_qx[i] = _qy[i] = _qz[i] = 0;
+	_qw[i] = 1;
+	_wx[i] = _wy[i] = _wz[i] = 0;
+}
+
+void cube_tumbling::spin(size_t i)
+{
+	stop(i);
+	_wx[i] = _speed(_rand);
+	_wy[i] = _speed(_rand);
+	_wz[i] = _speed(_rand);
+}
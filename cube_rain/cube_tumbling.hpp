@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <random>
+#include <cstdint>
+#include "render_thread.hpp"
+#include "job_system.hpp"
+
+/*! Tumbling of falling cubes.
+
+Orientations (unit quaternions) and world space angular velocities are kept in
+SoA form (one array per component), so integration with normalization and
+conversion to rotation matrices is done for 4 cubes at a time (SSE2 when
+available). It is the batched version of phys::Integrate() and phys::ToMat3().
+
+\code
+cube_tumbling t;
+t.resize(cubes.size());
+t.respawn(respawned);
+t.integrate(jobs, dt);
+t.rotations(jobs, rotations);  // rotations[i] for cubes[i]
+\endcode
+\note Tumbling is visual only, cube_physics collides axis aligned boxes, so
+landed cubes are snapped back to axis aligned orientation (see land()). */
+class cube_tumbling
+{
+public:
+	static constexpr float max_angular_speed = 4.0f;  //!< rad/s per axis
+
+	cube_tumbling();
+
+	void resize(size_t cube_count);  //!< new cubes get random angular velocity
+	void respawn(std::vector<uint8_t> const & respawned);  //!< respawned cubes start axis aligned with new angular velocity
+	void land(std::vector<uint8_t> const & supported);  //!< stops supported cubes in axis aligned orientation
+	void integrate(job_system & jobs, float dt);
+
+	//! rotation matrices of all cubes
+	void rotations(job_system & jobs, std::vector<cube_rotation> & out) const;
+
+	size_t size() const;
+
+private:
+	void stop(size_t i);  //!< identity orientation and zero angular velocity
+	void spin(size_t i);  //!< identity orientation and random angular velocity
+
+	// per cube state, arrays are padded to multiple of 4 (padding cubes do not spin)
+	std::vector<float> _qx, _qy, _qz, _qw,  //!< orientation
+		_wx, _wy, _wz;  //!< angular velocity
+	size_t _count;
+	std::default_random_engine _rand;
+	std::uniform_real_distribution<float> _speed;
+};
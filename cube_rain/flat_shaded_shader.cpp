@@ -1,3 +1,4 @@
+#include "glt/debug.hpp"
 #include "flat_shaded_shader.hpp"
 
 namespace gles2 {
@@ -34,6 +35,7 @@ void main() {
 flat_shaded_shader::flat_shaded_shader()
 {
 	_prog.from_memory(shader_program_code, 100);
+	glt::debug::label(glt::debug::object::program, _prog.id(), "flat_shaded_shader");
 	_color_u = _prog.uniform_variable("color");
 	_light_dir_u = _prog.uniform_variable("light_direction");
 	_local_to_screen_u = _prog.uniform_variable("local_to_screen");
@@ -1,3 +1,4 @@
+#include "glt/debug.hpp"
 #include "flat_shader.hpp"
 
 namespace gles2 {
@@ -23,6 +24,7 @@ void main() {
 flat_shader::flat_shader()
 {
 	_prog.from_memory(program_shader_code, 100);
+	glt::debug::label(glt::debug::object::program, _prog.id(), "flat_shader");
 	_color_u = _prog.uniform_variable("color");
 	_local_to_screen_u = _prog.uniform_variable("local_to_screen");
 	_position = _prog.attribute_location("position");
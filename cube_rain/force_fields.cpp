@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#include "glt/cpu_profiler.hpp"
+#include "force_fields.hpp"
+
+using std::vector,
+	std::fill;
+using phys::vec3;
+
+static_assert(sizeof(cube_object) == 4*sizeof(float), "cube_object loaded as 4 floats");
+
+namespace {
+
+constexpr size_t lanes = 4,  // cubes per SIMD batch
+	block_size = 64;  // cubes transposed to SoA scratch at once (fits L1 cache)
+
+constexpr float pi = 3.1415927f,
+	two_pi = 2*pi,
+	half_pi = pi/2;
+
+//! attractor or turbulence field with constants precomputed for the step
+struct prepared_field
+{
+	force_field::kind type;
+	float x, y, z,  //!< attractor position
+		strength,  //!< attractor strength*scale^2 or turbulence strength
+		k,  //!< attractor scale^2 or turbulence wave number
+		phase;  //!< turbulence phase
+};
+
+//! enabled fields for the step, wind fields are constant so they are summed up
+struct prepared_fields
+{
+	vec3 wind;
+	prepared_field fields[force_fields::max_fields];
+	unsigned count;
+};
+
+prepared_fields prepare(vector<force_field> const & fields, float time)
+{
+	prepared_fields result;
+	result.wind = vec3{0, 0, 0};
+	result.count = 0;
+
+	for (force_field const & f : fields)
+	{
+		if (!f.enabled)
+			continue;
+
+		if (f.type == force_field::kind::wind)
+		{
+			float const len = Magnitude(f.vector);
+			if (len > 0)
+				result.wind = result.wind + f.vector * (f.strength/len);
+			continue;
+		}
+
+		prepared_field & p = result.fields[result.count++];
+		p.type = f.type;
+		p.x = f.vector.x;
+		p.y = f.vector.y;
+		p.z = f.vector.z;
+
+		if (f.type == force_field::kind::attractor)
+		{
+			p.k = f.scale * f.scale;
+			p.strength = f.strength * p.k;
+			p.phase = 0;
+		}
+		else  // turbulence
+		{
+			p.k = two_pi / f.scale;
+			p.strength = f.strength;
+			p.phase = fmodf(f.speed * time, two_pi);
+		}
+	}
+
+	return result;
+}
+
+/*! Parabolic sine wave, smooth (C1) periodic sine approximation (max error
+about 0.06) for the turbulence noise. */
+float wave(float x)
+{
+	x -= two_pi * nearbyintf(x * (1/two_pi));  // to -pi .. pi
+	return (4/pi)*x - (4/(pi*pi))*x*fabsf(x);
+}
+
+vec3 acceleration(prepared_fields const & fields, vec3 const & p)
+{
+	vec3 a = fields.wind;
+	for (unsigned i = 0; i < fields.count; ++i)
+	{
+		prepared_field const & f = fields.fields[i];
+		if (f.type == force_field::kind::attractor)
+		{
+			vec3 const d = vec3{f.x, f.y, f.z} - p;
+			float const r = 1.0f / sqrtf(Dot(d, d) + f.k);
+			a = a + d * (f.strength * r*r*r);
+		}
+		else  // turbulence, ABC flow with A = B = C = 1
+		{
+			float const x = f.k*p.x + f.phase,
+				y = f.k*p.y + f.phase,
+				z = f.k*p.z + f.phase;
+			a = a + vec3{
+				wave(z) + wave(y + half_pi),
+				wave(x) + wave(z + half_pi),
+				wave(y) + wave(x + half_pi)} * f.strength;
+		}
+	}
+	return a;
+}
+
+#ifdef __SSE2__
+//! block of cubes transposed to SoA
+struct soa_block
+{
+	alignas(16) float x[block_size], y[block_size], z[block_size], s[block_size],
+		ax[block_size], ay[block_size], az[block_size];
+};
+
+__m128 wave_ps(__m128 x)
+{
+	__m128 const abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 const turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1/two_pi))));  // round to nearest
+	x = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(two_pi)));
+	return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(4/pi), x),
+		_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(-4/(pi*pi)), x), _mm_and_ps(x, abs_mask)));
+}
+
+//! one field for all cubes in block, n is multiple of lanes
+void add_field(prepared_field const & f, soa_block & b, size_t n)
+{
+	if (f.type == force_field::kind::attractor)
+	{
+		__m128 const cx = _mm_set1_ps(f.x),
+			cy = _mm_set1_ps(f.y),
+			cz = _mm_set1_ps(f.z),
+			core = _mm_set1_ps(f.k),
+			strength = _mm_set1_ps(f.strength);
+
+		for (size_t i = 0; i < n; i += lanes)
+		{
+			__m128 const dx = _mm_sub_ps(cx, _mm_load_ps(b.x + i)),
+				dy = _mm_sub_ps(cy, _mm_load_ps(b.y + i)),
+				dz = _mm_sub_ps(cz, _mm_load_ps(b.z + i));
+			__m128 const len_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+				_mm_add_ps(_mm_mul_ps(dz, dz), core));
+			__m128 const r = _mm_rsqrt_ps(len_sq),  // estimate is good enough for a force
+				s = _mm_mul_ps(strength, _mm_mul_ps(r, _mm_mul_ps(r, r)));
+			_mm_store_ps(b.ax + i, _mm_add_ps(_mm_load_ps(b.ax + i), _mm_mul_ps(dx, s)));
+			_mm_store_ps(b.ay + i, _mm_add_ps(_mm_load_ps(b.ay + i), _mm_mul_ps(dy, s)));
+			_mm_store_ps(b.az + i, _mm_add_ps(_mm_load_ps(b.az + i), _mm_mul_ps(dz, s)));
+		}
+	}
+	else  // turbulence
+	{
+		__m128 const k = _mm_set1_ps(f.k),
+			phase = _mm_set1_ps(f.phase),
+			quarter = _mm_set1_ps(half_pi),
+			strength = _mm_set1_ps(f.strength);
+
+		for (size_t i = 0; i < n; i += lanes)
+		{
+			__m128 const px = _mm_add_ps(_mm_mul_ps(k, _mm_load_ps(b.x + i)), phase),
+				py = _mm_add_ps(_mm_mul_ps(k, _mm_load_ps(b.y + i)), phase),
+				pz = _mm_add_ps(_mm_mul_ps(k, _mm_load_ps(b.z + i)), phase);
+			_mm_store_ps(b.ax + i, _mm_add_ps(_mm_load_ps(b.ax + i), _mm_mul_ps(strength,
+				_mm_add_ps(wave_ps(pz), wave_ps(_mm_add_ps(py, quarter))))));
+			_mm_store_ps(b.ay + i, _mm_add_ps(_mm_load_ps(b.ay + i), _mm_mul_ps(strength,
+				_mm_add_ps(wave_ps(px), wave_ps(_mm_add_ps(pz, quarter))))));
+			_mm_store_ps(b.az + i, _mm_add_ps(_mm_load_ps(b.az + i), _mm_mul_ps(strength,
+				_mm_add_ps(wave_ps(py), wave_ps(_mm_add_ps(px, quarter))))));
+		}
+	}
+}
+#endif
+
+}  // namespace
+
+force_fields::force_fields()
+	: _time{0}
+{}
+
+bool force_fields::add(force_field const & f)
+{
+	if (_fields.size() == max_fields)
+		return false;
+
+	_fields.push_back(f);
+	return true;
+}
+
+void force_fields::remove(unsigned i)
+{
+	_fields.erase(begin(_fields) + i);
+}
+
+vector<force_field> & force_fields::fields()
+{
+	return _fields;
+}
+
+bool force_fields::active() const
+{
+	for (force_field const & f : _fields)
+		if (f.enabled)
+			return true;
+	return false;
+}
+
+void force_fields::apply(job_system & jobs, vector<cube_object> & cubes, float dt,
+	vector<uint8_t> const * pinned)
+{
+	GLT_PROFILE_ZONE("force fields");
+
+	resize(cubes.size());
+	_time += dt;
+
+	prepared_fields const fields = prepare(_fields, _time);
+
+	// v += (a - drag*v)*dt, p += v*dt
+	float const damping = std::max(1.0f - drag*dt, 0.0f);
+	size_t const pinned_count = pinned ? pinned->size() : 0;
+	auto is_pinned = [&](size_t i){return i < pinned_count && (*pinned)[i];};
+
+	auto drift = [&](size_t i){  // one cube
+		vec3 const a = acceleration(fields, cubes[i].position);
+		float const free = is_pinned(i) ? 0 : 1;
+		_vx[i] = free * (damping*_vx[i] + a.x*dt);
+		_vy[i] = free * (damping*_vy[i] + a.y*dt);
+		_vz[i] = free * (damping*_vz[i] + a.z*dt);
+		cubes[i].position = cubes[i].position + vec3{_vx[i], _vy[i], _vz[i]} * dt;
+	};
+
+	size_t const block_count = (cubes.size() / lanes * lanes + block_size - 1) / block_size;
+	jobs.parallel_for(block_count, 4, [&](size_t first, size_t last){
+#ifdef __SSE2__
+		soa_block b;
+		__m128 const d = _mm_set1_ps(damping),
+			t = _mm_set1_ps(dt);
+#endif
+
+		for (size_t blk = first; blk < last; ++blk)
+		{
+			size_t const first_cube = blk * block_size,
+				n = std::min(block_size, cubes.size() / lanes * lanes - first_cube);  // whole batches only
+#ifdef __SSE2__
+			// AoS (x, y, z, scale) to SoA, field evaluation runs over the block per field
+			for (size_t i = 0; i < n; i += lanes)
+			{
+				cube_object * c = &cubes[first_cube + i];
+				__m128 x = _mm_loadu_ps(&c[0].position.x),
+					y = _mm_loadu_ps(&c[1].position.x),
+					z = _mm_loadu_ps(&c[2].position.x),
+					s = _mm_loadu_ps(&c[3].position.x);
+				_MM_TRANSPOSE4_PS(x, y, z, s);
+				_mm_store_ps(b.x + i, x);
+				_mm_store_ps(b.y + i, y);
+				_mm_store_ps(b.z + i, z);
+				_mm_store_ps(b.s + i, s);
+				_mm_store_ps(b.ax + i, _mm_set1_ps(fields.wind.x));
+				_mm_store_ps(b.ay + i, _mm_set1_ps(fields.wind.y));
+				_mm_store_ps(b.az + i, _mm_set1_ps(fields.wind.z));
+			}
+
+			for (unsigned f = 0; f < fields.count; ++f)
+				add_field(fields.fields[f], b, n);
+
+			for (size_t i = 0; i < n; i += lanes)
+			{
+				size_t const j = first_cube + i;
+				__m128 const free = _mm_setr_ps(is_pinned(j) ? 0 : 1, is_pinned(j+1) ? 0 : 1,
+					is_pinned(j+2) ? 0 : 1, is_pinned(j+3) ? 0 : 1);
+				__m128 const vx = _mm_mul_ps(free, _mm_add_ps(_mm_mul_ps(d, _mm_loadu_ps(&_vx[j])), _mm_mul_ps(_mm_load_ps(b.ax + i), t))),
+					vy = _mm_mul_ps(free, _mm_add_ps(_mm_mul_ps(d, _mm_loadu_ps(&_vy[j])), _mm_mul_ps(_mm_load_ps(b.ay + i), t))),
+					vz = _mm_mul_ps(free, _mm_add_ps(_mm_mul_ps(d, _mm_loadu_ps(&_vz[j])), _mm_mul_ps(_mm_load_ps(b.az + i), t)));
+				_mm_storeu_ps(&_vx[j], vx);
+				_mm_storeu_ps(&_vy[j], vy);
+				_mm_storeu_ps(&_vz[j], vz);
+
+				__m128 x = _mm_add_ps(_mm_load_ps(b.x + i), _mm_mul_ps(vx, t)),
+					y = _mm_add_ps(_mm_load_ps(b.y + i), _mm_mul_ps(vy, t)),
+					z = _mm_add_ps(_mm_load_ps(b.z + i), _mm_mul_ps(vz, t)),
+					s = _mm_load_ps(b.s + i);
+				_MM_TRANSPOSE4_PS(x, y, z, s);
+				cube_object * c = &cubes[j];
+				_mm_storeu_ps(&c[0].position.x, x);
+				_mm_storeu_ps(&c[1].position.x, y);
+				_mm_storeu_ps(&c[2].position.x, z);
+				_mm_storeu_ps(&c[3].position.x, s);
+			}
+#else
+			for (size_t i = first_cube; i < first_cube + n; ++i)
+				drift(i);
+#endif
+		}
+	});
+
+	// cubes after the last whole batch
+	for (size_t i = cubes.size() / lanes * lanes; i < cubes.size(); ++i)
+		drift(i);
+}
+
+void force_fields::respawn(vector<uint8_t> const & respawned)
+{
+	for (size_t i = 0; i < respawned.size() && i < _vx.size(); ++i)
+		if (respawned[i])
+			_vx[i] = _vy[i] = _vz[i] = 0;
+}
+
+void force_fields::resize(size_t cube_count)
+{
+	size_t const padded = (cube_count + lanes - 1) / lanes * lanes;
+	_vx.resize(padded, 0);
+	_vy.resize(padded, 0);
+	_vz.resize(padded, 0);
+
+	// removed cubes do not pass their drift to cubes added later
+	for (vector<float> * v : {&_vx, &_vy, &_vz})
+		fill(begin(*v) + cube_count, end(*v), 0);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "phys/vectors.h"
+#include "job_system.hpp"
+#include "cube_simulation.hpp"
+
+//! Force field acting on falling cubes, see force_fields.
+struct force_field
+{
+	enum class kind
+	{
+		wind,  //!< uniform acceleration along vector
+		attractor,  //!< towards vector (away for negative strength), falls off with squared distance
+		turbulence  //!< divergence free ABC flow (curl of itself), drifts with time
+	};
+
+	kind type = kind::wind;
+	bool enabled = true;
+	phys::vec3 vector = phys::vec3{1, 0, 0};  //!< wind direction or attractor position
+	float strength = 1,  //!< acceleration in m/s^2
+		scale = 2,  //!< attractor core radius or turbulence wavelength in m
+		speed = 1;  //!< turbulence phase drift in rad/s
+};
+
+/*! Force fields accelerating falling cubes.
+
+Fields change cube drift velocity (on top of cube_rules fall), the velocity is
+damped by drag so it stays bounded (terminal speed is acceleration/drag).
+Drift velocities are kept in SoA form and cube positions are transposed on
+load, so all fields are evaluated for 4 cubes at a time (SSE2 when available)
+in a single pass over cubes. Wind and attractor fields cost a few arithmetic
+instructions per cube and stay close to the memory bound pass. Turbulence
+(polynomial sine approximation, no libm calls) is ALU bound, each field adds
+about 0.4 ms per 100k cubes on one core, so it scales with job_system workers.
+
+\code
+force_fields f;
+f.add(force_field{force_field::kind::wind, true, vec3{1,0,0}, 2});
+// each step before simulation
+f.apply(jobs, cubes, dt, nullptr);
+fall_cubes(cubes, dt, respawned);
+f.respawn(respawned);
+\endcode */
+class force_fields
+{
+public:
+	static constexpr unsigned max_fields = 8;
+	static constexpr float drag = 1.0f;  //!< 1/s
+
+	force_fields();
+
+	bool add(force_field const & f);  //!< \return false if there are max_fields already
+	void remove(unsigned i);
+	std::vector<force_field> & fields();  //!< fields can be edited in place
+	bool active() const;  //!< at least one enabled field
+
+	/*! Accelerates cubes by enabled fields and moves them by their drift
+	velocity for dt, cubes can be added or removed between calls (new cubes
+	start with zero drift).
+	\param pinned nonzero for cubes which can not be moved (e.g. resting on
+	the ground), can be nullptr or shorter than cubes (the rest is not pinned) */
+	void apply(job_system & jobs, std::vector<cube_object> & cubes, float dt,
+		std::vector<uint8_t> const * pinned);
+
+	void respawn(std::vector<uint8_t> const & respawned);  //!< zero drift for respawned cubes
+
+private:
+	void resize(size_t cube_count);
+
+	std::vector<force_field> _fields;
+	float _time;  //!< turbulence phase time
+
+	// per cube state, padded to multiple of 4
+	std::vector<float> _vx, _vy, _vz;  //!< drift velocity
+};
@@ -0,0 +1,178 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "cpu_profiler.hpp"
+
+namespace glt::profile {
+
+using std::string,
+	std::vector,
+	std::unique_ptr,
+	std::atomic,
+	std::mutex,
+	std::lock_guard,
+	std::ofstream;
+using std::chrono::steady_clock,
+	std::chrono::duration_cast,
+	std::chrono::nanoseconds;
+
+namespace {
+
+struct event
+{
+	char const * name;
+	uint64_t begin,
+		end;
+};
+
+/*! Per thread event buffer, written by owner thread only. Buffer is reset
+(by writer) when it founds out new capture was started. */
+struct thread_buffer
+{
+	static constexpr size_t capacity = 1 << 16;
+
+	unsigned tid;
+	string name;
+	atomic<unsigned> epoch{0};  //!< capture the events belongs to
+	atomic<size_t> count{0};
+	unique_ptr<event[]> events{new event[capacity]};
+
+	void append(event const & e, unsigned current_epoch);
+};
+
+steady_clock::time_point const _start = steady_clock::now();
+atomic<bool> _capturing{false};
+atomic<unsigned> _epoch{0};
+
+mutex _buffers_locker;  // guards _buffers (locked only on thread registration and dump)
+vector<unique_ptr<thread_buffer>> _buffers;
+
+void thread_buffer::append(event const & e, unsigned current_epoch)
+{
+	size_t n = count.load(std::memory_order_relaxed);
+	if (epoch.load(std::memory_order_relaxed) != current_epoch)
+	{
+		epoch.store(current_epoch, std::memory_order_relaxed);
+		n = 0;
+	}
+
+	if (n == capacity)
+		return;  // buffer full, zone lost
+
+	events[n] = e;
+	count.store(n + 1, std::memory_order_release);
+}
+
+thread_buffer & local_buffer()
+{
+	thread_local thread_buffer * buf = nullptr;
+	if (!buf)
+	{
+		lock_guard<mutex> lock{_buffers_locker};
+		_buffers.emplace_back(new thread_buffer);
+		buf = _buffers.back().get();
+		buf->tid = _buffers.size();
+	}
+	return *buf;
+}
+
+void write_escaped(ofstream & out, string const & s)
+{
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+			out << '\\';
+		out << c;
+	}
+}
+
+}  // namespace
+
+uint64_t now()
+{
+	return duration_cast<nanoseconds>(steady_clock::now() - _start).count();
+}
+
+void start_capture()
+{
+	_epoch.fetch_add(1, std::memory_order_relaxed);
+	_capturing.store(true, std::memory_order_release);
+}
+
+void stop_capture()
+{
+	_capturing.store(false, std::memory_order_release);
+}
+
+bool capturing()
+{
+	return _capturing.load(std::memory_order_relaxed);
+}
+
+bool dump_chrome_trace(string const & fname)
+{
+	ofstream out{fname};
+	if (!out.is_open())
+		return false;
+
+	unsigned const epoch = _epoch.load(std::memory_order_relaxed);
+
+	out << "{\"traceEvents\":[\n";
+	bool first = true;
+
+	lock_guard<mutex> lock{_buffers_locker};
+	for (auto const & buf : _buffers)
+	{
+		if (!buf->name.empty())
+		{
+			out << (first ? "" : ",\n")
+				<< R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buf->tid
+				<< R"(,"args":{"name":")";
+			write_escaped(out, buf->name);
+			out << "\"}}";
+			first = false;
+		}
+
+		size_t n = buf->count.load(std::memory_order_acquire);
+		if (buf->epoch.load(std::memory_order_relaxed) != epoch)
+			continue;  // nothing recorded during last capture
+
+		out.precision(3);
+		out << std::fixed;
+		for (size_t i = 0; i < n; ++i)
+		{
+			event const & e = buf->events[i];
+			out << (first ? "" : ",\n")
+				<< R"({"name":")" << e.name << R"(","ph":"X","pid":1,"tid":)" << buf->tid
+				<< R"(,"ts":)" << e.begin / 1000.0 << R"(,"dur":)" << (e.end - e.begin) / 1000.0
+				<< "}";
+			first = false;
+		}
+	}
+
+	out << "\n]}\n";
+	return out.good();
+}
+
+void thread_name(char const * name)
+{
+	thread_buffer & buf = local_buffer();
+	lock_guard<mutex> lock{_buffers_locker};
+	buf.name = name;
+}
+
+zone::zone(char const * name)
+	: _name{_capturing.load(std::memory_order_relaxed) ? name : nullptr}
+	, _begin{_name ? now() : 0}
+{}
+
+zone::~zone()
+{
+	if (_name)
+		local_buffer().append(event{_name, _begin, now()}, _epoch.load(std::memory_order_relaxed));
+}
+
+}  // glt::profile
@@ -0,0 +1,64 @@
+/*! Scoped zone CPU profiler with Chrome trace_event export.
+
+Zones are recorded only while capture is running into per-thread buffers
+(appending is lock-free, each thread writes only to its own buffer) and dumped
+as Chrome trace_event JSON (open in chrome://tracing or ui.perfetto.dev).
+Zones are compiled out unless GLT_PROFILE is defined.
+
+\code
+void update() {
+	GLT_PROFILE_ZONE("update");
+	// ...
+}
+
+glt::profile::start_capture();
+// ... some frames
+glt::profile::stop_capture();
+glt::profile::dump_chrome_trace("trace.json");
+\endcode */
+#pragma once
+#include <string>
+#include <cstdint>
+
+namespace glt::profile {
+
+//! \return nanoseconds since profiler start (steady clock)
+uint64_t now();
+
+void start_capture();
+void stop_capture();
+bool capturing();
+
+/*! Writes zones recorded by the last capture as Chrome trace_event JSON.
+\note Call after stop_capture(). */
+bool dump_chrome_trace(std::string const & fname);
+
+//! names calling thread in trace output
+void thread_name(char const * name);
+
+//! RAII zone, name needs to be a string literal (only pointer is stored)
+class zone
+{
+public:
+	explicit zone(char const * name);
+	~zone();
+
+	zone(zone const &) = delete;
+	void operator=(zone const &) = delete;
+
+private:
+	char const * _name;  //!< nullptr if not capturing
+	uint64_t _begin;
+};
+
+}  // glt::profile
+
+#define GLT_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GLT_PROFILE_CONCAT(a, b) GLT_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef GLT_PROFILE
+	#define GLT_PROFILE_ZONE(name) \
+		glt::profile::zone GLT_PROFILE_CONCAT(_glt_profile_zone_, __LINE__){name}
+#else
+	#define GLT_PROFILE_ZONE(name) ((void)0)
+#endif
@@ -0,0 +1,291 @@
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include "features.hpp"
+#include "debug.hpp"
+
+namespace glt::debug {
+
+using std::string,
+	std::function,
+	std::atomic,
+	std::min;
+
+namespace detail {
+
+/*! Bounded lock-free multiple producer single consumer ring buffer
+(Dmitry Vyukov's bounded queue), N needs to be power of two. */
+template <typename T, size_t N>
+class mpsc_ring
+{
+public:
+	static_assert((N & (N - 1)) == 0, "ring size needs to be power of two");
+
+	mpsc_ring();
+
+	//! \return false if ring is full
+	template <typename Fill>
+	bool push(Fill fill);
+
+	bool pop(T & out);  //!< consumer side
+
+private:
+	struct cell
+	{
+		atomic<size_t> sequence;
+		T data;
+	};
+
+	cell _cells[N];
+	alignas(64) atomic<size_t> _head;  //!< producers position
+	alignas(64) atomic<size_t> _tail;  //!< consumer position
+};
+
+template <typename T, size_t N>
+mpsc_ring<T, N>::mpsc_ring()
+	: _head{0}
+	, _tail{0}
+{
+	for (size_t i = 0; i < N; ++i)
+		_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T, size_t N>
+template <typename Fill>
+bool mpsc_ring<T, N>::push(Fill fill)
+{
+	size_t pos = _head.load(std::memory_order_relaxed);
+	cell * c = nullptr;
+	while (true)
+	{
+		c = &_cells[pos & (N - 1)];
+		size_t seq = c->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false;  // full
+		else
+			pos = _head.load(std::memory_order_relaxed);
+	}
+
+	fill(c->data);
+	c->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+bool mpsc_ring<T, N>::pop(T & out)
+{
+	size_t pos = _tail.load(std::memory_order_relaxed);
+	cell & c = _cells[pos & (N - 1)];
+	size_t seq = c.sequence.load(std::memory_order_acquire);
+	if ((intptr_t)seq - (intptr_t)(pos + 1) < 0)
+		return false;  // empty
+
+	out = c.data;
+	c.sequence.store(pos + N, std::memory_order_release);
+	_tail.store(pos + 1, std::memory_order_relaxed);
+	return true;
+}
+
+}  // detail
+
+static detail::mpsc_ring<message, 256> _messages;
+static atomic<size_t> _dropped{0};
+static atomic<int> _min_level{(int)severity::low};
+static bool _installed = false;
+
+static PFNGLDEBUGMESSAGECALLBACKPROC _debug_message_callback = nullptr;
+static PFNGLDEBUGMESSAGECONTROLPROC _debug_message_control = nullptr;
+static PFNGLOBJECTLABELPROC _object_label = nullptr;
+
+template <typename Proc>
+static Proc load_khr(char const * name)
+{
+	// desktop KHR_debug entry points are without suffix, ES ones with KHR suffix
+	if (void * p = proc_address(name))
+		return (Proc)p;
+	return (Proc)proc_address((string{name} + "KHR").c_str());
+}
+
+static severity severity_cast(GLenum level)
+{
+	switch (level)
+	{
+		case GL_DEBUG_SEVERITY_HIGH: return severity::high;
+		case GL_DEBUG_SEVERITY_MEDIUM: return severity::medium;
+		case GL_DEBUG_SEVERITY_LOW: return severity::low;
+		default: return severity::notification;
+	}
+}
+
+static GLenum opengl_cast(severity level)
+{
+	switch (level)
+	{
+		case severity::high: return GL_DEBUG_SEVERITY_HIGH;
+		case severity::medium: return GL_DEBUG_SEVERITY_MEDIUM;
+		case severity::low: return GL_DEBUG_SEVERITY_LOW;
+		default: return GL_DEBUG_SEVERITY_NOTIFICATION;
+	}
+}
+
+static GLenum opengl_cast(object type)
+{
+	switch (type)
+	{
+		case object::buffer: return GL_BUFFER;
+		case object::shader: return GL_SHADER;
+		case object::program: return GL_PROGRAM;
+		case object::texture: return GL_TEXTURE;
+		case object::query: return GL_QUERY;
+		case object::framebuffer: return GL_FRAMEBUFFER;
+		default: return GL_NONE;
+	}
+}
+
+static void GLAPIENTRY debug_callback(GLenum source, GLenum type, GLuint id,
+	GLenum level, GLsizei length, GLchar const * text, void const * user)
+{
+	severity s = severity_cast(level);
+	if ((int)s < _min_level.load(std::memory_order_relaxed))
+		return;
+
+	bool pushed = _messages.push([&](message & m){
+		m.source = source;
+		m.type = type;
+		m.id = id;
+		m.level = s;
+		size_t n = min((length < 0) ? strlen(text) : (size_t)length,
+			message::max_length - 1);
+		memcpy(m.text, text, n);
+		m.text[n] = '\0';
+	});
+
+	if (!pushed)
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+// enables driver side filtering so filtered messages are not even generated
+static void control_severity(severity min_level)
+{
+	if (!_debug_message_control)
+		return;
+
+	for (severity s : {severity::notification, severity::low, severity::medium, severity::high})
+	{
+		_debug_message_control(GL_DONT_CARE, GL_DONT_CARE, opengl_cast(s), 0,
+			nullptr, (s >= min_level) ? GL_TRUE : GL_FALSE);
+	}
+}
+
+bool install(severity min_level)
+{
+	if (_installed)
+		return true;
+
+	if (!features().debug_output)
+		return false;
+
+	_debug_message_callback = load_khr<PFNGLDEBUGMESSAGECALLBACKPROC>("glDebugMessageCallback");
+	_debug_message_control = load_khr<PFNGLDEBUGMESSAGECONTROLPROC>("glDebugMessageControl");
+	_object_label = load_khr<PFNGLOBJECTLABELPROC>("glObjectLabel");
+	if (!_debug_message_callback)
+		return false;
+
+	_debug_message_callback((GLDEBUGPROC)debug_callback, nullptr);
+	glEnable(GL_DEBUG_OUTPUT);  // GL_DEBUG_OUTPUT_SYNCHRONOUS not enabled on purpose, it stalls pipeline
+	_installed = true;
+
+	min_severity(min_level);
+
+	return true;
+}
+
+void uninstall()
+{
+	if (!_installed)
+		return;
+
+	glDisable(GL_DEBUG_OUTPUT);
+	_debug_message_callback(nullptr, nullptr);
+	_installed = false;
+}
+
+bool installed()
+{
+	return _installed;
+}
+
+void min_severity(severity level)
+{
+	_min_level.store((int)level, std::memory_order_relaxed);
+	if (_installed)
+		control_severity(level);
+}
+
+severity min_severity()
+{
+	return (severity)_min_level.load(std::memory_order_relaxed);
+}
+
+size_t pump(function<void (message const &)> const & f)
+{
+	size_t count = 0;
+	message m;
+	while (_messages.pop(m))
+	{
+		f(m);
+		++count;
+	}
+	return count;
+}
+
+size_t dropped()
+{
+	return _dropped.load(std::memory_order_relaxed);
+}
+
+void label(object type, GLuint name, string const & text)
+{
+	if (_installed && _object_label)
+		_object_label(opengl_cast(type), name, -1, text.c_str());
+}
+
+char const * to_string(severity level)
+{
+	switch (level)
+	{
+		case severity::high: return "high";
+		case severity::medium: return "medium";
+		case severity::low: return "low";
+		default: return "notification";
+	}
+}
+
+static char const * type_to_string(GLenum type)
+{
+	switch (type)
+	{
+		case GL_DEBUG_TYPE_ERROR: return "error";
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+		case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+		case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+		default: return "other";
+	}
+}
+
+std::ostream & operator<<(std::ostream & out, message const & m)
+{
+	out << "gl " << type_to_string(m.type) << " (" << to_string(m.level)
+		<< ", id=" << m.id << "): " << m.text;
+	return out;
+}
+
+}  // glt::debug
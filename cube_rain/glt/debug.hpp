@@ -0,0 +1,91 @@
+/*! OpenGL debug output (KHR_debug) support.
+
+Instead of querying glGetError() after each call (which can force a pipeline
+synchronization on many drivers) debug output callback is installed. Driver
+messages are stored in a lock-free ring buffer (callback can be called from
+driver threads) and processed by pump() once per frame.
+
+\code
+glt::init_features();
+glt::debug::install(glt::debug::severity::low);
+glt::debug::label(glt::debug::object::buffer, vbo, "cube positions");
+// ... each frame
+glt::debug::pump([](glt::debug::message const & m){cerr << m << "\n";});
+\endcode */
+#pragma once
+#include <ostream>
+#include <string>
+#include <functional>
+#include <cstddef>
+#include <cassert>
+#include "opengl.hpp"
+
+namespace glt::debug {
+
+enum class severity
+{
+	notification,
+	low,
+	medium,
+	high
+};
+
+//! object types for label()
+enum class object
+{
+	buffer,
+	shader,
+	program,
+	texture,
+	query,
+	framebuffer
+};
+
+struct message
+{
+	static constexpr size_t max_length = 256;
+
+	GLenum source,
+		type;
+	GLuint id;
+	severity level;
+	char text[max_length];  //!< null terminated, truncated to max_length-1 characters
+};
+
+/*! Installs debug message callback if context supports KHR_debug.
+\return false if debug output is not available (in that case glGetError()
+based checks are used). */
+bool install(severity min_level = severity::low);
+void uninstall();
+bool installed();
+
+//! messages bellow level are ignored (filtered in callback)
+void min_severity(severity level);
+severity min_severity();
+
+/*! Calls f for each message received since the last pump() call, needs to be
+called from one thread only.
+\return number of processed messages */
+size_t pump(std::function<void (message const &)> const & f);
+
+//! number of messages lost because ring buffer was full
+size_t dropped();
+
+/*! Names object so driver messages (and tools like apitrace or RenderDoc)
+use the label, ignored without debug output. */
+void label(object type, GLuint name, std::string const & text);
+
+char const * to_string(severity level);
+std::ostream & operator<<(std::ostream & out, message const & m);
+
+}  // glt::debug
+
+/*! Debug builds opengl error check. It is a no-op when debug output is
+installed (errors are delivered by the callback), synchronous glGetError()
+check otherwise. */
+#ifdef NDEBUG
+	#define GLT_ASSERT_NO_GL_ERROR() ((void)0)
+#else
+	#define GLT_ASSERT_NO_GL_ERROR() \
+		assert((glt::debug::installed() || glGetError() == GL_NO_ERROR) && "opengl error")
+#endif
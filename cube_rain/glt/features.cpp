@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include "opengl.hpp"
+#include "features.hpp"
+
+namespace glt {
+
+using std::string,
+	std::vector,
+	std::istringstream;
+
+static context_features _features;
+static vector<string> _extensions;  // sorted
+
+static void parse_version(char const * version)
+{
+	constexpr char es_prefix[] = "OpenGL ES";
+	if (strncmp(version, es_prefix, sizeof(es_prefix) - 1) == 0)
+	{
+		_features.gles = true;
+		version = strchr(version + sizeof(es_prefix) - 1, ' ');  // skip also '-CM' like suffixes
+		if (!version)
+			return;
+	}
+
+	if (sscanf(version, "%d.%d", &_features.major, &_features.minor) != 2)
+		_features.major = _features.minor = 0;
+}
+
+static void query_extensions()
+{
+	_extensions.clear();
+
+	auto get_stringi = (PFNGLGETSTRINGIPROC)proc_address("glGetStringi");
+	if (get_stringi && _features.major >= 3)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; ++i)
+			_extensions.emplace_back((char const *)get_stringi(GL_EXTENSIONS, i));
+	}
+	else if (char const * exts = (char const *)glGetString(GL_EXTENSIONS))
+	{
+		istringstream in{exts};
+		for (string ext; in >> ext;)
+			_extensions.push_back(ext);
+	}
+
+	sort(begin(_extensions), end(_extensions));
+}
+
+void init_features()
+{
+	_features = context_features{};
+
+	if (char const * version = (char const *)glGetString(GL_VERSION))
+		parse_version(version);
+
+	query_extensions();
+
+	_features.debug_output = has_extension("GL_KHR_debug")
+		|| (!_features.gles && version_at_least(4, 3));
+
+	_features.timer_query = _features.gles
+		? has_extension("GL_EXT_disjoint_timer_query")
+		: (version_at_least(3, 3) || has_extension("GL_ARB_timer_query"));
+
+	_features.fence_sync = _features.gles
+		? version_at_least(3, 0)
+		: (version_at_least(3, 2) || has_extension("GL_ARB_sync"));
+
+	_features.map_buffer_range = _features.gles
+		? (version_at_least(3, 0) || has_extension("GL_EXT_map_buffer_range"))
+		: (version_at_least(3, 0) || has_extension("GL_ARB_map_buffer_range"));
+
+	_features.instanced_arrays = _features.gles
+		? (version_at_least(3, 0) || has_extension("GL_EXT_instanced_arrays")
+			|| has_extension("GL_ANGLE_instanced_arrays"))
+		: (version_at_least(3, 3) || has_extension("GL_ARB_instanced_arrays"));
+
+	_features.transform_feedback = version_at_least(3, 0);  // no ES2 extension
+}
+
+context_features const & features()
+{
+	return _features;
+}
+
+bool has_extension(string const & name)
+{
+	return binary_search(begin(_extensions), end(_extensions), name);
+}
+
+bool version_at_least(int major, int minor)
+{
+	return _features.major > major
+		|| (_features.major == major && _features.minor >= minor);
+}
+
+void * proc_address(char const * name)
+{
+	return (void *)glfwGetProcAddress(name);
+}
+
+}  // glt
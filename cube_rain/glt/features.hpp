@@ -0,0 +1,34 @@
+/*! OpenGL context version and extension queries. */
+#pragma once
+#include <string>
+
+namespace glt {
+
+//! Capabilities of the current OpenGL context, see init_features().
+struct context_features
+{
+	bool gles = false;  //!< OpenGL ES context
+	int major = 0,
+		minor = 0;
+	bool debug_output = false;  //!< KHR_debug (or OpenGL 4.3)
+	bool timer_query = false;  //!< EXT_disjoint_timer_query on ES, ARB_timer_query (or OpenGL 3.3) on desktop
+	bool fence_sync = false;  //!< OpenGL ES 3.0, ARB_sync (or OpenGL 3.2) on desktop
+	bool map_buffer_range = false;  //!< EXT_map_buffer_range (or OpenGL ES 3.0), ARB_map_buffer_range (or OpenGL 3.0) on desktop
+	bool instanced_arrays = false;  //!< EXT/ANGLE_instanced_arrays (or OpenGL ES 3.0), ARB_instanced_arrays (or OpenGL 3.3) on desktop
+	bool transform_feedback = false;  //!< OpenGL ES 3.0, OpenGL 3.0 on desktop
+};
+
+/*! Queries version and extensions of the current context, needs to be called
+once after glfwMakeContextCurrent() and before features() is used. */
+void init_features();
+
+context_features const & features();
+
+bool has_extension(std::string const & name);
+bool version_at_least(int major, int minor);
+
+/*! \return pointer to function name or nullptr if not available (ES entry
+points are often available only with an extension suffix like KHR or EXT). */
+void * proc_address(char const * name);
+
+}  // glt
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include "features.hpp"
+#include "cpu_profiler.hpp"
+#include "gpu_profiler.hpp"
+
+#ifndef GL_GPU_DISJOINT_EXT
+	#define GL_GPU_DISJOINT_EXT 0x8FBB
+#endif
+
+namespace glt {
+
+using std::string,
+	std::min,
+	std::fill_n;
+using std::chrono::steady_clock,
+	std::chrono::duration;
+
+template <typename Proc>
+static Proc load_timer_proc(char const * name)
+{
+	// ES entry points comes from EXT_disjoint_timer_query
+	if (features().gles)
+		return (Proc)proc_address((string{name} + "EXT").c_str());
+	else
+		return (Proc)proc_address(name);
+}
+
+gpu_profiler::scope::scope(gpu_profiler & prof, char const * name)
+	: _prof{prof}
+{
+	_prof.begin(name);
+}
+
+gpu_profiler::scope::~scope()
+{
+	_prof.end();
+}
+
+gpu_profiler::gpu_profiler()
+	: _slot{0}
+	, _current{0}
+	, _query_count{}
+	, _queries{}
+	, _pending{}
+	, _gen_queries{nullptr}
+	, _delete_queries{nullptr}
+	, _begin_query{nullptr}
+	, _end_query{nullptr}
+	, _get_query_objectuiv{nullptr}
+	, _get_query_objectui64v{nullptr}
+{
+	if (!features().timer_query)
+		return;
+
+	_gen_queries = load_timer_proc<PFNGLGENQUERIESPROC>("glGenQueries");
+	_delete_queries = load_timer_proc<PFNGLDELETEQUERIESPROC>("glDeleteQueries");
+	_begin_query = load_timer_proc<PFNGLBEGINQUERYPROC>("glBeginQuery");
+	_end_query = load_timer_proc<PFNGLENDQUERYPROC>("glEndQuery");
+	_get_query_objectuiv = load_timer_proc<PFNGLGETQUERYOBJECTUIVPROC>("glGetQueryObjectuiv");
+	_get_query_objectui64v = load_timer_proc<PFNGLGETQUERYOBJECTUI64VPROC>("glGetQueryObjectui64v");
+
+	_timings.available = _gen_queries && _delete_queries && _begin_query && _end_query
+		&& _get_query_objectuiv && _get_query_objectui64v;
+
+	if (_timings.available)
+		_gen_queries(latency * max_scopes, &_queries[0][0]);
+}
+
+gpu_profiler::~gpu_profiler()
+{
+	if (_timings.available)
+		_delete_queries(latency * max_scopes, &_queries[0][0]);
+}
+
+bool gpu_profiler::available() const
+{
+	return _timings.available;
+}
+
+void gpu_profiler::begin_frame()
+{
+	_slot = _timings.frame % latency;
+	if (available() && _timings.frame >= latency)
+		collect(_slot);  // results from latency frames ago
+
+	_query_count[_slot] = 0;
+
+	_timings.history = _timings.frame % history_size;
+	for (pass & p : _timings.passes)
+		p.gpu_ms[_timings.history] = p.cpu_ms[_timings.history] = 0;
+
+	++_timings.frame;
+}
+
+void gpu_profiler::begin(char const * name)
+{
+	_current = pass_index(name);
+	_cpu_begin = steady_clock::now();
+
+	if (!available() || _query_count[_slot] == max_scopes)
+		return;
+
+	unsigned i = _query_count[_slot];
+	_begin_query(GL_TIME_ELAPSED, _queries[_slot][i]);
+	_pending[_slot][i] = pending_query{_current, _timings.history, true};
+}
+
+void gpu_profiler::end()
+{
+	_timings.passes[_current].cpu_ms[_timings.history] +=
+		duration<float, std::milli>{steady_clock::now() - _cpu_begin}.count();
+
+	if (!available() || _query_count[_slot] == max_scopes)
+		return;
+
+	_end_query(GL_TIME_ELAPSED);
+	++_query_count[_slot];
+}
+
+unsigned gpu_profiler::timings::history_offset() const
+{
+	return (history + 1) % history_size;
+}
+
+float gpu_profiler::timings::gpu_average(pass const & p, unsigned frames) const
+{
+	return average(p.gpu_ms, frames);
+}
+
+float gpu_profiler::timings::cpu_average(pass const & p, unsigned frames) const
+{
+	return average(p.cpu_ms, frames);
+}
+
+float gpu_profiler::timings::average(float const * values, unsigned frames) const
+{
+	// skip latest latency frames (GPU results are not yet there)
+	unsigned available_frames = (frame > latency) ? frame - latency : 0;
+	frames = min({frames, available_frames, history_size - latency});
+	if (frames == 0)
+		return 0;
+
+	float sum = 0;
+	unsigned last = history + history_size - latency;
+	for (unsigned i = 0; i < frames; ++i)
+		sum += values[(last - i) % history_size];
+	return sum / frames;
+}
+
+unsigned gpu_profiler::pass_index(char const * name)
+{
+	std::vector<pass> & passes = _timings.passes;
+	for (unsigned i = 0; i < passes.size(); ++i)
+		if (passes[i].name == name)
+			return i;
+
+	pass p;
+	p.name = name;
+	fill_n(p.gpu_ms, history_size, 0.0f);
+	fill_n(p.cpu_ms, history_size, 0.0f);
+	passes.push_back(p);
+	return passes.size() - 1;
+}
+
+void gpu_profiler::collect(unsigned slot)
+{
+	GLT_PROFILE_ZONE("glt::gpu_profiler::collect");
+
+	GLint disjoint = 0;  // timer results are meaningless after e.g. GPU frequency change
+	if (features().gles)
+		glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+	for (unsigned i = 0; i < _query_count[slot]; ++i)
+	{
+		pending_query & q = _pending[slot][i];
+		if (!q.issued)
+			continue;
+
+		q.issued = false;
+
+		GLuint available = GL_FALSE;
+		_get_query_objectuiv(_queries[slot][i], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available || disjoint)
+			continue;  // result dropped, we do not want to wait
+
+		GLuint64 elapsed_ns = 0;
+		_get_query_objectui64v(_queries[slot][i], GL_QUERY_RESULT, &elapsed_ns);
+		_timings.passes[q.pass].gpu_ms[q.history] += elapsed_ns * 1e-6f;
+	}
+}
+
+}  // glt
@@ -0,0 +1,113 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "opengl.hpp"
+
+namespace glt {
+
+/*! GPU pass timing with timer queries (EXT_disjoint_timer_query on ES,
+ARB_timer_query on desktop OpenGL).
+
+Queries are kept in a ring of `latency` frames and a frame results are read
+back `latency` frames later, so reading never stalls the pipeline (results not
+yet available are dropped). Without timer query support (e.g. llvmpipe ES
+contexts) available() returns false and only CPU (submission) time of scopes
+is measured.
+
+\code
+gpu_profiler prof;
+while (...) {
+	prof.begin_frame();
+	{
+		gpu_profiler::scope s{prof, "cubes"};
+		// draw cubes ...
+	}
+	swap_buffers();
+}
+\endcode
+\note Time elapsed queries can't be nested, so scopes can't be nested as well. */
+class gpu_profiler
+{
+public:
+	static constexpr unsigned latency = 3;  //!< frames in flight
+	static constexpr unsigned max_scopes = 16;
+	static constexpr unsigned history_size = 128;  //!< per scope history in frames
+
+	//! RAII helper for begin()/end()
+	class scope
+	{
+	public:
+		scope(gpu_profiler & prof, char const * name);
+		~scope();
+
+	private:
+		gpu_profiler & _prof;
+	};
+
+	struct pass
+	{
+		std::string name;
+		float gpu_ms[history_size],  //!< time elapsed on GPU (0 if not available)
+			cpu_ms[history_size];  //!< time spent on CPU between begin() and end()
+	};
+
+	/*! Measured pass times, copyable so it can be handed over to other thread
+	(e.g. for GUI). */
+	struct timings
+	{
+		bool available = false;  //!< GPU times available
+		unsigned frame = 0,  //!< frame counter
+			history = 0;  //!< current history index
+		std::vector<pass> passes;
+
+		unsigned history_offset() const;  //!< index of the oldest value in pass histories
+		float gpu_average(pass const & p, unsigned frames = 30) const;  //!< in ms
+		float cpu_average(pass const & p, unsigned frames = 30) const;  //!< in ms
+
+	private:
+		float average(float const * history, unsigned frames) const;
+	};
+
+	gpu_profiler();  //!< needs current context and glt::init_features() called
+	~gpu_profiler();
+
+	bool available() const;  //!< true if timer queries are supported
+	void begin_frame();  //!< collects results of latency frames old queries
+	void begin(char const * name);
+	void end();
+
+	timings const & results() const {return _timings;}
+
+	gpu_profiler(gpu_profiler const &) = delete;
+	void operator=(gpu_profiler const &) = delete;
+
+private:
+	struct pending_query
+	{
+		unsigned pass;  //!< index to timings::passes
+		unsigned history;  //!< history index the result belongs to
+		bool issued;
+	};
+
+	unsigned pass_index(char const * name);
+	void collect(unsigned slot);
+
+	timings _timings;
+	unsigned _slot;  //!< current frame query slot
+	unsigned _current;  //!< pass index between begin() and end()
+	unsigned _query_count[latency];  //!< queries issued per slot
+	GLuint _queries[latency][max_scopes];
+	pending_query _pending[latency][max_scopes];
+	std::chrono::steady_clock::time_point _cpu_begin;
+
+	// timer query entry points (core or EXT suffixed)
+	PFNGLGENQUERIESPROC _gen_queries;
+	PFNGLDELETEQUERIESPROC _delete_queries;
+	PFNGLBEGINQUERYPROC _begin_query;
+	PFNGLENDQUERYPROC _end_query;
+	PFNGLGETQUERYOBJECTUIVPROC _get_query_objectuiv;
+	PFNGLGETQUERYOBJECTUI64VPROC _get_query_objectui64v;
+};
+
+}  // glt
@@ -4,6 +4,8 @@
 #include "io.hpp"
 #include "exception.hpp"
 #include "opengl.hpp"
+#include "debug.hpp"
+#include "cpu_profiler.hpp"
 
 namespace glt::shader {
 
@@ -114,7 +116,7 @@ void module<ShaderType>::from_memory(std::string const & source, unsigned versio
 				throw exception("program shader compilation failed");
 			}
 
-			assert(glGetError() == GL_NO_ERROR && "opengl error");
+			GLT_ASSERT_NO_GL_ERROR();
 		}
 	}
 
@@ -138,9 +140,12 @@ template <typename ShaderType>
 bool module<ShaderType>::compile(std::string const & code, int gl_shader_type,
 	unsigned version,	std::string const & define_constant, unsigned & shader_id)
 {
+	GLT_PROFILE_ZONE("glt::module::compile");
+
 	char const * lines[3];
 
-	std::string version_line = "#version " + std::to_string(version) + "\n";
+	std::string version_line = "#version " + std::to_string(version)
+		+ ((version == 300 || version == 310 || version == 320) ? " es\n" : "\n");  // ES 3.x only versions
 	lines[0] = version_line.c_str();
 
 	std::string define_line = "#define " + define_constant + "\n";
@@ -5,6 +5,7 @@
 #include <boost/format.hpp>
 #include <glm/fwd.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include "debug.hpp"
 #include "program.hpp"
 
 namespace glt::shader {
@@ -19,6 +20,9 @@ namespace detail {
 void gl_error_check()
 {
 #ifndef NDEBUG
+	if (debug::installed())
+		return;  // errors are reported by debug output callback
+
 	switch (glGetError())
 	{
 		case GL_NO_ERROR: return;
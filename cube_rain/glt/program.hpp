@@ -8,6 +8,8 @@
 #include <cassert>
 #include "opengl.hpp"
 #include "module.hpp"
+#include "debug.hpp"
+#include "features.hpp"
 
 namespace glt::shader {
 
@@ -62,6 +64,11 @@ public:
 	void attach(module_ptr m);
 	void attach(std::vector<module_ptr> const & mods);
 
+	/*! Sets vertex shader outputs captured by transform feedback (GL_INTERLEAVED_ATTRIBS),
+	needs to be called before from_file(), from_memory() or attach() (varyings are
+	applied at link time). */
+	void feedback_varyings(std::vector<char const *> const & names);
+
 	int id() const {return _pid;}
 	void use();
 	bool used() const;
@@ -155,7 +162,7 @@ void program<Module>::attach(module_ptr m)
 
 	_modules.push_back(m);
 
-	assert(glGetError() == GL_NO_ERROR && "opengl error");
+	GLT_ASSERT_NO_GL_ERROR();
 }
 
 template <typename Module>
@@ -175,7 +182,19 @@ void program<Module>::attach(std::vector<module_ptr> const & mods)
 	for (auto m : mods)
 		_modules.push_back(m);
 
-	assert(glGetError() == GL_NO_ERROR && "opengl error");
+	GLT_ASSERT_NO_GL_ERROR();
+}
+
+template <typename Module>
+void program<Module>::feedback_varyings(std::vector<char const *> const & names)
+{
+	auto transform_feedback_varyings = (PFNGLTRANSFORMFEEDBACKVARYINGSPROC)proc_address(
+		"glTransformFeedbackVaryings");
+	if (!transform_feedback_varyings)
+		throw exception("transform feedback not available");
+
+	create_program_lazy();
+	transform_feedback_varyings(_pid, (GLsizei)names.size(), names.data(), GL_INTERLEAVED_ATTRIBS);
 }
 
 template <typename Module>
@@ -189,6 +208,8 @@ void program<Module>::create_program_lazy()
 template <typename Module>
 void program<Module>::link()
 {
+	GLT_PROFILE_ZONE("glt::program::link");
+
 	glLinkProgram(_pid);
 
 	bool result = link_check();
@@ -281,7 +302,7 @@ void program<Module>::init_uniforms()
 		append_uniform(uname, location);
 	}
 
-	assert(glGetError() == GL_NO_ERROR);
+	GLT_ASSERT_NO_GL_ERROR();
 }
 
 template <typename Module>
@@ -337,7 +358,7 @@ uniform<Program> & uniform<Program>::operator=(T const & v)
 {
 	assert(_prog->used() && "pokusam sa nastavit uniform neaktivneho programu");
 	set_uniform(_loc, v);	
-	assert(glGetError() == GL_NO_ERROR && "opengl error");
+	GLT_ASSERT_NO_GL_ERROR();
 	return *this;
 }
 
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cassert>
+#include "cpu_profiler.hpp"
+#include "render_queue.hpp"
+
+namespace glt {
+
+using std::vector,
+	std::move,
+	std::min,
+	std::max;
+
+namespace sort_key {
+
+constexpr unsigned depth_shift = 8,
+	material_shift = depth_shift + depth_bits,
+	mesh_shift = material_shift + material_bits,
+	program_shift = mesh_shift + mesh_bits,
+	layer_shift = program_shift + program_bits;
+
+static_assert(layer_shift + layer_bits == 64, "sort key layout needs to fit 64 bits");
+
+constexpr uint64_t mask(unsigned bits)
+{
+	return (uint64_t{1} << bits) - 1;
+}
+
+uint64_t make(unsigned layer, unsigned program, unsigned mesh, unsigned material, float depth)
+{
+	assert(layer <= mask(layer_bits) && program <= mask(program_bits)
+		&& mesh <= mask(mesh_bits) && material <= mask(material_bits));
+
+	uint64_t const d = uint64_t(min(max(depth, 0.0f), 1.0f) * mask(depth_bits));
+
+	return (uint64_t{layer} << layer_shift)
+		| (uint64_t{program} << program_shift)
+		| (uint64_t{mesh} << mesh_shift)
+		| (uint64_t{material} << material_shift)
+		| (d << depth_shift);
+}
+
+unsigned layer(uint64_t key)
+{
+	return (key >> layer_shift) & mask(layer_bits);
+}
+
+unsigned program(uint64_t key)
+{
+	return (key >> program_shift) & mask(program_bits);
+}
+
+unsigned mesh(uint64_t key)
+{
+	return (key >> mesh_shift) & mask(mesh_bits);
+}
+
+unsigned material(uint64_t key)
+{
+	return (key >> material_shift) & mask(material_bits);
+}
+
+}  // sort_key
+
+render_queue::render_queue()
+	: _programs(1)  // 0 means none
+	, _meshes(1)
+	, _materials(1)
+{}
+
+unsigned render_queue::add_program(bind_function bind)
+{
+	assert(_programs.size() <= sort_key::mask(sort_key::program_bits));
+	_programs.push_back(move(bind));
+	return _programs.size() - 1;
+}
+
+unsigned render_queue::add_mesh(bind_function bind)
+{
+	assert(_meshes.size() <= sort_key::mask(sort_key::mesh_bits));
+	_meshes.push_back(move(bind));
+	return _meshes.size() - 1;
+}
+
+unsigned render_queue::add_material(bind_function bind)
+{
+	assert(_materials.size() <= sort_key::mask(sort_key::material_bits));
+	_materials.push_back(move(bind));
+	return _materials.size() - 1;
+}
+
+void render_queue::push(uint64_t key, draw_function draw, void const * data)
+{
+	_items.push_back(item{key, draw, data});
+}
+
+void render_queue::sort()
+{
+	GLT_PROFILE_ZONE("glt::render_queue::sort");
+
+	size_t const n = _items.size();
+	_sorted.resize(n);
+
+	// one pass per key byte, passes where all keys share the byte are skipped
+	for (unsigned shift = 0; shift < 64; shift += 8)
+	{
+		size_t offsets[256] = {};
+		for (item const & i : _items)
+			++offsets[(i.key >> shift) & 0xff];
+
+		if (offsets[(_items.empty() ? 0 : _items[0].key >> shift) & 0xff] == n)
+			continue;
+
+		size_t sum = 0;
+		for (size_t & o : offsets)
+		{
+			size_t count = o;
+			o = sum;
+			sum += count;
+		}
+
+		for (item const & i : _items)
+			_sorted[offsets[(i.key >> shift) & 0xff]++] = i;
+
+		_items.swap(_sorted);
+	}
+}
+
+void render_queue::submit(state_cache & state) const
+{
+	submit(state, nullptr);
+}
+
+void render_queue::submit(state_cache & state, pass_function const & pass) const
+{
+	GLT_PROFILE_ZONE("glt::render_queue::submit");
+
+	unsigned program = 0,
+		mesh = 0,
+		material = 0;
+
+	for (item const & i : _items)
+	{
+		unsigned const p = sort_key::program(i.key),
+			me = sort_key::mesh(i.key),
+			ma = sort_key::material(i.key);
+
+		bool const first = (&i == _items.data());
+		if (pass && (first || p != program))
+		{
+			if (!first)
+				pass(program, false);
+			pass(p, true);
+		}
+
+		if (p != program)
+		{
+			if (p)
+				_programs[p](state);
+			program = p;
+			mesh = material = 0;  // attribute locations and uniforms are per program
+		}
+
+		if (me != mesh)
+		{
+			if (me)
+				_meshes[me](state);
+			mesh = me;
+		}
+
+		if (ma != material)
+		{
+			if (ma)
+				_materials[ma](state);
+			material = ma;
+		}
+
+		i.draw(state, i.data);
+	}
+
+	if (pass && !_items.empty())
+		pass(program, false);
+}
+
+void render_queue::clear()
+{
+	_items.clear();
+}
+
+vector<render_queue::item> const & render_queue::items() const
+{
+	return _items;
+}
+
+}  // glt
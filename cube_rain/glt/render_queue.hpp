@@ -0,0 +1,87 @@
+/*! Sorted draw submission. */
+#pragma once
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include "state.hpp"
+
+namespace glt {
+
+/*! 64 bit draw item sort key, from the most significant bits
+
+	layer:4 | program:8 | mesh:8 | material:12 | depth:24 | unused:8
+
+so items are grouped by layer (e.g. opaque geometry before GUI overlay), then
+by program, mesh and material to minimize state changes and drawn front to
+back within a group. Program, mesh and material ids comes from
+render_queue::add_program(), add_mesh() and add_material(), 0 means none. */
+namespace sort_key {
+
+constexpr unsigned layer_bits = 4,
+	program_bits = 8,
+	mesh_bits = 8,
+	material_bits = 12,
+	depth_bits = 24;
+
+uint64_t make(unsigned layer, unsigned program, unsigned mesh, unsigned material,
+	float depth);  //!< depth in [0,1] range (values outside are clamped)
+
+unsigned layer(uint64_t key);
+unsigned program(uint64_t key);
+unsigned mesh(uint64_t key);
+unsigned material(uint64_t key);
+
+}  // sort_key
+
+/*! Collects draw items each frame, sorts them by key and submits them with
+only necessary program, mesh and material binds.
+
+\code
+render_queue q;
+unsigned prog = q.add_program([&](state_cache & s){s.use(shader);});
+// each frame
+q.push(sort_key::make(0, prog, 0, 0, depth), draw_cube, &cube);
+q.sort();
+q.submit(state);
+q.clear();
+\endcode */
+class render_queue
+{
+public:
+	using draw_function = void (*)(state_cache & state, void const * data);
+	using bind_function = std::function<void (state_cache & state)>;
+	using pass_function = std::function<void (unsigned program, bool begin)>;  //!< see submit()
+
+	struct item
+	{
+		uint64_t key;
+		draw_function draw;
+		void const * data;  //!< passed to draw, needs to be valid until submit()
+	};
+
+	render_queue();
+
+	unsigned add_program(bind_function bind);
+	unsigned add_mesh(bind_function bind);  //!< \note program needs to be bound before mesh
+	unsigned add_material(bind_function bind);  //!< \note program needs to be bound before material
+
+	void push(uint64_t key, draw_function draw, void const * data = nullptr);
+	void sort();  //!< stable LSD radix sort by key
+	void submit(state_cache & state) const;  //!< \note call sort() first
+
+	/*! Submit with pass called around each run of items sharing a program (before
+	program bind and after the last item), e.g. for per program GPU profiler passes. */
+	void submit(state_cache & state, pass_function const & pass) const;
+	void clear();
+
+	std::vector<item> const & items() const;
+
+private:
+	std::vector<item> _items,
+		_sorted;  //!< radix sort temporary
+	std::vector<bind_function> _programs,
+		_meshes,
+		_materials;
+};
+
+}  // glt
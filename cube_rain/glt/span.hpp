@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+
+namespace glt {
+
+//! Non owning view of contiguous elements (C++17 has no std::span).
+template <typename T>
+class span
+{
+public:
+	span() : _data{nullptr}, _size{0} {}
+	span(T * data, size_t size) : _data{data}, _size{size} {}
+
+	T * data() const {return _data;}
+	size_t size() const {return _size;}
+	bool empty() const {return _size == 0;}
+	T & operator[](size_t i) const {return _data[i];}
+	T * begin() const {return _data;}
+	T * end() const {return _data + _size;}
+
+private:
+	T * _data;
+	size_t _size;
+};
+
+}  // glt
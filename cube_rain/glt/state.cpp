@@ -0,0 +1,168 @@
+#include <cassert>
+#include <string>
+#include "features.hpp"
+#include "state.hpp"
+
+namespace glt {
+
+using std::string;
+
+constexpr GLuint unknown = (GLuint)-1;  // binding we do not know about
+
+template <typename Proc>
+static Proc load_instancing_proc(char const * name)
+{
+	// ES2 entry points comes from EXT_instanced_arrays or ANGLE_instanced_arrays
+	for (char const * suffix : {"", "ARB", "EXT", "ANGLE"})
+		if (void * p = proc_address((string{name} + suffix).c_str()))
+			return (Proc)p;
+	return nullptr;
+}
+
+state_cache::state_cache()
+	: _vertex_attrib_divisor{nullptr}
+	, _draw_arrays_instanced{nullptr}
+{
+	if (features().instanced_arrays)
+	{
+		_vertex_attrib_divisor = load_instancing_proc<PFNGLVERTEXATTRIBDIVISORPROC>("glVertexAttribDivisor");
+		_draw_arrays_instanced = load_instancing_proc<PFNGLDRAWARRAYSINSTANCEDPROC>("glDrawArraysInstanced");
+		if (!_vertex_attrib_divisor || !_draw_arrays_instanced)
+			_vertex_attrib_divisor = nullptr, _draw_arrays_instanced = nullptr;
+	}
+
+	invalidate();
+}
+
+void state_cache::bind_array_buffer(GLuint vbo)
+{
+	if (_array_buffer == vbo)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	_array_buffer = vbo;
+	++_stats.buffers;
+}
+
+void state_cache::enable_attribute(GLint loc)
+{
+	assert(loc >= 0 && loc < (GLint)max_attributes);
+	attribute & a = _attributes[loc];
+	if (a.enabled == GL_TRUE)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	glEnableVertexAttribArray(loc);
+	a.enabled = GL_TRUE;
+	++_stats.attributes;
+}
+
+void state_cache::disable_attribute(GLint loc)
+{
+	assert(loc >= 0 && loc < (GLint)max_attributes);
+	attribute & a = _attributes[loc];
+	if (a.enabled == GL_FALSE)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	glDisableVertexAttribArray(loc);
+	a.enabled = GL_FALSE;
+	++_stats.attributes;
+}
+
+void state_cache::enable_attributes(unsigned mask)
+{
+	for (GLint loc = 0; loc < (GLint)max_attributes; ++loc)
+	{
+		if (mask & (1u << loc))
+			enable_attribute(loc);
+		else if (_attributes[loc].enabled != GL_FALSE)
+			disable_attribute(loc);
+	}
+}
+
+void state_cache::attribute_pointer(GLint loc, GLuint vbo, int size, GLsizei stride,
+	GLintptr offset, GLuint divisor)
+{
+	assert(loc >= 0 && loc < (GLint)max_attributes);
+	enable_attribute(loc);
+
+	if (instancing())
+		attribute_divisor(loc, divisor);
+
+	attribute & a = _attributes[loc];
+	if (a.vbo == vbo && a.size == size && a.stride == stride && a.offset == offset)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	bind_array_buffer(vbo);
+	glVertexAttribPointer(loc, size, GL_FLOAT, GL_FALSE, stride, (GLvoid *)offset);
+	a.vbo = vbo;
+	a.size = size;
+	a.stride = stride;
+	a.offset = offset;
+	++_stats.attributes;
+}
+
+bool state_cache::instancing() const
+{
+	return _draw_arrays_instanced != nullptr;
+}
+
+void state_cache::attribute_divisor(GLint loc, GLuint divisor)
+{
+	assert(instancing() && loc >= 0 && loc < (GLint)max_attributes);
+	attribute & a = _attributes[loc];
+	if (a.divisor == divisor)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	_vertex_attrib_divisor(loc, divisor);
+	a.divisor = divisor;
+	++_stats.attributes;
+}
+
+void state_cache::draw_arrays(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+	++_stats.draws;
+}
+
+void state_cache::draw_arrays_instanced(GLenum mode, GLint first, GLsizei count,
+	GLsizei instances)
+{
+	assert(instancing());
+	_draw_arrays_instanced(mode, first, count, instances);
+	++_stats.draws;
+}
+
+void state_cache::invalidate()
+{
+	_shader = nullptr;
+	_array_buffer = unknown;
+	for (attribute & a : _attributes)
+		a = attribute{unknown, unknown, unknown, 0, 0, 0};
+}
+
+state_cache::counters const & state_cache::stats() const
+{
+	return _stats;
+}
+
+void state_cache::reset_stats()
+{
+	_stats = counters{};
+}
+
+}  // glt
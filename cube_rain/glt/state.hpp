@@ -0,0 +1,89 @@
+/*! OpenGL state layer, skips redundant binds and counts state changes. */
+#pragma once
+#include "opengl.hpp"
+
+namespace glt {
+
+/*! Cache of bound programs, buffers and vertex attribute arrays.
+
+Skips binds of already bound objects. It has no idea about state changed
+behind its back, call invalidate() after a foreign code (e.g. ImGui backend)
+touched GL state.
+\note Needs to be used from the thread with current context. */
+class state_cache
+{
+public:
+	static constexpr unsigned max_attributes = 16;
+
+	struct counters
+	{
+		unsigned programs = 0,  //!< program changes
+			buffers = 0,  //!< buffer binds
+			attributes = 0,  //!< vertex attribute pointer/array/divisor changes
+			draws = 0,  //!< draw calls
+			skipped = 0;  //!< redundant changes skipped by cache
+	};
+
+	state_cache();
+
+	/*! Makes shader current (calls shader.use()), shader is any object with
+	use() member function (like glt::shader::program). */
+	template <typename Shader>
+	void use(Shader & shader);
+
+	void bind_array_buffer(GLuint vbo);
+	void enable_attribute(GLint loc);
+	void disable_attribute(GLint loc);
+	void enable_attributes(unsigned mask);  //!< enables attributes with bit set in mask, disables the rest
+
+	/*! Binds vbo and sets attribute pointer to float components in vbo.
+	\param divisor instance divisor (ignored without instancing()) */
+	void attribute_pointer(GLint loc, GLuint vbo, int size, GLsizei stride = 0,
+		GLintptr offset = 0, GLuint divisor = 0);
+
+	bool instancing() const;  //!< instanced arrays available
+	void attribute_divisor(GLint loc, GLuint divisor);  //!< \note needs instancing()
+
+	void draw_arrays(GLenum mode, GLint first, GLsizei count);
+	void draw_arrays_instanced(GLenum mode, GLint first, GLsizei count,
+		GLsizei instances);  //!< \note needs instancing()
+
+	void invalidate();  //!< forgets cached state (nothing is treated as bound)
+	counters const & stats() const;
+	void reset_stats();
+
+private:
+	struct attribute
+	{
+		GLuint enabled,  //!< GL_TRUE, GL_FALSE or unknown
+			vbo,
+			divisor;
+		int size;
+		GLsizei stride;
+		GLintptr offset;
+	};
+
+	void const * _shader;  //!< current shader
+	GLuint _array_buffer;
+	attribute _attributes[max_attributes];
+	counters _stats;
+
+	PFNGLVERTEXATTRIBDIVISORPROC _vertex_attrib_divisor;
+	PFNGLDRAWARRAYSINSTANCEDPROC _draw_arrays_instanced;
+};
+
+template <typename Shader>
+void state_cache::use(Shader & shader)
+{
+	if (_shader == &shader)
+	{
+		++_stats.skipped;
+		return;
+	}
+
+	shader.use();
+	_shader = &shader;
+	++_stats.programs;
+}
+
+}  // glt
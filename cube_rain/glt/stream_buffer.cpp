@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include "features.hpp"
+#include "cpu_profiler.hpp"
+#include "stream_buffer.hpp"
+
+namespace glt {
+
+using std::string;
+
+constexpr size_t alignment = 16;  // keeps sub-allocations vec4 aligned
+constexpr GLuint64 wait_timeout = 1000000;  // 1ms in ns
+
+template <typename Proc>
+static Proc load_buffer_proc(char const * name)
+{
+	// ES2 entry points comes from EXT_map_buffer_range and OES_mapbuffer
+	if (void * p = proc_address(name))
+		return (Proc)p;
+	else if (void * p = proc_address((string{name} + "EXT").c_str()))
+		return (Proc)p;
+	else
+		return (Proc)proc_address((string{name} + "OES").c_str());
+}
+
+size_t stream_buffer::align_up(size_t n)
+{
+	return (n + alignment - 1) & ~(alignment - 1);
+}
+
+stream_buffer::stream_buffer(GLenum target, size_t region_size)
+	: _target{target}
+	, _vbo{0}
+	, _region_size{0}
+	, _head{0}
+	, _mapped_size{0}
+	, _region{0}
+	, _stalls{0}
+	, _fenced{false}
+	, _fences{}
+	, _map_buffer_range{nullptr}
+	, _unmap_buffer{nullptr}
+	, _fence_sync{nullptr}
+	, _client_wait_sync{nullptr}
+	, _delete_sync{nullptr}
+{
+	if (features().fence_sync && features().map_buffer_range)
+	{
+		_map_buffer_range = load_buffer_proc<PFNGLMAPBUFFERRANGEPROC>("glMapBufferRange");
+		_unmap_buffer = load_buffer_proc<PFNGLUNMAPBUFFERPROC>("glUnmapBuffer");
+		_fence_sync = (PFNGLFENCESYNCPROC)proc_address("glFenceSync");
+		_client_wait_sync = (PFNGLCLIENTWAITSYNCPROC)proc_address("glClientWaitSync");
+		_delete_sync = (PFNGLDELETESYNCPROC)proc_address("glDeleteSync");
+
+		_fenced = _map_buffer_range && _unmap_buffer && _fence_sync && _client_wait_sync
+			&& _delete_sync;
+	}
+
+	glGenBuffers(1, &_vbo);
+	allocate(align_up(region_size));
+}
+
+stream_buffer::~stream_buffer()
+{
+	for (GLsync & fence : _fences)
+		if (fence)
+			_delete_sync(fence);
+
+	glDeleteBuffers(1, &_vbo);
+}
+
+GLintptr stream_buffer::unmap()
+{
+	assert(_mapped_size > 0 && "buffer not mapped");
+
+	GLintptr offset = _head;
+	glBindBuffer(_target, _vbo);
+
+	if (_fenced)
+	{
+		offset += _region * _region_size;
+		_unmap_buffer(_target);
+	}
+	else
+		glBufferSubData(_target, offset, _mapped_size, _staging.data() + offset);
+
+	_head = align_up(_head + _mapped_size);
+	_mapped_size = 0;
+	return offset;
+}
+
+void stream_buffer::end_frame()
+{
+	assert(_mapped_size == 0 && "buffer still mapped");
+
+	if (_head == 0)
+		return;  // nothing written, we can reuse region
+
+	if (_fenced)
+	{
+		_fences[_region] = _fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		_region = (_region + 1) % region_count;
+	}
+
+	_head = 0;
+}
+
+GLuint stream_buffer::id() const
+{
+	return _vbo;
+}
+
+bool stream_buffer::fenced() const
+{
+	return _fenced;
+}
+
+size_t stream_buffer::region_size() const
+{
+	return _region_size;
+}
+
+unsigned stream_buffer::stalls() const
+{
+	return _stalls;
+}
+
+void stream_buffer::reserve(size_t size)
+{
+	assert(_head == 0 && _mapped_size == 0 && "reserve() after map() in a frame");
+
+	if (size > _region_size)  // grow, new storage so no wait is needed
+		allocate(align_up(std::max(2*_region_size, size)));
+}
+
+void * stream_buffer::map_bytes(size_t size)
+{
+	assert(_mapped_size == 0 && "buffer already mapped");
+	assert(size > 0);
+
+	if (_head + size > _region_size)
+	{
+		if (_head > 0)  // growing would orphan data mapped earlier in the frame
+			throw std::length_error{"glt::stream_buffer: frame does not fit, call reserve() before the first map()"};
+
+		reserve(size);
+	}
+
+	glBindBuffer(_target, _vbo);
+	_mapped_size = size;
+
+	if (!_fenced)
+	{
+		if (_head == 0)  // first write in a frame, orphan storage used by previous frame
+			glBufferData(_target, _region_size, nullptr, GL_STREAM_DRAW);
+
+		return _staging.data() + _head;
+	}
+
+	if (_head == 0)
+		wait_region(_region);
+
+	return _map_buffer_range(_target, _region * _region_size + _head, size,
+		GL_MAP_WRITE_BIT|GL_MAP_UNSYNCHRONIZED_BIT|GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void stream_buffer::allocate(size_t region_size)
+{
+	_region_size = region_size;
+
+	// old fences guard old storage (orphaned by glBufferData)
+	for (GLsync & fence : _fences)
+	{
+		if (fence)
+			_delete_sync(fence);
+		fence = nullptr;
+	}
+
+	glBindBuffer(_target, _vbo);
+	if (_fenced)
+		glBufferData(_target, region_count * region_size, nullptr, GL_STREAM_DRAW);
+	else
+	{
+		glBufferData(_target, region_size, nullptr, GL_STREAM_DRAW);
+		_staging.resize(region_size);
+	}
+}
+
+void stream_buffer::wait_region(unsigned region)
+{
+	GLsync & fence = _fences[region];
+	if (!fence)
+		return;
+
+	GLenum result = _client_wait_sync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	if (result == GL_TIMEOUT_EXPIRED)  // GPU still reads the region
+	{
+		GLT_PROFILE_ZONE("glt::stream_buffer stall");
+		++_stalls;
+		do
+			result = _client_wait_sync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_timeout);
+		while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	_delete_sync(fence);
+	fence = nullptr;
+}
+
+}  // glt
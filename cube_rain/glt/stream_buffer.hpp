@@ -0,0 +1,100 @@
+#pragma once
+#include <vector>
+#include "opengl.hpp"
+#include "span.hpp"
+
+namespace glt {
+
+/*! Buffer for data uploaded every frame (e.g. per instance data).
+
+Buffer is split into region_count regions, each frame sub-allocates from one
+region and the region is guarded by a fence at the end_frame(), so we only
+wait (stall) if GPU is more than region_count-1 frames behind. Without fence
+sync support (GLES2) buffer is orphaned each frame and data are copied from
+a CPU staging memory instead.
+
+Buffer grows only before the first map() in a frame (in reserve() or the first
+map() itself), growing later would orphan data already mapped in the frame.
+With more map() calls per frame reserve() the whole frame size first.
+
+\code
+stream_buffer instances{GL_ARRAY_BUFFER, 64*1024};
+// ... each frame
+instances.reserve(stream_buffer::map_size<cube_instance>(n) + stream_buffer::map_size<vec4>(m));
+span<cube_instance> data = instances.map<cube_instance>(n);
+// fill data
+GLintptr offset = instances.unmap();  // data are at offset in instances.id() buffer
+// draw
+instances.end_frame();
+\endcode
+\note Needs to be used from the thread with current context. */
+class stream_buffer
+{
+public:
+	static constexpr unsigned region_count = 3;
+
+	stream_buffer(GLenum target, size_t region_size);
+	~stream_buffer();
+
+	/*! Makes room for size bytes mapped in the frame (see map_size()), grows
+	the buffer if needed. \note Call before the first map() in a frame. */
+	void reserve(size_t size);
+
+	/*! Maps count elements for writing, buffer is bound to target after call.
+	\note Only one map() at a time, call unmap() before next map().
+	\throw std::length_error if count does not fit and something was already
+	mapped in the frame (reserve() missing) */
+	template <typename T>
+	span<T> map(size_t count);
+
+	template <typename T>
+	static size_t map_size(size_t count);  //!< bytes map<T>(count) takes from the frame (aligned)
+
+	GLintptr unmap();  //!< \return offset of the mapped data in id() buffer
+	void end_frame();
+
+	GLuint id() const;
+	bool fenced() const;  //!< false for orphaning fallback
+	size_t region_size() const;
+	unsigned stalls() const;  //!< number of map() calls waiting for GPU so far
+
+	stream_buffer(stream_buffer const &) = delete;
+	void operator=(stream_buffer const &) = delete;
+
+private:
+	static size_t align_up(size_t n);
+	void * map_bytes(size_t size);
+	void allocate(size_t region_size);
+	void wait_region(unsigned region);
+
+	GLenum _target;
+	GLuint _vbo;
+	size_t _region_size,
+		_head,  //!< first free byte in current region
+		_mapped_size;
+	unsigned _region,
+		_stalls;
+	bool _fenced;
+	GLsync _fences[region_count];
+	std::vector<char> _staging;  //!< orphaning fallback only
+
+	PFNGLMAPBUFFERRANGEPROC _map_buffer_range;
+	PFNGLUNMAPBUFFERPROC _unmap_buffer;
+	PFNGLFENCESYNCPROC _fence_sync;
+	PFNGLCLIENTWAITSYNCPROC _client_wait_sync;
+	PFNGLDELETESYNCPROC _delete_sync;
+};
+
+template <typename T>
+span<T> stream_buffer::map(size_t count)
+{
+	return span<T>{static_cast<T *>(map_bytes(count * sizeof(T))), count};
+}
+
+template <typename T>
+size_t stream_buffer::map_size(size_t count)
+{
+	return align_up(count * sizeof(T));
+}
+
+}  // glt
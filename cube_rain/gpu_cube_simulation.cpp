@@ -0,0 +1,184 @@
+#include <vector>
+#include "glt/features.hpp"
+#include "glt/cpu_profiler.hpp"
+#include "glt/debug.hpp"
+#include "cube_simulation.hpp"
+#include "gpu_cube_simulation.hpp"
+
+using std::vector,
+	std::copy;
+
+// needs to match new_cube(), cube_fall() and cube_rules
+constexpr char update_program_code[] = R"(
+#ifdef _VERTEX_
+in vec4 instance;  // xyz world position, w half size
+uniform float dt;
+uniform int seed;  // frame number (glt sets int uniforms only, ES2 API)
+out vec4 updated;
+
+const float fall_speed = 3.0;
+const float respawn_height = -10.0;
+const float half_size = 0.2;
+
+uint hash(uint x)  // lowbias32
+{
+	x ^= x >> 16;
+	x *= 0x7feb352du;
+	x ^= x >> 15;
+	x *= 0x846ca68bu;
+	x ^= x >> 16;
+	return x;
+}
+
+float random(inout uint state)  // [0, 1)
+{
+	state = hash(state);
+	return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main() {
+	float scale = instance.w / half_size;
+	vec3 p = instance.xyz;
+	p.y -= fall_speed * (2.0 - scale) * dt;
+
+	if (p.y < respawn_height)
+	{
+		uint state = hash(uint(gl_VertexID) ^ hash(uint(seed)));
+		p = vec3(floor(random(state) * 15.0) - 7.0,
+			7.0 + floor(random(state) * 30.0),
+			floor(random(state) * 15.0) - 7.0);
+		scale = 0.7 + floor(random(state) * 70.0) / 100.0;
+	}
+
+	updated = vec4(p, half_size * scale);
+}
+#endif
+
+#ifdef _FRAGMENT_
+precision mediump float;
+out vec4 color;
+void main() {  // never executed, rasterization is discarded
+	color = vec4(0.0);
+}
+#endif
+)";
+
+//! cube instance respawned by next update
+constexpr float fallen_cube[4] = {0, -1000, 0, cube_rules::half_size};
+
+bool gpu_cube_simulation::available()
+{
+	return glt::features().transform_feedback;
+}
+
+gpu_cube_simulation::gpu_cube_simulation()
+	: _vbos{0, 0}
+	, _current{0}
+	, _size{0}
+	, _capacity{0}
+	, _frame{0}
+{
+	_begin_transform_feedback = (PFNGLBEGINTRANSFORMFEEDBACKPROC)glt::proc_address("glBeginTransformFeedback");
+	_end_transform_feedback = (PFNGLENDTRANSFORMFEEDBACKPROC)glt::proc_address("glEndTransformFeedback");
+	_bind_buffer_base = (PFNGLBINDBUFFERBASEPROC)glt::proc_address("glBindBufferBase");
+	_copy_buffer_sub_data = (PFNGLCOPYBUFFERSUBDATAPROC)glt::proc_address("glCopyBufferSubData");
+
+	_prog.feedback_varyings({"updated"});
+	_prog.from_memory(update_program_code, 300);
+	glt::debug::label(glt::debug::object::program, _prog.id(), "gpu_cube_simulation");
+	_dt_u = _prog.uniform_variable("dt");
+	_seed_u = _prog.uniform_variable("seed");
+	_instance = _prog.attribute_location("instance");
+
+	glGenBuffers(2, _vbos);
+	glt::debug::label(glt::debug::object::buffer, _vbos[0], "simulated cubes 0");
+	glt::debug::label(glt::debug::object::buffer, _vbos[1], "simulated cubes 1");
+}
+
+gpu_cube_simulation::~gpu_cube_simulation()
+{
+	glDeleteBuffers(2, _vbos);
+}
+
+void gpu_cube_simulation::resize(unsigned cube_count)
+{
+	if (cube_count > _capacity)
+		reserve(cube_count);
+
+	if (cube_count > _size)  // mark new cubes as fallen
+	{
+		vector<float> fallen(4*(cube_count - _size));
+		for (size_t i = 0; i < fallen.size(); i += 4)
+			copy(fallen_cube, fallen_cube + 4, begin(fallen) + i);
+
+		glBindBuffer(GL_ARRAY_BUFFER, _vbos[_current]);
+		glBufferSubData(GL_ARRAY_BUFFER, _size*sizeof(fallen_cube), fallen.size()*sizeof(float),
+			fallen.data());
+	}
+
+	_size = cube_count;
+}
+
+void gpu_cube_simulation::reserve(unsigned cube_count)
+{
+	GLT_PROFILE_ZONE("gpu_cube_simulation::reserve");
+
+	GLuint vbos[2];
+	glGenBuffers(2, vbos);
+	for (GLuint vbo : vbos)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, cube_count*sizeof(fallen_cube), nullptr, GL_DYNAMIC_COPY);
+	}
+
+	if (_size > 0)  // keep simulated cubes
+	{
+		glBindBuffer(GL_COPY_READ_BUFFER, _vbos[_current]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbos[0]);
+		_copy_buffer_sub_data(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, _size*sizeof(fallen_cube));
+	}
+
+	glDeleteBuffers(2, _vbos);
+	_vbos[0] = vbos[0];
+	_vbos[1] = vbos[1];
+	_current = 0;
+	_capacity = cube_count;
+}
+
+void gpu_cube_simulation::update(float dt)
+{
+	if (_size == 0)
+		return;
+
+	_prog.use();
+	_dt_u = dt;
+	_seed_u = int(_frame++);
+
+	GLuint const src = _vbos[_current],
+		dst = _vbos[1 - _current];
+
+	glBindBuffer(GL_ARRAY_BUFFER, src);
+	glEnableVertexAttribArray(_instance);
+	glVertexAttribPointer(_instance, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
+
+	_bind_buffer_base(GL_TRANSFORM_FEEDBACK_BUFFER, 0, dst);
+	glEnable(GL_RASTERIZER_DISCARD);
+	_begin_transform_feedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, _size);
+	_end_transform_feedback();
+	glDisable(GL_RASTERIZER_DISCARD);
+	_bind_buffer_base(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+	glDisableVertexAttribArray(_instance);
+	_current = 1 - _current;
+}
+
+GLuint gpu_cube_simulation::instances() const
+{
+	return _vbos[_current];
+}
+
+unsigned gpu_cube_simulation::size() const
+{
+	return _size;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "glt/gles2.hpp"
+#include "glt/program.hpp"
+
+/*! Falling cubes simulated on GPU with transform feedback, there is no per
+cube work on CPU.
+
+Cube instances (vec4, xyz for world position, w for half size, the same layout
+as cube_instance) are kept in two buffers, update() reads one and writes the
+other with rasterization disabled, then buffers are swapped (ping-pong). Fallen
+cubes are respawned with random function hashed from vertex ID and frame
+number. Result can be drawn directly from instances() buffer with
+gles2::instanced_shaded_shader.
+
+\code
+gpu_cube_simulation sim;
+sim.resize(1000000);
+// each frame
+sim.update(dt);
+// bind sim.instances() as instance attribute (divisor 1) and draw sim.size() instances
+\endcode
+\note Needs transform feedback (OpenGL ES 3.0), see available(). Program and
+buffer bindings are changed by update(). */
+class gpu_cube_simulation
+{
+public:
+	using program = glt::shader::program<glt::shader::module<
+		glt::shader::gles2_shader_type>>;
+
+	static bool available();
+
+	gpu_cube_simulation();
+	~gpu_cube_simulation();
+
+	void resize(unsigned cube_count);  //!< new cubes are spawned by next update()
+	void update(float dt);
+
+	GLuint instances() const;  //!< buffer with cube instances written by last update()
+	unsigned size() const;
+
+	gpu_cube_simulation(gpu_cube_simulation const &) = delete;
+	void operator=(gpu_cube_simulation const &) = delete;
+
+private:
+	void reserve(unsigned cube_count);
+
+	program _prog;
+	program::uniform_type _dt_u,
+		_seed_u;
+	int _instance;
+	GLuint _vbos[2];
+	unsigned _current,  //!< index of _vbos with latest cube instances
+		_size,
+		_capacity,
+		_frame;
+
+	PFNGLBEGINTRANSFORMFEEDBACKPROC _begin_transform_feedback;
+	PFNGLENDTRANSFORMFEEDBACKPROC _end_transform_feedback;
+	PFNGLBINDBUFFERBASEPROC _bind_buffer_base;
+	PFNGLCOPYBUFFERSUBDATAPROC _copy_buffer_sub_data;
+};
@@ -0,0 +1,73 @@
+#include "glt/debug.hpp"
+#include "impostor_shader.hpp"
+
+namespace gles2 {
+
+constexpr char shader_program_code[] = R"(
+// #version 100
+#ifdef _VERTEX_
+attribute vec4 instance;  // xyz world position, w cube half size
+uniform mat4 world_to_screen;
+uniform float point_scale;
+void main() {
+	gl_Position = world_to_screen * vec4(instance.xyz, 1.0);
+	gl_PointSize = max(2.0 * 1.4 * instance.w * point_scale / gl_Position.w, 1.0);  // 1.4 for cube diagonal
+}
+#endif
+
+#ifdef _FRAGMENT_
+precision mediump float;
+uniform vec3 color;
+uniform vec3 light_direction;  // from surface to light in world space
+void main() {
+	// top face in upper third of the sprite, side faces bellow
+	vec3 n = (gl_PointCoord.y < 0.33) ? vec3(0.0, 1.0, 0.0)
+		: ((gl_PointCoord.x < 0.5) ? vec3(-1.0, 0.0, 0.0) : vec3(0.0, 0.0, -1.0));
+	gl_FragColor = vec4(max(dot(n, light_direction), 0.2) * color, 1.0);
+}
+#endif
+)";
+
+impostor_shader::impostor_shader()
+{
+	_prog.from_memory(shader_program_code, 100);
+	glt::debug::label(glt::debug::object::program, _prog.id(), "impostor_shader");
+	_color_u = _prog.uniform_variable("color");
+	_light_dir_u = _prog.uniform_variable("light_direction");
+	_world_to_screen_u = _prog.uniform_variable("world_to_screen");
+	_point_scale_u = _prog.uniform_variable("point_scale");
+	_instance = _prog.attribute_location("instance");
+}
+
+void impostor_shader::use()
+{
+	if (!_prog.used())
+		_prog.use();
+}
+
+int impostor_shader::instance_location() const
+{
+	return _instance;
+}
+
+void impostor_shader::model_color(vec3 const & rgb)
+{
+	_color_u = rgb;
+}
+
+void impostor_shader::light_direction(vec3 const & ldir)
+{
+	_light_dir_u = ldir;
+}
+
+void impostor_shader::world_to_screen(mat4 const & VP)
+{
+	_world_to_screen_u = VP;
+}
+
+void impostor_shader::point_scale(float pixels)
+{
+	_point_scale_u = pixels;
+}
+
+}  // gles2
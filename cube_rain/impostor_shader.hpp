@@ -0,0 +1,39 @@
+#pragma once
+#include "glt/gles2.hpp"
+#include "glt/program.hpp"
+#include "phys/matrices.h"
+
+namespace gles2 {
+
+using phys::vec3,
+	phys::mat4;
+
+using program = glt::shader::program<glt::shader::module<
+	glt::shader::gles2_shader_type>>;
+
+/*! Point sprite impostor shader for far cubes, draw instance data as GL_POINTS
+(instance attribute as vec4, xyz for world position, w for cube half size).
+Sprite is shaded as a cube seen from above (top and two side faces). */
+class impostor_shader
+{
+public:
+	impostor_shader();
+	void use();
+	int instance_location() const;
+
+	// setters
+	void model_color(vec3 const & rgb);
+	void light_direction(vec3 const & ldir);  // normalized vector
+	void world_to_screen(mat4 const & VP);
+	void point_scale(float pixels);  //!< size in pixels of the unit at unit depth
+
+private:
+	program _prog;
+	program::uniform_type _color_u,
+		_light_dir_u,
+		_world_to_screen_u,
+		_point_scale_u;
+	int _instance;
+};
+
+}  // gles2
@@ -0,0 +1,126 @@
+#include "glt/debug.hpp"
+#include "instanced_shaded_shader.hpp"
+
+namespace gles2 {
+
+constexpr char shader_program_code[] = R"(
+// #version 100
+#ifdef _VERTEX_
+attribute vec3 position;
+attribute vec3 normal;
+attribute vec4 instance;  // xyz world position, w scale
+attribute vec3 rotation_x;  // rotation matrix rows (local axes in world space)
+attribute vec3 rotation_y;
+attribute vec3 rotation_z;
+uniform mat4 world_to_screen;
+uniform vec3 highlight_position;
+uniform float highlight_amount;
+varying vec3 n;
+varying float highlighted;
+void main() {
+	// row vector times rotation, uniform scale so normal_to_world is rotation
+	vec3 p = position.x*rotation_x + position.y*rotation_y + position.z*rotation_z;
+	n = normal.x*rotation_x + normal.y*rotation_y + normal.z*rotation_z;
+	highlighted = (instance.xyz == highlight_position) ? highlight_amount : 0.0;  // same floats as uploaded
+	gl_Position = world_to_screen * vec4(instance.w * p + instance.xyz, 1.0);
+}
+#endif
+
+#ifdef _FRAGMENT_
+precision mediump float;
+uniform vec3 color;
+uniform vec3 light_direction;  // from surface to light in world space
+varying vec3 n;
+varying float highlighted;
+void main() {
+	vec3 c = mix(color, vec3(1.0, 0.9, 0.2), highlighted);
+	gl_FragColor = vec4(max(dot(n, light_direction), 0.2) * c, 1.0);
+}
+#endif
+)";
+
+instanced_shaded_shader::instanced_shaded_shader()
+{
+	_prog.from_memory(shader_program_code, 100);
+	glt::debug::label(glt::debug::object::program, _prog.id(), "instanced_shaded_shader");
+	_color_u = _prog.uniform_variable("color");
+	_light_dir_u = _prog.uniform_variable("light_direction");
+	_world_to_screen_u = _prog.uniform_variable("world_to_screen");
+	_highlight_position_u = _prog.uniform_variable("highlight_position");
+	_highlight_amount_u = _prog.uniform_variable("highlight_amount");
+	_position = _prog.attribute_location("position");
+	_normal = _prog.attribute_location("normal");
+	_instance = _prog.attribute_location("instance");
+	_rotation[0] = _prog.attribute_location("rotation_x");
+	_rotation[1] = _prog.attribute_location("rotation_y");
+	_rotation[2] = _prog.attribute_location("rotation_z");
+}
+
+void instanced_shaded_shader::use()
+{
+	if (!_prog.used())
+		_prog.use();
+}
+
+int instanced_shaded_shader::position_location() const
+{
+	return _position;
+}
+
+int instanced_shaded_shader::normal_location() const
+{
+	return _normal;
+}
+
+int instanced_shaded_shader::instance_location() const
+{
+	return _instance;
+}
+
+int instanced_shaded_shader::rotation_location(unsigned row) const
+{
+	return _rotation[row];
+}
+
+unsigned instanced_shaded_shader::attribute_mask(bool rotation) const
+{
+	unsigned mask = (1u << _position) | (1u << _normal) | (1u << _instance);
+	if (rotation)
+		mask |= (1u << _rotation[0]) | (1u << _rotation[1]) | (1u << _rotation[2]);
+	return mask;
+}
+
+void instanced_shaded_shader::identity_rotation()
+{
+	glVertexAttrib3f(_rotation[0], 1, 0, 0);
+	glVertexAttrib3f(_rotation[1], 0, 1, 0);
+	glVertexAttrib3f(_rotation[2], 0, 0, 1);
+}
+
+void instanced_shaded_shader::model_color(vec3 const & rgb)
+{
+	_color_u = rgb;
+}
+
+void instanced_shaded_shader::light_direction(vec3 const & ldir)
+{
+	_light_dir_u = ldir;
+}
+
+void instanced_shaded_shader::world_to_screen(mat4 const & VP)
+{
+	_world_to_screen_u = VP;
+}
+
+void instanced_shaded_shader::highlight(vec3 const & instance_position)
+{
+	_highlight_position_u = instance_position;
+	_highlight_amount_u = 1.0f;
+}
+
+void instanced_shaded_shader::no_highlight()
+{
+	_highlight_amount_u = 0.0f;
+}
+
+}  // gles2
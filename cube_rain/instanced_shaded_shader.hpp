@@ -0,0 +1,55 @@
+#pragma once
+#include "glt/gles2.hpp"
+#include "glt/program.hpp"
+#include "phys/matrices.h"
+
+namespace gles2 {
+
+using phys::vec3,
+	phys::mat4;
+
+using program = glt::shader::program<glt::shader::module<
+	glt::shader::gles2_shader_type>>;
+
+/*! Shader program with model color and diffuse lighting support for instanced
+drawing of uniformly scaled and rotated objects. Per instance data are read from
+instance attribute as vec4 (xyz for world position, w for scale) and rotation
+attributes as vec3 (rows of rotation matrix), set their divisor to 1. Without
+per instance rotation disable rotation attributes and call identity_rotation().
+Instance with position equal to highlight() position is drawn in highlight color.
+\note Needs instanced arrays support (see glt::context_features). */
+class instanced_shaded_shader
+{
+public:
+	instanced_shaded_shader();
+	void use();
+	int position_location() const;
+	int normal_location() const;
+	int instance_location() const;
+	int rotation_location(unsigned row) const;  //!< row from 0 to 2
+	unsigned attribute_mask(bool rotation) const;  //!< bit set for used attribute locations
+
+	//! constant identity rotation for disabled rotation attributes
+	void identity_rotation();
+
+	// setters
+	void model_color(vec3 const & rgb);
+	void light_direction(vec3 const & ldir);  // normalized vector
+	void world_to_screen(mat4 const & VP);
+	void highlight(vec3 const & instance_position);
+	void no_highlight();
+
+private:
+	program _prog;
+	program::uniform_type _color_u,
+		_light_dir_u,
+		_world_to_screen_u,
+		_highlight_position_u,
+		_highlight_amount_u;
+	int _position,
+		_normal,
+		_instance,
+		_rotation[3];
+};
+
+}  // gles2
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <string>
+#include "glt/cpu_profiler.hpp"
+#include "job_system.hpp"
+
+using std::max,
+	std::min,
+	std::move,
+	std::to_string;
+using std::mutex,
+	std::unique_lock,
+	std::lock_guard;
+
+job_system::job_system(unsigned workers)
+	: _quit{false}
+{
+	for (unsigned i = 0; i < workers; ++i)
+		_workers.emplace_back(&job_system::loop, this, i);
+}
+
+job_system::~job_system()
+{
+	{
+		lock_guard<mutex> lock{_locker};
+		_quit = true;
+	}
+	_job_cond.notify_all();
+
+	for (std::thread & t : _workers)
+		t.join();
+}
+
+void job_system::run(job_counter & counter, job j)
+{
+	counter._pending.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		lock_guard<mutex> lock{_locker};
+		_jobs.push_back(queued_job{move(j), &counter});
+	}
+	_job_cond.notify_one();
+}
+
+void job_system::wait(job_counter & counter)
+{
+	GLT_PROFILE_ZONE("job_system::wait");
+
+	while (!counter.done())
+	{
+		if (try_run_one())
+			continue;
+
+		// nothing to help with, wait for the rest of jobs to finish
+		unique_lock<mutex> lock{_locker};
+		_done_cond.wait(lock, [this, &counter]{return counter.done() || !_jobs.empty();});
+	}
+}
+
+void job_system::parallel_for(size_t count, size_t grain, range_job const & body)
+{
+	if (count == 0)
+		return;
+
+	size_t const chunks = min<size_t>(worker_count() + 1, (count + grain - 1) / max<size_t>(grain, 1)),
+		chunk_size = (count + chunks - 1) / chunks;
+
+	if (chunks <= 1)
+	{
+		body(0, count);
+		return;
+	}
+
+	job_counter counter;
+	for (size_t first = chunk_size; first < count; first += chunk_size)  // first chunk for calling thread
+		run(counter, [&body, first, last = min(first + chunk_size, count)]{body(first, last);});
+
+	body(0, chunk_size);
+	wait(counter);
+}
+
+unsigned job_system::worker_count() const
+{
+	return _workers.size();
+}
+
+unsigned job_system::default_worker_count()
+{
+	unsigned n = std::thread::hardware_concurrency();
+	return (n > 1) ? n - 1 : 1;
+}
+
+void job_system::loop(unsigned idx)
+{
+	std::string const name = "worker " + to_string(idx);
+	glt::profile::thread_name(name.c_str());
+
+	while (true)
+	{
+		queued_job j;
+		{
+			unique_lock<mutex> lock{_locker};
+			_job_cond.wait(lock, [this]{return _quit || !_jobs.empty();});
+			if (_quit)
+				return;
+
+			j = move(_jobs.front());
+			_jobs.pop_front();
+		}
+
+		execute(j);
+	}
+}
+
+bool job_system::try_run_one()
+{
+	queued_job j;
+	{
+		lock_guard<mutex> lock{_locker};
+		if (_jobs.empty())
+			return false;
+
+		j = move(_jobs.front());
+		_jobs.pop_front();
+	}
+
+	execute(j);
+	return true;
+}
+
+void job_system::execute(queued_job & j)
+{
+	j.task();
+
+	if (j.counter->_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		lock_guard<mutex> lock{_locker};  // do not miss waiting thread
+		_done_cond.notify_all();
+	}
+}
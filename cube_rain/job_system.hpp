@@ -0,0 +1,71 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//! Counts unfinished jobs, see job_system::run() and job_system::wait().
+class job_counter
+{
+public:
+	job_counter() : _pending{0} {}
+	bool done() const {return _pending.load(std::memory_order_acquire) == 0;}
+
+private:
+	std::atomic<unsigned> _pending;
+	friend class job_system;
+};
+
+/*! Worker threads pool executing jobs from a shared queue.
+
+\code
+job_system jobs;
+job_counter sim;
+jobs.run(sim, []{simulate();});
+// ... other work
+jobs.wait(sim);  // calling thread helps with queued jobs while waiting
+jobs.parallel_for(n, 256, [&](size_t first, size_t last){...});
+\endcode */
+class job_system
+{
+public:
+	using job = std::function<void ()>;
+	using range_job = std::function<void (size_t first, size_t last)>;
+
+	explicit job_system(unsigned workers = default_worker_count());
+	~job_system();
+
+	void run(job_counter & counter, job j);
+	void wait(job_counter & counter);
+
+	/*! Splits [0, count) range into chunks of at least grain elements and
+	executes body for each chunk in parallel, returns after all chunks are done. */
+	void parallel_for(size_t count, size_t grain, range_job const & body);
+
+	unsigned worker_count() const;
+	static unsigned default_worker_count();  //!< hardware threads - 1 (at least 1)
+
+	job_system(job_system const &) = delete;
+	void operator=(job_system const &) = delete;
+
+private:
+	struct queued_job
+	{
+		job task;
+		job_counter * counter;
+	};
+
+	void loop(unsigned idx);
+	bool try_run_one();  //!< \return false if queue was empty
+	void execute(queued_job & j);
+
+	std::vector<std::thread> _workers;
+	std::deque<queued_job> _jobs;
+	std::mutex _locker;
+	std::condition_variable _job_cond,  //!< new job or quit
+		_done_cond;  //!< some counter reached zero
+	bool _quit;
+};
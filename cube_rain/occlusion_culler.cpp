@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+#include "glt/cpu_profiler.hpp"
+#include "occlusion_culler.hpp"
+
+using std::min,
+	std::max,
+	std::fill,
+	std::floor,
+	std::ceil;
+using phys::vec3,
+	phys::mat4,
+	phys::simd_vec4,
+	phys::simd_mat4;
+
+constexpr float min_w = 1e-3f;  // closer points are treated as crossing near plane
+
+// box triangles (corner indices, corner i has x from bit 0, y from bit 1, z from bit 2)
+constexpr unsigned box_indices[12*3] = {
+	0,1,3, 0,3,2,  // -z
+	4,6,7, 4,7,5,  // +z
+	0,2,6, 0,6,4,  // -x
+	1,5,7, 1,7,3,  // +x
+	0,4,5, 0,5,1,  // -y
+	2,3,7, 2,7,6  // +y
+};
+
+occlusion_culler::occlusion_culler()
+{
+	for (unsigned l = 0; l < levels; ++l)
+		_levels[l].resize((width >> l) * (height >> l));
+}
+
+void occlusion_culler::begin(mat4 const & world_to_screen)
+{
+	_world_to_screen = simd_mat4{world_to_screen};
+	fill(_levels[0].begin(), _levels[0].end(), 1.0f);  // far
+}
+
+void occlusion_culler::draw_occluder(box const & b)
+{
+	screen_vertex corners[8];
+	if (project(b, corners) < 8)
+		return;
+
+	for (unsigned i = 0; i < 12*3; i += 3)
+		draw_triangle(corners[box_indices[i]], corners[box_indices[i+1]], corners[box_indices[i+2]]);
+}
+
+void occlusion_culler::build_hiz()
+{
+	GLT_PROFILE_ZONE("occlusion_culler::build_hiz");
+
+	for (unsigned l = 1; l < levels; ++l)
+	{
+		float const * src = _levels[l-1].data();
+		float * dst = _levels[l].data();
+		unsigned const w = width >> l,
+			h = height >> l,
+			src_w = w*2;
+
+		for (unsigned y = 0; y < h; ++y)
+		{
+			float const * row0 = src + (2*y)*src_w,
+				* row1 = row0 + src_w;
+
+			for (unsigned x = 0; x < w; ++x)
+				dst[y*w + x] = max(max(row0[2*x], row0[2*x+1]), max(row1[2*x], row1[2*x+1]));
+		}
+	}
+}
+
+bool occlusion_culler::visible(box const & b) const
+{
+	screen_vertex corners[8];
+	unsigned const in_front = project(b, corners);
+	if (in_front == 0)
+		return false;  // behind camera
+	else if (in_front < 8)
+		return true;  // crosses near plane
+
+	float x0 = corners[0].x, x1 = x0,
+		y0 = corners[0].y, y1 = y0,
+		z = corners[0].z;
+
+	for (screen_vertex const & c : corners)
+	{
+		x0 = min(x0, c.x);
+		x1 = max(x1, c.x);
+		y0 = min(y0, c.y);
+		y1 = max(y1, c.y);
+		z = min(z, c.z);
+	}
+
+	if (x1 < 0 || y1 < 0 || x0 >= width || y0 >= height || z > 1)
+		return false;  // outside of view frustum
+
+	// pixels touched by the rectangle
+	int const px0 = max(0, (int)floor(x0)),
+		py0 = max(0, (int)floor(y0)),
+		px1 = min((int)width - 1, (int)floor(x1)),
+		py1 = min((int)height - 1, (int)floor(y1));
+
+	// level where rectangle spans just a few texels
+	unsigned l = 0;
+	while (l+1 < levels && ((px1 - px0) >> l) > 4 && ((py1 - py0) >> l) > 4)
+		++l;
+
+	unsigned const w = width >> l;
+	float const * hiz = _levels[l].data();
+	for (int y = py0 >> l; y <= (py1 >> l); ++y)
+		for (int x = px0 >> l; x <= (px1 >> l); ++x)
+			if (z <= hiz[y*w + x])
+				return true;
+
+	return false;
+}
+
+float const * occlusion_culler::depth(unsigned level) const
+{
+	return _levels[level].data();
+}
+
+unsigned occlusion_culler::project(box const & b, screen_vertex corners[8]) const
+{
+	simd_mat4 const & M = _world_to_screen;
+	unsigned in_front = 0;
+
+	// row vector times matrix, corners share min/max coordinate times row products
+	simd_vec4 const xs[2] = {b.min.x * M.row[0], b.max.x * M.row[0]},
+		ys[2] = {b.min.y * M.row[1], b.max.y * M.row[1]},
+		zs[2] = {b.min.z * M.row[2] + M.row[3], b.max.z * M.row[2] + M.row[3]};
+
+	for (unsigned i = 0; i < 8; ++i)
+	{
+		alignas(16) float clip[4];
+		(xs[i & 1] + ys[(i >> 1) & 1] + zs[i >> 2]).Store(clip);
+		float const x = clip[0],
+			y = clip[1],
+			z = clip[2],
+			w = clip[3];
+
+		if (w < min_w)
+			continue;
+
+		float const rw = 1.0f / w;
+		corners[in_front++] = screen_vertex{
+			(x*rw*0.5f + 0.5f) * width,
+			(y*rw*0.5f + 0.5f) * height,
+			z*rw};
+	}
+
+	return in_front;
+}
+
+/* Edge function rasterizer, pixel is covered if its center is inside of the
+triangle. Depth (z/w) is linear in screen space, so it is interpolated by a
+plane equation. Rows are processed 4 pixels at once (SSE2). */
+void occlusion_culler::draw_triangle(screen_vertex const & v0, screen_vertex const & v1,
+	screen_vertex const & v2)
+{
+	float area = (v1.x - v0.x)*(v2.y - v0.y) - (v1.y - v0.y)*(v2.x - v0.x);
+	if (area == 0)
+		return;
+
+	// edge i is opposite to vertex i, e(x,y) = a*x + b*y + c, positive inside
+	float const sign = (area > 0) ? 1.0f : -1.0f;
+	float a[3] = {
+		sign*(v1.y - v2.y), sign*(v2.y - v0.y), sign*(v0.y - v1.y)};
+	float b[3] = {
+		sign*(v2.x - v1.x), sign*(v0.x - v2.x), sign*(v1.x - v0.x)};
+	float c[3] = {
+		sign*(v1.x*v2.y - v2.x*v1.y),
+		sign*(v2.x*v0.y - v0.x*v2.y),
+		sign*(v0.x*v1.y - v1.x*v0.y)};
+
+	// z = z0 + dzdx*(x - v0.x) + dzdy*(y - v0.y)
+	area = sign*area;
+	float const dzdx = (a[0]*v0.z + a[1]*v1.z + a[2]*v2.z) / area,
+		dzdy = (b[0]*v0.z + b[1]*v1.z + b[2]*v2.z) / area,
+		z0 = v0.z - dzdx*v0.x - dzdy*v0.y;
+
+	int const x0 = max(0, (int)floor(min({v0.x, v1.x, v2.x}))) & ~3,  // 4 pixel aligned
+		y0 = max(0, (int)floor(min({v0.y, v1.y, v2.y}))),
+		x1 = min((int)width - 1, (int)ceil(max({v0.x, v1.x, v2.x}))),
+		y1 = min((int)height - 1, (int)ceil(max({v0.y, v1.y, v2.y})));
+
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	float * depth = _levels[0].data();
+
+#ifdef __SSE2__
+	__m128 const ax[3] = {_mm_set1_ps(a[0]), _mm_set1_ps(a[1]), _mm_set1_ps(a[2])},
+		step[3] = {_mm_set1_ps(4*a[0]), _mm_set1_ps(4*a[1]), _mm_set1_ps(4*a[2])},
+		offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f),  // pixel centers
+		zero = _mm_setzero_ps(),
+		dzdx4 = _mm_set1_ps(dzdx),
+		zstep = _mm_set1_ps(4*dzdx);
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		float const py = y + 0.5f;
+		__m128 const px = _mm_add_ps(_mm_set1_ps((float)x0), offsets);
+		__m128 e[3];
+		for (unsigned i = 0; i < 3; ++i)
+			e[i] = _mm_add_ps(_mm_mul_ps(ax[i], px), _mm_set1_ps(b[i]*py + c[i]));
+		__m128 z = _mm_add_ps(_mm_mul_ps(dzdx4, px), _mm_set1_ps(z0 + dzdy*py));
+
+		float * row = depth + y*width;
+		for (int x = x0; x <= x1; x += 4)
+		{
+			__m128 inside = _mm_and_ps(_mm_and_ps(
+				_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)), _mm_cmpge_ps(e[2], zero));
+
+			if (_mm_movemask_ps(inside))
+			{
+				__m128 d = _mm_loadu_ps(row + x);
+				__m128 nearer = _mm_and_ps(inside, _mm_cmplt_ps(z, d));
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(nearer, z), _mm_andnot_ps(nearer, d)));
+			}
+
+			for (unsigned i = 0; i < 3; ++i)
+				e[i] = _mm_add_ps(e[i], step[i]);
+			z = _mm_add_ps(z, zstep);
+		}
+	}
+#else
+	for (int y = y0; y <= y1; ++y)
+	{
+		float const py = y + 0.5f;
+		float * row = depth + y*width;
+		for (int x = x0; x <= x1; ++x)
+		{
+			float const px = x + 0.5f;
+			if (a[0]*px + b[0]*py + c[0] >= 0 && a[1]*px + b[1]*py + c[1] >= 0
+				&& a[2]*px + b[2]*py + c[2] >= 0)
+			{
+				float const z = z0 + dzdx*px + dzdy*py;
+				row[x] = min(row[x], z);
+			}
+		}
+	}
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "phys/simd.h"
+
+/*! Software occlusion culler with hierarchical (max) depth buffer.
+
+Occluders (nearest objects) are rasterized on CPU into a low resolution depth
+buffer, then max depth pyramid (HiZ) is built and object bounding boxes are
+tested against it by their screen rectangle and nearest depth. Boxes outside
+of the screen are culled as well.
+
+\code
+occlusion_culler c;
+c.begin(world_to_screen);
+for (auto & b : occluders)
+	c.draw_occluder(b);
+c.build_hiz();
+bool v = c.visible(b);
+\endcode
+\note visible() can be called from more threads at once, the rest not. */
+class occlusion_culler
+{
+public:
+	static constexpr unsigned width = 256,
+		height = 128,
+		levels = 5;  //!< HiZ levels (level 0 is depth buffer)
+
+	struct box  //!< world space axis aligned box
+	{
+		phys::vec3 min, max;
+	};
+
+	occlusion_culler();
+	void begin(phys::mat4 const & world_to_screen);  //!< clears depth buffer
+	void draw_occluder(box const & b);  //!< \note occluders crossing near plane are skipped
+	void build_hiz();
+	bool visible(box const & b) const;  //!< \note call after build_hiz()
+
+	float const * depth(unsigned level = 0) const;  //!< NDC depth (0 near, 1 far), row by row
+
+private:
+	struct screen_vertex  //!< x, y in pixels, z NDC depth
+	{
+		float x, y, z;
+	};
+
+	unsigned project(box const & b, screen_vertex corners[8]) const;  //!< \return number of corners in front of near plane
+	void draw_triangle(screen_vertex const & v0, screen_vertex const & v1, screen_vertex const & v2);
+
+	phys::simd_mat4 _world_to_screen;
+	std::vector<float> _levels[levels];
+};
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include "glt/cpu_profiler.hpp"
+#include "parallel_sort.hpp"
+
+using std::vector,
+	std::min;
+
+constexpr size_t min_chunk_size = 1024;  // below there is no point to split the work
+
+void parallel_radix_sort(job_system & jobs, vector<sort_item> & items,
+	vector<sort_item> & temp, unsigned key_bits)
+{
+	GLT_PROFILE_ZONE("parallel_radix_sort");
+
+	size_t const n = items.size();
+	temp.resize(n);
+
+	size_t const chunks = min<size_t>(jobs.worker_count() + 1, (n + min_chunk_size - 1) / min_chunk_size);
+	if (chunks == 0)
+		return;
+
+	size_t const chunk_size = (n + chunks - 1) / chunks;
+	vector<size_t> offsets(chunks * 256);  // offsets[digit*chunks + chunk] to keep scatter stable
+
+	for (unsigned shift = 0; shift < key_bits; shift += 8)
+	{
+		// per chunk histograms
+		std::fill(begin(offsets), end(offsets), 0);
+		jobs.parallel_for(chunks, 1, [&](size_t first, size_t last){
+			for (size_t c = first; c < last; ++c)
+			{
+				size_t const end = min(n, (c+1) * chunk_size);
+				for (size_t i = c * chunk_size; i < end; ++i)
+					++offsets[((items[i].key >> shift) & 0xff) * chunks + c];
+			}
+		});
+
+		// all keys share the digit, nothing to do in this pass
+		uint32_t const digit = (items[0].key >> shift) & 0xff;
+		size_t same = 0;
+		for (size_t c = 0; c < chunks; ++c)
+			same += offsets[digit * chunks + c];
+		if (same == n)
+			continue;
+
+		size_t sum = 0;
+		for (size_t & o : offsets)
+		{
+			size_t count = o;
+			o = sum;
+			sum += count;
+		}
+
+		jobs.parallel_for(chunks, 1, [&](size_t first, size_t last){
+			for (size_t c = first; c < last; ++c)
+			{
+				size_t const end = min(n, (c+1) * chunk_size);
+				for (size_t i = c * chunk_size; i < end; ++i)
+					temp[offsets[((items[i].key >> shift) & 0xff) * chunks + c]++] = items[i];
+			}
+		});
+
+		items.swap(temp);
+	}
+}
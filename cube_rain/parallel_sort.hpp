@@ -0,0 +1,17 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "job_system.hpp"
+
+struct sort_item
+{
+	uint32_t key,
+		index;  //!< payload (e.g. index of sorted object)
+};
+
+/*! Stable LSD radix sort (8 bits per pass) of items by key. Each pass builds
+per chunk histograms and scatters chunks in parallel.
+\param key_bits only the lowest key_bits of key are sorted (e.g. 16 for quantized depth)
+\param temp memory reused between calls */
+void parallel_radix_sort(job_system & jobs, std::vector<sort_item> & items,
+	std::vector<sort_item> & temp, unsigned key_bits = 32);
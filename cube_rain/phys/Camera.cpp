@@ -16,9 +16,10 @@ Camera::Camera() {
 	m_matWorld = mat4();
 	m_matProj = Projection(m_nFov, m_nAspect, m_nNear, m_nFar);
 	m_nProjectionMode = 0;
+	m_bDirty = true;
 }
 
-mat4 Camera::GetWorldMatrix() {
+const mat4& Camera::GetWorldMatrix() const {
 	return m_matWorld;
 	/*mat3 r = Rotation3x3(rotation.x, rotation.y, rotation.z);
 
@@ -33,7 +34,7 @@ mat4 Camera::GetWorldMatrix() {
 	);*/
 }
 
-bool Camera::IsOrthoNormal() {
+bool Camera::IsOrthoNormal() const {
 	vec3 right = vec3(m_matWorld._11, m_matWorld._12, m_matWorld._13);
 	vec3 up = vec3(m_matWorld._21, m_matWorld._22, m_matWorld._23);
 	vec3 forward = vec3(m_matWorld._31, m_matWorld._32, m_matWorld._33);
@@ -90,37 +91,70 @@ void Camera::OrthoNormalize() {
 		f.x, f.y, f.z, 0.0f,
 		m_matWorld._41, m_matWorld._42, m_matWorld._43, 1.0f
 	);
+	m_bDirty = true;
 }
 
-mat4 Camera::GetViewMatrix() {
-	//return Inverse(m_matWorld);
-
-	if (!IsOrthoNormal()) {
-		OrthoNormalize();
+void Camera::UpdateMatrices() const {
+	if (!m_bDirty) {
+		return;
 	}
 
-	mat4 inverse = Transpose(m_matWorld);
-	inverse._41 = inverse._14 = 0.0f;
-	inverse._42 = inverse._24 = 0.0f;
-	inverse._43 = inverse._34 = 0.0f;
+	// world is kept orthonormal by SetWorld(), so view is a fast rigid inverse
+	m_matView = RigidInverse(m_matWorld);
+	m_matViewProj = m_matView * m_matProj;
+	// far away cameras with a close near plane lose most float digits in the inverse
+	m_matInvViewProj = mat4(Inverse(dmat4(m_matViewProj)));
+	m_bDirty = false;
+}
 
-	vec3 right = vec3(m_matWorld._11, m_matWorld._12, m_matWorld._13);
-	vec3 up = vec3(m_matWorld._21, m_matWorld._22, m_matWorld._23);
-	vec3 forward = vec3(m_matWorld._31, m_matWorld._32, m_matWorld._33);
-	vec3 position = vec3(m_matWorld._41, m_matWorld._42, m_matWorld._43);
+const mat4& Camera::GetViewMatrix() const {
+	UpdateMatrices();
+	return m_matView;
+}
+
+const mat4& Camera::GetViewProjectionMatrix() const {
+	UpdateMatrices();
+	return m_matViewProj;
+}
+
+const mat4& Camera::GetInverseViewProjectionMatrix() const {
+	UpdateMatrices();
+	return m_matInvViewProj;
+}
+
+vec3 Camera::Unproject(const vec3& viewportPoint, const vec2& viewportSize) const {
+	// NDC, viewport y goes down
+	float x = viewportPoint.x / viewportSize.x * 2.0f - 1.0f;
+	float y = 1.0f - viewportPoint.y / viewportSize.y * 2.0f;
+	float z = viewportPoint.z;
+
+	// row vector (x, y, z, 1) times inverse view projection
+	const mat4& m = GetInverseViewProjectionMatrix();
+	vec3 world(
+		x * m._11 + y * m._21 + z * m._31 + m._41,
+		x * m._12 + y * m._22 + z * m._32 + m._42,
+		x * m._13 + y * m._23 + z * m._33 + m._43
+	);
+	float w = x * m._14 + y * m._24 + z * m._34 + m._44;
 
-	inverse._41 = -Dot(right, position);
-	inverse._42 = -Dot(up, position);
-	inverse._43 = -Dot(forward, position);
+	return world * (1.0f / w);
+}
 
-	return inverse;
+Ray Camera::GetPickRay(const vec2& viewportPoint, const vec2& viewportSize) const {
+	vec3 nearPoint = Unproject(vec3(viewportPoint.x, viewportPoint.y, 0.0f), viewportSize);
+	vec3 farPoint = Unproject(vec3(viewportPoint.x, viewportPoint.y, 1.0f), viewportSize);
+	return FromPoints(nearPoint, farPoint);
 }
 
-float Camera::GetAspect() {
+float Camera::GetAspect() const {
 	return m_nAspect;
 }
 
-mat4 Camera::GetProjectionMatrix() {
+float Camera::GetFov() const {
+	return m_nFov;
+}
+
+const mat4& Camera::GetProjectionMatrix() const {
 	return m_matProj;
 }
 
@@ -141,13 +175,15 @@ void Camera::Resize(int width, int height) {
 	}
 	// m_nProjectionMode == 2
 		// User defined
+
+	m_bDirty = true;
 }
 
-bool Camera::IsOrthographic() {
+bool Camera::IsOrthographic() const {
 	return m_nProjectionMode == 1;
 }
 
-bool Camera::IsPerspective() {
+bool Camera::IsPerspective() const {
 	return m_nProjectionMode == 0;
 }
 
@@ -159,6 +195,7 @@ void Camera::Perspective(float fov, float aspect, float zNear, float zFar) {
 
 	m_matProj = Projection(fov, aspect, zNear, zFar);
 	m_nProjectionMode = 0;
+	m_bDirty = true;
 }
 
 void Camera::Orthographic(float width, float height, float zNear, float zFar) {
@@ -172,15 +209,21 @@ void Camera::Orthographic(float width, float height, float zNear, float zFar) {
 
 	m_matProj = Ortho(-halfW, halfW, halfH, -halfH, zNear, zFar);
 	m_nProjectionMode = 1;
+	m_bDirty = true;
 }
 
 void Camera::SetProjection(const mat4& projection) {
 	m_matProj = projection;
 	m_nProjectionMode = 2;
+	m_bDirty = true;
 }
 
 void Camera::SetWorld(const mat4& view) {
 	m_matWorld = view;
+	if (!IsOrthoNormal()) {
+		OrthoNormalize();
+	}
+	m_bDirty = true;
 }
 
 Camera CreatePerspective(float fieldOfView, float aspectRatio, float nearPlane, float farPlane) {
@@ -204,6 +247,7 @@ OrbitCamera::OrbitCamera() {
 	zoomDistanceLimit = vec2(3.0f, 15.0f);
 	currentRotation = vec2(0, 0);
 	panSpeed = vec2(180.0f, 180.0f);
+	orbitChanged = true;
 }
 
 void OrbitCamera::Rotate(const vec2& deltaRot, float deltaTime) {
@@ -212,6 +256,7 @@ void OrbitCamera::Rotate(const vec2& deltaRot, float deltaTime) {
 
 	currentRotation.x = ClampAngle(currentRotation.x, -360, 360);
 	currentRotation.y = ClampAngle(currentRotation.y, yRotationLimit.x, yRotationLimit.y);
+	orbitChanged = true;
 }
 
 void OrbitCamera::Zoom(float deltaZoom, float deltaTime) {
@@ -222,15 +267,17 @@ void OrbitCamera::Zoom(float deltaZoom, float deltaTime) {
 	if (zoomDistance > zoomDistanceLimit.y) {
 		zoomDistance = zoomDistanceLimit.y;
 	}
+	orbitChanged = true;
 }
 
 void OrbitCamera::Pan(const vec2& delataPan, float deltaTime) {
 	vec3 right(m_matWorld._11, m_matWorld._12, m_matWorld._13);
 
 	// Pan X axis in local space
-	target = target - (right * (delataPan.x * panSpeed.x * deltaTime));
+	target = Madd(right, -delataPan.x * panSpeed.x * deltaTime, target);
 	// Pan Y Axis in global space
-	target = target + (vec3(0, 1, 0) * (delataPan.y * panSpeed.y * deltaTime));
+	target.y = Madd(delataPan.y, panSpeed.y * deltaTime, target.y);
+	orbitChanged = true;
 
 	// Reset zoom to allow infinate zooming after a motion
 	// This part of the code is not in the book!
@@ -244,20 +291,20 @@ void OrbitCamera::Pan(const vec2& delataPan, float deltaTime) {
 }
 
 void OrbitCamera::Update(float dt) {
+	if (!orbitChanged) {
+		return;
+	}
+
 	vec3 rotation = vec3(currentRotation.y, currentRotation.x, 0);
 	mat3 orient = Rotation3x3(rotation.x, rotation.y, rotation.z);
 	vec3 dir = MultiplyVector( vec3(0.0, 0.0, -zoomDistance), orient);
 	vec3 position = /*rotation * vec3(0.0, 0.0, -distance)*/dir + target;
-	m_matWorld = FastInverse(LookAt(position, target, vec3(0, 1, 0)));
+	SetWorld(Inverse(TaggedLookAt(position, target, vec3(0, 1, 0))).matrix);
+	orbitChanged = false;
 }
 
 float OrbitCamera::ClampAngle(float angle, float min, float max) {
-	while (angle < -360) {
-		angle += 360;
-	}
-	while (angle > 360) {
-		angle -= 360;
-	}
+	angle = CorrectDegrees(angle);
 	if (angle < min) {
 		angle = min;
 	}
@@ -275,14 +322,19 @@ void OrbitCamera::PrintDebug() {
 
 void OrbitCamera::SetTarget(const vec3& newTarget) {
 	target = newTarget;
+	orbitChanged = true;
 }
 
 void OrbitCamera::SetZoom(float zoom) {
-	zoomDistance = zoom;
+	if (zoom != zoomDistance) { // called every frame
+		zoomDistance = zoom;
+		orbitChanged = true;
+	}
 }
 
 void OrbitCamera::SetRotation(const vec2& rotation) {
 	currentRotation = rotation;
+	orbitChanged = true;
 }
 
 }  // phys
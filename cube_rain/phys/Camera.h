@@ -2,6 +2,7 @@
 #define _H_CAMERA_
 
 #include "matrices.h"
+#include "collision.h"
 
 namespace phys {
 
@@ -18,20 +19,37 @@ protected:
 	// View Transform = Inverse(World Transform)
 	mat4 m_matProj;
 	int m_nProjectionMode; // 0 - Perspective, 1 - Ortho, 2 - User
+
+	// Matrices derived from world and projection are cached, they are rebuilt
+	// on the first access after a change (not thread safe).
+	mutable mat4 m_matView;
+	mutable mat4 m_matViewProj;
+	mutable mat4 m_matInvViewProj;
+	mutable bool m_bDirty;
+
+	void UpdateMatrices() const;
 public:
 	Camera();
 	// Default copy constructor / assignment operator will do!
 	inline virtual ~Camera() { }
 
-	mat4 GetWorldMatrix();
-	mat4 GetViewMatrix(); // Inverse of world!
-	mat4 GetProjectionMatrix();
+	const mat4& GetWorldMatrix() const;
+	const mat4& GetViewMatrix() const; // Inverse of world!
+	const mat4& GetProjectionMatrix() const;
+	const mat4& GetViewProjectionMatrix() const; // View * Projection
+	const mat4& GetInverseViewProjectionMatrix() const; // clip space to world space
+
+	// Viewport point (pixels from top left corner, z from 0 on near to 1 on far
+	// plane) to world space
+	vec3 Unproject(const vec3& viewportPoint, const vec2& viewportSize) const;
+	Ray GetPickRay(const vec2& viewportPoint, const vec2& viewportSize) const;
 
-	float GetAspect();
-	bool IsOrthographic();
-	bool IsPerspective();
+	float GetAspect() const;
+	float GetFov() const; // vertical field of view in degrees (perspective only)
+	bool IsOrthographic() const;
+	bool IsPerspective() const;
 
-	bool IsOrthoNormal();
+	bool IsOrthoNormal() const;
 	void OrthoNormalize();
 
 	void Resize(int width, int height);
@@ -58,6 +76,7 @@ protected:
 	vec2 rotationSpeed;
 	vec2 yRotationLimit; // x = min, y = max
 	vec2 currentRotation;
+	bool orbitChanged; // world matrix needs to be updated by Update()
 public:
 	OrbitCamera();
 	inline virtual ~OrbitCamera() { }
@@ -66,7 +85,7 @@ public:
 	void Zoom(float deltaZoom, float deltaTime);
 	void Pan(const vec2& delataPan, float deltaTime);
 
-	void Update(float dt);
+	void Update(float dt); // nothing to do if orbit has not changed
 	float ClampAngle(float angle, float min, float max);
 
 	void SetTarget(const vec3& newTarget);
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cfloat>
 #include <stdint.h>
+#include <limits>
 
 namespace phys {
 
@@ -88,9 +89,23 @@ inline bool AlmostEqualRelativeAndAbs(float A, float B, float maxDiff, float max
 	return false;
 }
 
+// AlmostEqualRelativeAndAbs for any floating point type
+template <typename T>
+inline bool ApproxEqual(T A, T B, T maxDiff, T maxRelDiff = std::numeric_limits<T>::epsilon()) {
+	T diff = std::abs(A - B);
+	if (diff <= maxDiff) {
+		return true;
+	}
+
+	A = std::abs(A);
+	B = std::abs(B);
+	T largest = (B > A) ? B : A;
+	return diff <= largest * maxRelDiff;
+}
+
 #define CMP(x, y) \
 	AlmostEqualRelativeAndAbs(x, y, 0.005f)
 
-#endif
-
 }  // phys
+
+#endif
@@ -0,0 +1,139 @@
+#include "angles.h"
+#include <cmath>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
+
+namespace phys {
+
+radians Wrap(radians angle) {
+	return radians(std::remainder(angle.value, TWO_PI));
+}
+
+degrees Wrap(degrees angle) {
+	return degrees(std::remainder(angle.value, 360.0f));
+}
+
+float CorrectDegrees(float degrees) {
+	return std::fmod(degrees, 360.0f);
+}
+
+#ifndef RAD2DEG
+float RAD2DEG(float radians) {
+	float degrees = radians * 57.295754f;
+	degrees = CorrectDegrees(degrees);
+	return degrees;
+}
+#endif
+#ifndef DEG2RAD
+float DEG2RAD(float degrees) {
+	degrees = CorrectDegrees(degrees);
+	float radians = degrees * 0.0174533f;
+	return radians;
+}
+#endif
+
+/* Angle is reduced to r in [-PI/4, PI/4] by the nearest multiple q of PI/2
+(PI/2 split in three parts so q * part is exact), then
+
+q % 4 | sin | cos
+    0 |  s  |  c
+    1 |  c  | -s
+    2 | -s  | -c
+    3 | -c  |  s
+
+where s, c are minimax polynomials of r (Cephes sinf/cosf). */
+constexpr float TWO_OVER_PI = 0.636619772367581343f,
+	PI_2_A = 1.5703125f,
+	PI_2_B = 4.837512969970703125e-4f,
+	PI_2_C = 7.54978995489188216e-8f;
+
+constexpr float S1 = -1.6666654611e-1f,
+	S2 = 8.3321608736e-3f,
+	S3 = -1.9515295891e-4f,
+	C1 = 4.166664568298827e-2f,
+	C2 = -1.388731625493765e-3f,
+	C3 = 2.443315711809948e-5f;
+
+void SinCos(radians angle, float& s, float& c) {
+	float const q = std::nearbyint(angle.value * TWO_OVER_PI),
+		r = ((angle.value - q * PI_2_A) - q * PI_2_B) - q * PI_2_C,
+		r2 = r * r,
+		ps = r + r * r2 * (S1 + r2 * (S2 + r2 * S3)),
+		pc = 1.0f - 0.5f * r2 + r2 * r2 * (C1 + r2 * (C2 + r2 * C3));
+
+	int const quadrant = int(q) & 3;
+	float const sin_r = (quadrant & 1) ? pc : ps,
+		cos_r = (quadrant & 1) ? ps : pc;
+	s = (quadrant & 2) ? -sin_r : sin_r;
+	c = ((quadrant + 1) & 2) ? -cos_r : cos_r;
+}
+
+void SinCos(radians angle, double& s, double& c) {
+	s = std::sin(double(angle.value));
+	c = std::cos(double(angle.value));
+}
+
+#ifdef __SSE2__
+static inline void SinCos4(__m128 x, __m128& s, __m128& c) {
+	__m128i const q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));  // round to nearest
+	__m128 const qf = _mm_cvtepi32_ps(q);
+
+	__m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(PI_2_A)));
+	r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PI_2_B)));
+	r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(PI_2_C)));
+	__m128 const r2 = _mm_mul_ps(r, r);
+
+	__m128 ps = _mm_add_ps(_mm_set1_ps(S2), _mm_mul_ps(r2, _mm_set1_ps(S3)));
+	ps = _mm_add_ps(_mm_set1_ps(S1), _mm_mul_ps(r2, ps));
+	ps = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), ps));
+
+	__m128 pc = _mm_add_ps(_mm_set1_ps(C2), _mm_mul_ps(r2, _mm_set1_ps(C3)));
+	pc = _mm_add_ps(_mm_set1_ps(C1), _mm_mul_ps(r2, pc));
+	pc = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+		_mm_mul_ps(_mm_mul_ps(r2, r2), pc));
+
+	// odd quadrants swap, sign bits from quadrant bits
+	__m128 const swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1))),
+		sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30)),
+		cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+	__m128 const sin_r = _mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps)),
+		cos_r = _mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc));
+
+	s = _mm_xor_ps(sin_r, sin_sign);
+	c = _mm_xor_ps(cos_r, cos_sign);
+}
+#endif
+
+void SinCos(const float* angles, float* s, float* c, size_t count) {
+	size_t i = 0;
+#ifdef __SSE2__
+	__m128 sv, cv;
+	for (; i + 4 <= count; i += 4) {
+		SinCos4(_mm_loadu_ps(angles + i), sv, cv);
+		_mm_storeu_ps(s + i, sv);
+		_mm_storeu_ps(c + i, cv);
+	}
+
+	if (i < count) {  // the rest padded to 4
+		alignas(16) float a[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, st[4], ct[4];
+		for (size_t j = i; j < count; ++j) {
+			a[j - i] = angles[j];
+		}
+		SinCos4(_mm_load_ps(a), sv, cv);
+		_mm_store_ps(st, sv);
+		_mm_store_ps(ct, cv);
+		for (size_t j = i; j < count; ++j) {
+			s[j] = st[j - i];
+			c[j] = ct[j - i];
+		}
+	}
+#else
+	for (; i < count; ++i) {
+		SinCos(radians(angles[i]), s[i], c[i]);
+	}
+#endif
+}
+
+}  // phys
@@ -0,0 +1,98 @@
+#ifndef _H_MATH_ANGLES_
+#define _H_MATH_ANGLES_
+
+#include <cstddef>
+
+namespace phys {
+
+/*
+Angles!
+Plain float parameters (XRotation(), AxisAngle(), ...) are in degrees,
+radians and degrees types make the unit explicit and convert between each
+other implicitly:
+
+radians r = 90.0_deg;
+float s = sinf(Wrap(accumulated).value);
+
+Range reduction is a single fmod/remainder (constant time), so angles that
+keep growing (animation, orbiting) do not make it slower.
+*/
+
+constexpr float PI = 3.14159265358979323846f;
+constexpr float TWO_PI = 2.0f * PI;
+
+struct degrees;
+
+typedef struct radians {
+	float value;
+
+	constexpr radians() : value(0.0f) { }
+	constexpr explicit radians(float v) : value(v) { }
+	constexpr radians(degrees d);
+} radians;
+
+typedef struct degrees {
+	float value;
+
+	constexpr degrees() : value(0.0f) { }
+	constexpr explicit degrees(float v) : value(v) { }
+	constexpr degrees(radians r) : value(r.value * (180.0f / PI)) { }
+} degrees;
+
+constexpr radians::radians(degrees d) : value(d.value * (PI / 180.0f)) { }
+
+constexpr radians operator+(radians l, radians r) { return radians(l.value + r.value); }
+constexpr radians operator-(radians l, radians r) { return radians(l.value - r.value); }
+constexpr radians operator-(radians a) { return radians(-a.value); }
+constexpr radians operator*(radians a, float s) { return radians(a.value * s); }
+constexpr radians operator/(radians a, float s) { return radians(a.value / s); }
+constexpr bool operator<(radians l, radians r) { return l.value < r.value; }
+constexpr bool operator>(radians l, radians r) { return l.value > r.value; }
+
+constexpr degrees operator+(degrees l, degrees r) { return degrees(l.value + r.value); }
+constexpr degrees operator-(degrees l, degrees r) { return degrees(l.value - r.value); }
+constexpr degrees operator-(degrees a) { return degrees(-a.value); }
+constexpr degrees operator*(degrees a, float s) { return degrees(a.value * s); }
+constexpr degrees operator/(degrees a, float s) { return degrees(a.value / s); }
+constexpr bool operator<(degrees l, degrees r) { return l.value < r.value; }
+constexpr bool operator>(degrees l, degrees r) { return l.value > r.value; }
+
+inline radians& operator+=(radians& l, radians r) { return l = l + r; }
+inline radians& operator-=(radians& l, radians r) { return l = l - r; }
+inline degrees& operator+=(degrees& l, degrees r) { return l = l + r; }
+inline degrees& operator-=(degrees& l, degrees r) { return l = l - r; }
+
+namespace literals {
+
+constexpr radians operator""_rad(long double v) { return radians(float(v)); }
+constexpr degrees operator""_deg(long double v) { return degrees(float(v)); }
+constexpr degrees operator""_deg(unsigned long long v) { return degrees(float(v)); }
+
+}  // literals
+
+using namespace literals;
+
+radians Wrap(radians angle);  // [-PI, PI]
+degrees Wrap(degrees angle);  // [-180, 180]
+
+//#define RAD2DEG(x) ((x) * 57.295754f)
+//#define DEG2RAD(x) ((x) * 0.0174533f)
+
+#ifndef RAD2DEG
+float RAD2DEG(float radians);
+#endif
+#ifndef DEG2RAD
+float DEG2RAD(float degrees);
+#endif
+float CorrectDegrees(float degrees);  // (-360, 360), sign kept
+
+// Fused sine and cosine with one shared range reduction, batches go 4 angles
+// at once (SSE2). Error is below 2e-7 (sinf/cosf level) for |angle| < 8192,
+// Wrap() larger angles first.
+void SinCos(radians angle, float& s, float& c);
+void SinCos(radians angle, double& s, double& c);  // std::sin/cos, for double precision types
+void SinCos(const float* angles, float* s, float* c, size_t count);  // radians
+
+}  // phys
+
+#endif
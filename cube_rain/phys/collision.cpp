@@ -0,0 +1,246 @@
+#include "collision.h"
+#include <cmath>
+#include <cfloat>
+
+namespace phys {
+
+vec3 GetMin(const AABB& aabb) {
+	vec3 p1 = aabb.position + aabb.size;
+	vec3 p2 = aabb.position - aabb.size;
+
+	return vec3(fminf(p1.x, p2.x), fminf(p1.y, p2.y), fminf(p1.z, p2.z));
+}
+
+vec3 GetMax(const AABB& aabb) {
+	vec3 p1 = aabb.position + aabb.size;
+	vec3 p2 = aabb.position - aabb.size;
+
+	return vec3(fmaxf(p1.x, p2.x), fmaxf(p1.y, p2.y), fmaxf(p1.z, p2.z));
+}
+
+AABB FromMinMax(const vec3& min, const vec3& max) {
+	return AABB((min + max) * 0.5f, (max - min) * 0.5f);
+}
+
+Ray FromPoints(const vec3& from, const vec3& to) {
+	return Ray(from, to - from);
+}
+
+Interval GetInterval(const AABB& aabb, const vec3& axis) {
+	vec3 i = GetMin(aabb);
+	vec3 a = GetMax(aabb);
+
+	vec3 vertex[8] = {
+		vec3(i.x, a.y, a.z),
+		vec3(i.x, a.y, i.z),
+		vec3(i.x, i.y, a.z),
+		vec3(i.x, i.y, i.z),
+		vec3(a.x, a.y, a.z),
+		vec3(a.x, a.y, i.z),
+		vec3(a.x, i.y, a.z),
+		vec3(a.x, i.y, i.z)
+	};
+
+	Interval result;
+	result.min = result.max = Dot(axis, vertex[0]);
+
+	for (int i = 1; i < 8; ++i) {
+		float projection = Dot(axis, vertex[i]);
+		result.min = (projection < result.min) ? projection : result.min;
+		result.max = (projection > result.max) ? projection : result.max;
+	}
+
+	return result;
+}
+
+Interval GetInterval(const OBB& obb, const vec3& axis) {
+	vec3 vertex[8];
+
+	vec3 C = obb.position; // OBB Center
+	vec3 E = obb.size; // OBB Extents
+	const float* o = obb.orientation.asArray;
+	vec3 A[] = { // OBB Axis
+		vec3(o[0], o[1], o[2]),
+		vec3(o[3], o[4], o[5]),
+		vec3(o[6], o[7], o[8]),
+	};
+
+	vertex[0] = C + A[0] * E[0] + A[1] * E[1] + A[2] * E[2];
+	vertex[1] = C - A[0] * E[0] + A[1] * E[1] + A[2] * E[2];
+	vertex[2] = C + A[0] * E[0] - A[1] * E[1] + A[2] * E[2];
+	vertex[3] = C + A[0] * E[0] + A[1] * E[1] - A[2] * E[2];
+	vertex[4] = C - A[0] * E[0] - A[1] * E[1] - A[2] * E[2];
+	vertex[5] = C + A[0] * E[0] - A[1] * E[1] - A[2] * E[2];
+	vertex[6] = C - A[0] * E[0] + A[1] * E[1] - A[2] * E[2];
+	vertex[7] = C - A[0] * E[0] - A[1] * E[1] + A[2] * E[2];
+
+	Interval result;
+	result.min = result.max = Dot(axis, vertex[0]);
+
+	for (int i = 1; i < 8; ++i) {
+		float projection = Dot(axis, vertex[i]);
+		result.min = (projection < result.min) ? projection : result.min;
+		result.max = (projection > result.max) ? projection : result.max;
+	}
+
+	return result;
+}
+
+bool OverlapOnAxis(const AABB& aabb, const OBB& obb, const vec3& axis) {
+	Interval a = GetInterval(aabb, axis);
+	Interval b = GetInterval(obb, axis);
+	return ((b.min <= a.max) && (a.min <= b.max));
+}
+
+bool OverlapOnAxis(const OBB& obb1, const OBB& obb2, const vec3& axis) {
+	Interval a = GetInterval(obb1, axis);
+	Interval b = GetInterval(obb2, axis);
+	return ((b.min <= a.max) && (a.min <= b.max));
+}
+
+bool AABBAABB(const AABB& aabb1, const AABB& aabb2) {
+	vec3 aMin = GetMin(aabb1);
+	vec3 aMax = GetMax(aabb1);
+	vec3 bMin = GetMin(aabb2);
+	vec3 bMax = GetMax(aabb2);
+
+	return	(aMin.x <= bMax.x && aMax.x >= bMin.x) &&
+			(aMin.y <= bMax.y && aMax.y >= bMin.y) &&
+			(aMin.z <= bMax.z && aMax.z >= bMin.z);
+}
+
+bool AABBOBB(const AABB& aabb, const OBB& obb) {
+	const float* o = obb.orientation.asArray;
+
+	vec3 test[15] = {
+		vec3(1, 0, 0), // AABB axis 1
+		vec3(0, 1, 0), // AABB axis 2
+		vec3(0, 0, 1), // AABB axis 3
+		vec3(o[0], o[1], o[2]),
+		vec3(o[3], o[4], o[5]),
+		vec3(o[6], o[7], o[8])
+	};
+
+	for (int i = 0; i < 3; ++i) { // Fill out rest of axis
+		test[6 + i * 3 + 0] = Cross(test[i], test[3]);
+		test[6 + i * 3 + 1] = Cross(test[i], test[4]);
+		test[6 + i * 3 + 2] = Cross(test[i], test[5]);
+	}
+
+	for (int i = 0; i < 15; ++i) {
+		if (!OverlapOnAxis(aabb, obb, test[i])) {
+			return false; // Seperating axis found
+		}
+	}
+
+	return true; // Seperating axis not found
+}
+
+bool OBBOBB(const OBB& obb1, const OBB& obb2) {
+	const float* o1 = obb1.orientation.asArray;
+	const float* o2 = obb2.orientation.asArray;
+
+	vec3 test[15] = {
+		vec3(o1[0], o1[1], o1[2]),
+		vec3(o1[3], o1[4], o1[5]),
+		vec3(o1[6], o1[7], o1[8]),
+		vec3(o2[0], o2[1], o2[2]),
+		vec3(o2[3], o2[4], o2[5]),
+		vec3(o2[6], o2[7], o2[8])
+	};
+
+	for (int i = 0; i < 3; ++i) { // Fill out rest of axis
+		test[6 + i * 3 + 0] = Cross(test[i], test[3]);
+		test[6 + i * 3 + 1] = Cross(test[i], test[4]);
+		test[6 + i * 3 + 2] = Cross(test[i], test[5]);
+	}
+
+	for (int i = 0; i < 15; ++i) {
+		if (!OverlapOnAxis(obb1, obb2, test[i])) {
+			return false; // Seperating axis found
+		}
+	}
+
+	return true; // Seperating axis not found
+}
+
+float Raycast(const AABB& aabb, const Ray& ray) {
+	vec3 min = GetMin(aabb);
+	vec3 max = GetMax(aabb);
+
+	// slabs, avoid division by zero for axis parallel rays
+	const float* o = ray.origin.asArray;
+	const float* d = ray.direction.asArray;
+	float t[6];
+	for (int i = 0; i < 3; ++i) {
+		float di = (d[i] == 0.0f) ? 0.00001f : d[i];
+		t[i * 2 + 0] = (min[i] - o[i]) / di;
+		t[i * 2 + 1] = (max[i] - o[i]) / di;
+	}
+
+	float tmin = fmaxf(fmaxf(fminf(t[0], t[1]), fminf(t[2], t[3])), fminf(t[4], t[5]));
+	float tmax = fminf(fminf(fmaxf(t[0], t[1]), fmaxf(t[2], t[3])), fmaxf(t[4], t[5]));
+
+	if (tmax < 0) { // box behind the ray
+		return -1;
+	}
+
+	if (tmin > tmax) { // ray misses the box
+		return -1;
+	}
+
+	if (tmin < 0.0f) { // origin inside the box
+		return 0.0f;
+	}
+
+	return tmin;
+}
+
+float Raycast(const OBB& obb, const Ray& ray) {
+	const float* o = obb.orientation.asArray;
+	vec3 X(o[0], o[1], o[2]);
+	vec3 Y(o[3], o[4], o[5]);
+	vec3 Z(o[6], o[7], o[8]);
+
+	// rotation keeps direction normalized and distances along the ray
+	vec3 p = ray.origin - obb.position;
+	Ray local;
+	local.origin = vec3(Dot(X, p), Dot(Y, p), Dot(Z, p));
+	local.direction = vec3(Dot(X, ray.direction), Dot(Y, ray.direction), Dot(Z, ray.direction));
+
+	return Raycast(AABB(vec3(), obb.size), local);
+}
+
+void ResetCollisionManifold(CollisionManifold* result) {
+	if (result != 0) {
+		result->colliding = false;
+		result->normal = vec3(0, 0, 1);
+		result->depth = FLT_MAX;
+	}
+}
+
+CollisionManifold FindCollisionFeatures(const AABB& A, const AABB& B) {
+	CollisionManifold result;
+	ResetCollisionManifold(&result);
+
+	vec3 d = B.position - A.position;
+	vec3 overlap = A.size + B.size; // per axis overlap = sum of half sizes - |distance|
+
+	for (int i = 0; i < 3; ++i) {
+		float depth = overlap[i] - fabsf(d[i]);
+		if (depth <= 0.0f) {
+			return result; // Seperating axis found
+		}
+
+		if (depth < result.depth) {
+			result.depth = depth;
+			result.normal = vec3(0, 0, 0);
+			result.normal[i] = (d[i] < 0.0f) ? -1.0f : 1.0f;
+		}
+	}
+
+	result.colliding = true;
+	return result;
+}
+
+}  // phys
@@ -0,0 +1,80 @@
+#ifndef _H_COLLISION_
+#define _H_COLLISION_
+
+#include "vectors.h"
+#include "matrices.h"
+
+namespace phys {
+
+typedef struct AABB {
+	vec3 position;
+	vec3 size; // HALF SIZE!
+
+	inline AABB() : size(1, 1, 1) { }
+	inline AABB(const vec3& p, const vec3& s) :
+		position(p), size(s) { }
+} AABB;
+
+typedef struct OBB {
+	vec3 position;
+	vec3 size; // HALF SIZE!
+	mat3 orientation; // rows are box local axes
+
+	inline OBB() : size(1, 1, 1) { }
+	inline OBB(const vec3& p, const vec3& s) :
+		position(p), size(s) { }
+	inline OBB(const vec3& p, const vec3& s, const mat3& o) :
+		position(p), size(s), orientation(o) { }
+} OBB;
+
+typedef struct Ray {
+	vec3 origin;
+	vec3 direction; // normalized
+
+	inline Ray() : direction(0.0f, 0.0f, 1.0f) { }
+	inline Ray(const vec3& o, const vec3& d) :
+		origin(o), direction(d) {
+		NormalizeDirection();
+	}
+	inline void NormalizeDirection() {
+		Normalize(direction);
+	}
+} Ray;
+
+typedef struct Interval {
+	float min;
+	float max;
+} Interval;
+
+typedef struct CollisionManifold {
+	bool colliding;
+	vec3 normal; // from first to second shape
+	float depth; // move second shape by normal * depth to separate shapes
+} CollisionManifold;
+
+vec3 GetMin(const AABB& aabb);
+vec3 GetMax(const AABB& aabb);
+AABB FromMinMax(const vec3& min, const vec3& max);
+Ray FromPoints(const vec3& from, const vec3& to);
+
+Interval GetInterval(const AABB& aabb, const vec3& axis);
+Interval GetInterval(const OBB& obb, const vec3& axis);
+
+bool OverlapOnAxis(const AABB& aabb, const OBB& obb, const vec3& axis);
+bool OverlapOnAxis(const OBB& obb1, const OBB& obb2, const vec3& axis);
+
+bool AABBAABB(const AABB& aabb1, const AABB& aabb2);
+bool AABBOBB(const AABB& aabb, const OBB& obb); // separating axis test
+bool OBBOBB(const OBB& obb1, const OBB& obb2); // separating axis test
+
+// Distance along the ray to the first hit (0 for origin inside), -1 for miss
+float Raycast(const AABB& aabb, const Ray& ray);
+float Raycast(const OBB& obb, const Ray& ray); // raycast in box local space
+
+void ResetCollisionManifold(CollisionManifold* result);
+// Minimum translation (axis of the smallest overlap) separating boxes
+CollisionManifold FindCollisionFeatures(const AABB& A, const AABB& B);
+
+}  // phys
+
+#endif
@@ -1,63 +1,117 @@
 #include "Compare.h"
 #include "matrices.h"
+#include "simd.h"
 #include <cmath>
 #include <cfloat>
 #include <iostream>
+#include <type_traits>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
 
 namespace phys {
 
-bool operator==(const mat2& l, const mat2& r) {
+template <typename T>
+bool operator==(const basic_mat2<T>& l, const basic_mat2<T>& r) {
 	for (int i = 0; i < /* 2 * 2 = */4; ++i) {
-		if (!CMP(l.asArray[i], r.asArray[i])) {
+		if (l.asArray[i] != r.asArray[i]) {
 			return false;
 		}
 	}
 	return true;
 }
 
-bool operator==(const mat3& l, const mat3& r) {
+template <typename T>
+bool operator==(const basic_mat3<T>& l, const basic_mat3<T>& r) {
 	for (int i = 0; i < /* 3 * 3 = */ 9; ++i) {
-		if (!CMP(l.asArray[i], r.asArray[i])) {
+		if (l.asArray[i] != r.asArray[i]) {
 			return false;
 		}
 	}
 	return true;
 }
-bool operator==(const mat4& l, const mat4& r) {
+
+template <typename T>
+bool operator==(const basic_mat4<T>& l, const basic_mat4<T>& r) {
+#ifdef __SSE2__
+	if constexpr (std::is_same<T, float>::value) {  // row by row, one branch
+		__m128 eq = _mm_cmpeq_ps(_mm_loadu_ps(l.asArray), _mm_loadu_ps(r.asArray));
+		for (int i = 4; i < 16; i += 4) {
+			eq = _mm_and_ps(eq, _mm_cmpeq_ps(_mm_loadu_ps(l.asArray + i), _mm_loadu_ps(r.asArray + i)));
+		}
+		return _mm_movemask_ps(eq) == 0xf;
+	}
+#endif
 	for (int i = 0; i < /* 4 * 4 = */ 16; ++i) {
-		if (!CMP(l.asArray[i], r.asArray[i])) {
+		if (l.asArray[i] != r.asArray[i]) {
 			return false;
 		}
 	}
 	return true;
 }
 
-bool operator!=(const mat2& l, const mat2& r) {
+template <typename T>
+bool operator!=(const basic_mat2<T>& l, const basic_mat2<T>& r) {
 	return !(l == r);
 }
 
-bool operator!=(const mat3& l, const mat3& r) {
+template <typename T>
+bool operator!=(const basic_mat3<T>& l, const basic_mat3<T>& r) {
 	return !(l == r);
 }
 
-bool operator!=(const mat4& l, const mat4& r) {
+template <typename T>
+bool operator!=(const basic_mat4<T>& l, const basic_mat4<T>& r) {
 	return !(l == r);
 }
 
-std::ostream& operator<<(std::ostream& os, const mat2& m) {
+template <typename T>
+bool ApproxEqual(const basic_mat2<T>& l, const basic_mat2<T>& r, typename basic_mat2<T>::value_type tolerance) {
+	for (int i = 0; i < 4; ++i) {
+		if (!ApproxEqual(l.asArray[i], r.asArray[i], tolerance)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+bool ApproxEqual(const basic_mat3<T>& l, const basic_mat3<T>& r, typename basic_mat3<T>::value_type tolerance) {
+	for (int i = 0; i < 9; ++i) {
+		if (!ApproxEqual(l.asArray[i], r.asArray[i], tolerance)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+bool ApproxEqual(const basic_mat4<T>& l, const basic_mat4<T>& r, typename basic_mat4<T>::value_type tolerance) {
+	for (int i = 0; i < 16; ++i) {
+		if (!ApproxEqual(l.asArray[i], r.asArray[i], tolerance)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const basic_mat2<T>& m) {
 	os << m._11 << ", " << m._12 << "\n";
 	os << m._21 << ", " << m._22;
 	return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const mat3& m) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const basic_mat3<T>& m) {
 	os << m._11 << ", " << m._12 << ", " << m._13 << "\n";
 	os << m._21 << ", " << m._22 << ", " << m._23 << "\n";
 	os << m._31 << ", " << m._32 << ", " << m._33;
 	return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const mat4& m) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const basic_mat4<T>& m) {
 	os << m._11 << ", " << m._12 << ", " << m._13 << ", " << m._14 << "\n";
 	os << m._21 << ", " << m._22 << ", " << m._23 << ", " << m._24 << "\n";
 	os << m._31 << ", " << m._32 << ", " << m._33 << ", " << m._34 << "\n";
@@ -65,30 +119,96 @@ std::ostream& operator<<(std::ostream& os, const mat4& m) {
 	return os;
 }
 
-mat3 FastInverse(const mat3& mat) {
+template <typename T>
+basic_mat3<T> FastInverse(const basic_mat3<T>& mat) {
 	return Transpose(mat);
 }
 
-mat4 FastInverse(const mat4& mat) {
+template <typename T>
+basic_mat4<T> FastInverse(const basic_mat4<T>& mat) {
+	return RigidInverse(mat);
+}
+
+template <typename T>
+basic_mat4<T> RigidInverse(const basic_mat4<T>& mat) {
+	if constexpr (std::is_same<T, float>::value) {
+		// transposed rotation, translation row is -position * transposed rotation
+		simd_mat4 const m(mat);
+		simd_mat4 inverse = Transpose(simd_mat4(m.row[0], m.row[1], m.row[2], simd_vec4(0, 0, 0, 1)));
+		inverse.row[3] = inverse.row[3] - MultiplyVector(m.row[3], inverse);
+		return mat4(inverse);
+	}
+	else {
+		basic_mat4<T> inverse = Transpose(mat);
+		inverse._41 = inverse._14 = T(0);
+		inverse._42 = inverse._24 = T(0);
+		inverse._43 = inverse._34 = T(0);
+
+		basic_vec3<T> right =	basic_vec3<T>(mat._11, mat._12, mat._13);
+		basic_vec3<T> up =		basic_vec3<T>(mat._21, mat._22, mat._23);
+		basic_vec3<T> forward =	basic_vec3<T>(mat._31, mat._32, mat._33);
+		basic_vec3<T> position = basic_vec3<T>(mat._41, mat._42, mat._43);
 
-	mat4 inverse = Transpose(mat);
-	inverse._41 = inverse._14 = 0.0f;
-	inverse._42 = inverse._24 = 0.0f;
-	inverse._43 = inverse._34 = 0.0f;
+		inverse._41 = -Dot(right, position);
+		inverse._42 = -Dot(up, position);
+		inverse._43 = -Dot(forward, position);
 
-	vec3 right =	vec3(mat._11, mat._12, mat._13);
-	vec3 up =		vec3(mat._21, mat._22, mat._23);
-	vec3 forward =	vec3(mat._31, mat._32, mat._33);
-	vec3 position = vec3(mat._41, mat._42, mat._43);
+		return inverse;
+	}
+}
 
-	inverse._41 = -Dot(right, position);
-	inverse._42 = -Dot(up, position);
-	inverse._43 = -Dot(forward, position);
+template <typename T>
+basic_mat4<T> AffineInverse(const basic_mat4<T>& mat) {
+	// inverse of the linear part with rows a, b, c has columns
+	// Cross(b, c), Cross(c, a), Cross(a, b) divided by Dot(a, Cross(b, c))
+	if constexpr (std::is_same<T, float>::value) {
+		simd_mat4 const m(mat);
+		simd_vec4 const x = Cross(m.row[1], m.row[2]),
+			y = Cross(m.row[2], m.row[0]),
+			z = Cross(m.row[0], m.row[1]),
+			inv_det = simd_vec4(1.0f) / DotSplat(m.row[0], x);
+
+		simd_mat4 inverse = Transpose(simd_mat4(x, y, z, simd_vec4(0, 0, 0, 1)));
+		inverse.row[0] *= inv_det;
+		inverse.row[1] *= inv_det;
+		inverse.row[2] *= inv_det;
+		inverse.row[3] = inverse.row[3] - MultiplyVector(m.row[3], inverse);
+		return mat4(inverse);
+	}
+	else {
+		basic_vec3<T> const a(mat._11, mat._12, mat._13),
+			b(mat._21, mat._22, mat._23),
+			c(mat._31, mat._32, mat._33),
+			position(mat._41, mat._42, mat._43),
+			x = Cross(b, c),
+			y = Cross(c, a),
+			z = Cross(a, b);
+		T const inv_det = T(1) / Dot(a, x);
+
+		basic_mat4<T> inverse(
+			x.x * inv_det, y.x * inv_det, z.x * inv_det, T(0),
+			x.y * inv_det, y.y * inv_det, z.y * inv_det, T(0),
+			x.z * inv_det, y.z * inv_det, z.z * inv_det, T(0),
+			T(0), T(0), T(0), T(1));
+
+		inverse._41 = -(position.x * inverse._11 + position.y * inverse._21 + position.z * inverse._31);
+		inverse._42 = -(position.x * inverse._12 + position.y * inverse._22 + position.z * inverse._32);
+		inverse._43 = -(position.x * inverse._13 + position.y * inverse._23 + position.z * inverse._33);
+		return inverse;
+	}
+}
 
-	return inverse;
+template <typename T>
+basic_mat4<T> Inverse(const basic_mat4<T>& mat, transform_kind kind) {
+	switch (kind) {
+		case transform_kind::rigid: return RigidInverse(mat);
+		case transform_kind::affine: return AffineInverse(mat);
+		default: return Inverse(mat);
+	}
 }
 
-void Transpose(const float *srcMat, float *dstMat, int srcRows, int srcCols) {
+template <typename T>
+void Transpose(const T *srcMat, T *dstMat, int srcRows, int srcCols) {
 	for (int i = 0; i < srcRows * srcCols; i++) {
 		int row = i / srcRows;
 		int col = i % srcRows;
@@ -96,56 +216,63 @@ void Transpose(const float *srcMat, float *dstMat, int srcRows, int srcCols) {
 	}
 }
 
-mat2 Transpose(const mat2& matrix) {
-	mat2 result;
+template <typename T>
+basic_mat2<T> Transpose(const basic_mat2<T>& matrix) {
+	basic_mat2<T> result;
 	Transpose(matrix.asArray, result.asArray, 2, 2);
 	return result;
 }
 
-mat3 Transpose(const mat3& matrix) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> Transpose(const basic_mat3<T>& matrix) {
+	basic_mat3<T> result;
 	Transpose(matrix.asArray, result.asArray, 3, 3);
 	return result;
 }
 
-mat4 Transpose(const mat4& matrix) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> Transpose(const basic_mat4<T>& matrix) {
+	basic_mat4<T> result;
 	Transpose(matrix.asArray, result.asArray, 4, 4);
 	return result;
 }
 
-mat2 operator*(const mat2& matrix, float scalar) {
-	mat2 result;
+template <typename T>
+basic_mat2<T> operator*(const basic_mat2<T>& matrix, typename basic_mat2<T>::value_type scalar) {
+	basic_mat2<T> result;
 	for (int i = 0; i < 4; ++i) {
 		result.asArray[i] = matrix.asArray[i] * scalar;
 	}
 	return result;
 }
 
-mat3 operator*(const mat3& matrix, float scalar) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> operator*(const basic_mat3<T>& matrix, typename basic_mat3<T>::value_type scalar) {
+	basic_mat3<T> result;
 	for (int i = 0; i < 9; ++i) {
 		result.asArray[i] = matrix.asArray[i] * scalar;
 	}
 	return result;
 }
 
-mat4 operator*(const mat4& matrix, float scalar) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> operator*(const basic_mat4<T>& matrix, typename basic_mat4<T>::value_type scalar) {
+	basic_mat4<T> result;
 	for (int i = 0; i < 16; ++i) {
 		result.asArray[i] = matrix.asArray[i] * scalar;
 	}
 	return result;
 }
 
-bool Multiply(float* out, const float* matA, int aRows, int aCols, const float* matB, int bRows, int bCols) {
+template <typename T>
+bool Multiply(T* out, const T* matA, int aRows, int aCols, const T* matB, int bRows, int bCols) {
 	if (aCols != bRows) {
 		return false;
 	}
 
 	for (int i = 0; i < aRows; ++i) {
 		for (int j = 0; j < bCols; ++j) {
-			out[bCols * i + j] = 0.0f;
+			out[bCols * i + j] = T(0);
 			for (int k = 0; k < bRows; ++k) {
 				out[bCols * i + j] += matA[aCols * i + k] * matB[bCols * k + j];
 			}
@@ -155,30 +282,35 @@ bool Multiply(float* out, const float* matA, int aRows, int aCols, const float*
 	return true;
 }
 
-mat2 operator*(const mat2& matrixA, const mat2& matrixB) {
-	mat2 result;
+template <typename T>
+basic_mat2<T> operator*(const basic_mat2<T>& matrixA, const basic_mat2<T>& matrixB) {
+	basic_mat2<T> result;
 	Multiply(result.asArray, matrixA.asArray, 2, 2, matrixB.asArray, 2, 2);
 	return result;
 }
 
-mat3 operator*(const mat3& matrixA, const mat3& matrixB) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> operator*(const basic_mat3<T>& matrixA, const basic_mat3<T>& matrixB) {
+	basic_mat3<T> result;
 	Multiply(result.asArray, matrixA.asArray, 3, 3, matrixB.asArray, 3, 3);
 	return result;
 }
 
-mat4 operator*(const mat4& matrixA, const mat4& matrixB) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> operator*(const basic_mat4<T>& matrixA, const basic_mat4<T>& matrixB) {
+	basic_mat4<T> result;
 	Multiply(result.asArray, matrixA.asArray, 4, 4, matrixB.asArray, 4, 4);
 	return result;
 }
 
-float Determinant(const mat2& matrix) {
+template <typename T>
+T Determinant(const basic_mat2<T>& matrix) {
 	return matrix._11 * matrix._22 - matrix._12 * matrix._21;
 }
 
-mat2 Cut(const mat3& mat, int row, int col) {
-	mat2 result;
+template <typename T>
+basic_mat2<T> Cut(const basic_mat3<T>& mat, int row, int col) {
+	basic_mat2<T> result;
 	int index = 0;
 
 	for (int i = 0; i < 3; ++i) {
@@ -193,8 +325,9 @@ mat2 Cut(const mat3& mat, int row, int col) {
 	return result;
 }
 
-mat3 Cut(const mat4& mat, int row, int col) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> Cut(const basic_mat4<T>& mat, int row, int col) {
+	basic_mat3<T> result;
 	int index = 0;
 
 	for (int i = 0; i < 4; ++i) {
@@ -209,8 +342,9 @@ mat3 Cut(const mat4& mat, int row, int col) {
 	return result;
 }
 
-mat3 Minor(const mat3& mat) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> Minor(const basic_mat3<T>& mat) {
+	basic_mat3<T> result;
 
 	for (int i = 0; i < 3; ++i) {
 		for (int j = 0; j < 3; ++j) {
@@ -221,35 +355,40 @@ mat3 Minor(const mat3& mat) {
 	return result;
 }
 
-mat2 Minor(const mat2& mat) {
-	return mat2(
+template <typename T>
+basic_mat2<T> Minor(const basic_mat2<T>& mat) {
+	return basic_mat2<T>(
 		mat._22, mat._21,
 		mat._12, mat._11
 	);
 }
 
-void Cofactor(float* out, const float* minor, int rows, int cols) {
+template <typename T>
+void Cofactor(T* out, const T* minor, int rows, int cols) {
 	for (int i = 0; i < rows; ++i) {
 		for (int j = 0; j < cols; ++j) {
-			out[cols * j + i] = minor[cols * j + i] * powf(-1.0f, i + j);
+			out[cols * j + i] = minor[cols * j + i] * std::pow(-T(1), i + j);
 		}
 	}
 }
 
-mat2 Cofactor(const mat2& mat) {
-	mat2 result;
+template <typename T>
+basic_mat2<T> Cofactor(const basic_mat2<T>& mat) {
+	basic_mat2<T> result;
 	Cofactor(result.asArray, Minor(mat).asArray, 2, 2);
 	return result;
 }
 
-mat3 Cofactor(const mat3& mat) {
-	mat3 result;
+template <typename T>
+basic_mat3<T> Cofactor(const basic_mat3<T>& mat) {
+	basic_mat3<T> result;
 	Cofactor(result.asArray, Minor(mat).asArray, 3, 3);
 	return result;
 }
 
-float Determinant(const mat3& mat) {
-	float result = 0.0f;
+template <typename T>
+T Determinant(const basic_mat3<T>& mat) {
+	T result = T(0);
 
 	/*float A = mat.asArray[3 * 0 + 0] * Determinant(Cut(mat, 0, 0));
 	float B = mat.asArray[3 * 0 + 1] * Determinant(Cut(mat, 0, 1));
@@ -260,7 +399,7 @@ float Determinant(const mat3& mat) {
 		result += mat.asArray[3 * 0 + j] * Determinant(Cut(mat, 0, j)) * powf(-1, 0 + j);
 	}*/
 
-	mat3 cofactor = Cofactor(mat);
+	basic_mat3<T> cofactor = Cofactor(mat);
 	for (int j = 0; j < 3; ++j) {
 		result += mat.asArray[3 * 0 + j] * cofactor[0][j];
 	}
@@ -268,8 +407,9 @@ float Determinant(const mat3& mat) {
 	return result;
 }
 
-mat4 Minor(const mat4& mat) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> Minor(const basic_mat4<T>& mat) {
+	basic_mat4<T> result;
 
 	for (int i = 0; i < 4; ++i) {
 		for (int j = 0; j < 4; ++j) {
@@ -280,16 +420,18 @@ mat4 Minor(const mat4& mat) {
 	return result;
 }
 
-mat4 Cofactor(const mat4& mat) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> Cofactor(const basic_mat4<T>& mat) {
+	basic_mat4<T> result;
 	Cofactor(result.asArray, Minor(mat).asArray, 4, 4);
 	return result;
 }
 
-float Determinant(const mat4& mat) {
-	float result = 0.0f;
+template <typename T>
+T Determinant(const basic_mat4<T>& mat) {
+	T result = T(0);
 
-	mat4 cofactor = Cofactor(mat);
+	basic_mat4<T> cofactor = Cofactor(mat);
 	for (int j = 0; j < 4; ++j) {
 		result += mat.asArray[4 * 0 + j] * cofactor[0][j];
 	}
@@ -297,29 +439,33 @@ float Determinant(const mat4& mat) {
 	return result;
 }
 
-mat2 Adjugate(const mat2& mat) {
+template <typename T>
+basic_mat2<T> Adjugate(const basic_mat2<T>& mat) {
 	return Transpose(Cofactor(mat));
 }
 
-mat3 Adjugate(const mat3& mat) {
+template <typename T>
+basic_mat3<T> Adjugate(const basic_mat3<T>& mat) {
 	return Transpose(Cofactor(mat));
 }
 
-mat4 Adjugate(const mat4& mat) {
+template <typename T>
+basic_mat4<T> Adjugate(const basic_mat4<T>& mat) {
 	return Transpose(Cofactor(mat));
 }
 
-mat2 Inverse(const mat2& mat) {
-	float det = Determinant(mat);
-	if (CMP(det, 0.0f)) { return mat2(); }
-	return Adjugate(mat) * (1.0f / det);
+template <typename T>
+basic_mat2<T> Inverse(const basic_mat2<T>& mat) {
+	T det = Determinant(mat);
+	if (CMP(det, T(0))) { return basic_mat2<T>(); }
+	return Adjugate(mat) * (T(1) / det);
 
-	/*float det = mat._11 * mat._22 - mat._12 * mat._21;
-	if (CMP(det, 0.0f)) { 
-		return mat2(); 
+	/*T det = mat._11 * mat._22 - mat._12 * mat._21;
+	if (CMP(det, T(0))) { 
+		return basic_mat2<T>(); 
 	}
-	float i_det = 1.0f / det;
-	mat2 result;
+	T i_det = T(1) / det;
+	basic_mat2<T> result;
 	result._11 =  mat._22 * i_det;
 	result._12 = -mat._12 * i_det;
 	result._21 = -mat._21 * i_det;
@@ -327,21 +473,23 @@ mat2 Inverse(const mat2& mat) {
 	return result;*/
 }
 
-mat3 Inverse(const mat3& mat) {
-	float det = Determinant(mat);
-	if (CMP(det, 0.0f)) { return mat3(); }
-	return Adjugate(mat) * (1.0f / det);
+template <typename T>
+basic_mat3<T> Inverse(const basic_mat3<T>& mat) {
+	T det = Determinant(mat);
+	if (CMP(det, T(0))) { return basic_mat3<T>(); }
+	return Adjugate(mat) * (T(1) / det);
 }
 
-mat4 Inverse(const mat4& m) {
-	/*float det = Determinant(m);
-	if (CMP(det, 0.0f)) { return mat4(); }
-	return Adjugate(m) * (1.0f / det);*/
+template <typename T>
+basic_mat4<T> Inverse(const basic_mat4<T>& m) {
+	/*T det = Determinant(m);
+	if (CMP(det, T(0))) { return basic_mat4<T>(); }
+	return Adjugate(m) * (T(1) / det);*/
 
 	// The code below is the expanded form of the above equation.
 	// This optimization avoids loops and function calls
 
-	float det 
+	T det 
 		= m._11 * m._22 * m._33 * m._44 + m._11 * m._23 * m._34 * m._42 + m._11 * m._24 * m._32 * m._43
 		+ m._12 * m._21 * m._34 * m._43 + m._12 * m._23 * m._31 * m._44 + m._12 * m._24 * m._33 * m._41
 		+ m._13 * m._21 * m._32 * m._44 + m._13 * m._22 * m._34 * m._41 + m._13 * m._24 * m._31 * m._42
@@ -351,12 +499,12 @@ mat4 Inverse(const mat4& m) {
 		- m._13 * m._21 * m._34 * m._42 - m._13 * m._22 * m._31 * m._44 - m._13 * m._24 * m._32 * m._41
 		- m._14 * m._21 * m._32 * m._43 - m._14 * m._22 * m._33 * m._41 - m._14 * m._23 * m._31 * m._42;
 
-	if (CMP(det, 0.0f)) { 
-		return mat4(); 
+	if (CMP(det, T(0))) { 
+		return basic_mat4<T>(); 
 	}
-	float i_det = 1.0f / det;
+	T i_det = T(1) / det;
 
-	mat4 result;
+	basic_mat4<T> result;
 	result._11 = (m._22 * m._33 * m._44 + m._23 * m._34 * m._42 + m._24 * m._32 * m._43 - m._22 * m._34 * m._43 - m._23 * m._32 * m._44 - m._24 * m._33 * m._42) * i_det;
 	result._12 = (m._12 * m._34 * m._43 + m._13 * m._32 * m._44 + m._14 * m._33 * m._42 - m._12 * m._33 * m._44 - m._13 * m._34 * m._42 - m._14 * m._32 * m._43) * i_det;
 	result._13 = (m._12 * m._23 * m._44 + m._13 * m._24 * m._42 + m._14 * m._22 * m._43 - m._12 * m._24 * m._43 - m._13 * m._22 * m._44 - m._14 * m._23 * m._42) * i_det;
@@ -374,26 +522,30 @@ mat4 Inverse(const mat4& m) {
 	result._43 = (m._11 * m._23 * m._42 + m._12 * m._21 * m._43 + m._13 * m._22 * m._41 - m._11 * m._22 * m._43 - m._12 * m._23 * m._41 - m._13 * m._21 * m._42) * i_det;
 	result._44 = (m._11 * m._22 * m._33 + m._12 * m._23 * m._31 + m._13 * m._21 * m._32 - m._11 * m._23 * m._32 - m._12 * m._21 * m._33 - m._13 * m._22 * m._31) * i_det;
 
-	/*if (result * m != mat4()) {
+	/*if (result * m != basic_mat4<T>()) {
 		std::cout << "ERROR! Expecting matrix x inverse to equal identity!\n";
 	}*/
 
 	return result;
 }
 
-mat4 ToColumnMajor(const mat4& mat) {
+template <typename T>
+basic_mat4<T> ToColumnMajor(const basic_mat4<T>& mat) {
 	return Transpose(mat);
 }
 
-mat3 ToColumnMajor(const mat3& mat) {
+template <typename T>
+basic_mat3<T> ToColumnMajor(const basic_mat3<T>& mat) {
 	return Transpose(mat);
 }
 
-mat4 FromColumnMajor(const mat4& mat) {
+template <typename T>
+basic_mat4<T> FromColumnMajor(const basic_mat4<T>& mat) {
 	return Transpose(mat);
 }
 
-mat3 FromColumnMajor(const mat3& mat) {
+template <typename T>
+basic_mat3<T> FromColumnMajor(const basic_mat3<T>& mat) {
 	return Transpose(mat);
 }
 
@@ -414,12 +566,13 @@ mat4 Translation(float x, float y, float z) {
 		   x,    y,    z, 1.0f
 	);
 }
-mat4 Translation(const vec3& pos) {
-	return mat4(
-		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		pos.x,pos.y,pos.z,1.0f
+template <typename T>
+basic_mat4<T> Translation(const basic_vec3<T>& pos) {
+	return basic_mat4<T>(
+		T(1), T(0), T(0), T(0),
+		T(0), T(1), T(0), T(0),
+		T(0), T(0), T(1), T(0),
+		pos.x,pos.y,pos.z,T(1)
 	);
 }
 
@@ -432,17 +585,19 @@ mat4 Translate(float x, float y, float z) {
 	);
 }
 
-mat4 Translate(const vec3& pos) {
-	return mat4(
-		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, 1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f, 1.0f, 0.0f,
-		pos.x, pos.y, pos.z, 1.0f
+template <typename T>
+basic_mat4<T> Translate(const basic_vec3<T>& pos) {
+	return basic_mat4<T>(
+		T(1), T(0), T(0), T(0),
+		T(0), T(1), T(0), T(0),
+		T(0), T(0), T(1), T(0),
+		pos.x, pos.y, pos.z, T(1)
 	);
 }
 
-mat4 FromMat3(const mat3& mat) {
-	mat4 result;
+template <typename T>
+basic_mat4<T> FromMat3(const basic_mat3<T>& mat) {
+	basic_mat4<T> result;
 
 	result._11 = mat._11;
 	result._12 = mat._12;
@@ -459,8 +614,9 @@ mat4 FromMat3(const mat3& mat) {
 	return result;
 }
 
-vec3 GetTranslation(const mat4& mat) {
-	return vec3(mat._41, mat._42, mat._43);
+template <typename T>
+basic_vec3<T> GetTranslation(const basic_mat4<T>& mat) {
+	return basic_vec3<T>(mat._41, mat._42, mat._43);
 }
 
 mat4 Scale(float x, float y, float z) {
@@ -472,17 +628,19 @@ mat4 Scale(float x, float y, float z) {
 	);
 }
 
-mat4 Scale(const vec3& vec) {
-	return mat4(
-		vec.x,0.0f, 0.0f, 0.0f,
-		0.0f, vec.y,0.0f, 0.0f,
-		0.0f, 0.0f, vec.z,0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
+template <typename T>
+basic_mat4<T> Scale(const basic_vec3<T>& vec) {
+	return basic_mat4<T>(
+		vec.x,T(0), T(0), T(0),
+		T(0), vec.y,T(0), T(0),
+		T(0), T(0), vec.z,T(0),
+		T(0), T(0), T(0), T(1)
 	);
 }
 
-vec3 GetScale(const mat4& mat) {
-	return vec3(mat._11, mat._22, mat._33);
+template <typename T>
+basic_vec3<T> GetScale(const basic_mat4<T>& mat) {
+	return basic_vec3<T>(mat._11, mat._22, mat._33);
 }
 
 mat4 Rotation(float pitch, float yaw, float roll) {
@@ -494,98 +652,111 @@ mat3 Rotation3x3(float pitch, float yaw, float roll) {
 }
 
 mat2 Rotation2x2(float angle) {
+	float s, c;
+	SinCos(Wrap(radians(angle)), s, c);
 	return mat2(
-		cosf(angle), sinf(angle),
-		-sinf(angle), cosf(angle)
+		c, s,
+		-s, c
 		);
 }
 
 mat4 YawPitchRoll(float yaw, float pitch, float roll) {
-	yaw = DEG2RAD(yaw);
-	pitch = DEG2RAD(pitch);
-	roll = DEG2RAD(roll);
+	float const angles[3] = {
+		radians(Wrap(degrees(yaw))).value,
+		radians(Wrap(degrees(pitch))).value,
+		radians(Wrap(degrees(roll))).value
+	};
+	float s[3], c[3];
+	SinCos(angles, s, c, 3);
 
 	mat4 out; // z * x * y
-	out._11 = (cosf(roll) * cosf(yaw)) + (sinf(roll) * sinf(pitch) * sinf(yaw));
-	out._12 = (sinf(roll) * cosf(pitch));
-	out._13 = (cosf(roll) * -sinf(yaw)) + (sinf(roll) * sinf(pitch) * cosf(yaw));
-	out._21 = (-sinf(roll) * cosf(yaw)) + (cosf(roll) * sinf(pitch) * sinf(yaw));
-	out._22 = (cosf(roll) * cosf(pitch));
-	out._23 = (sinf(roll) * sinf(yaw)) + (cosf(roll) * sinf(pitch) * cosf(yaw));
-	out._31 = (cosf(pitch) * sinf(yaw));
-	out._32 = -sinf(pitch);
-	out._33 = (cosf(pitch) * cosf(yaw));
+	out._11 = (c[2] * c[0]) + (s[2] * s[1] * s[0]);
+	out._12 = (s[2] * c[1]);
+	out._13 = (c[2] * -s[0]) + (s[2] * s[1] * c[0]);
+	out._21 = (-s[2] * c[0]) + (c[2] * s[1] * s[0]);
+	out._22 = (c[2] * c[1]);
+	out._23 = (s[2] * s[0]) + (c[2] * s[1] * c[0]);
+	out._31 = (c[1] * s[0]);
+	out._32 = -s[1];
+	out._33 = (c[1] * c[0]);
 	out._44 = 1;
 	return out;
 }
 
 mat4 XRotation(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat4(
 		1.0f, 0.0f, 0.0f, 0.0f,
-		0.0f, cosf(angle), sinf(angle), 0.0f,
-		0.0f, -sinf(angle), cosf(angle), 0.0f,
+		0.0f, c, s, 0.0f,
+		0.0f, -s, c, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f
 	);
 }
 
 mat3 XRotation3x3(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat3(
 		1.0f, 0.0f, 0.0f,
-		0.0f, cosf(angle), sinf(angle),
-		0.0f, -sinf(angle), cosf(angle)
+		0.0f, c, s,
+		0.0f, -s, c
 	);
 }
 
 mat4 YRotation(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat4(
-		cosf(angle), 0.0f, -sinf(angle), 0.0f,
+		c, 0.0f, -s, 0.0f,
 		0.0f, 1.0f, 0.0f, 0.0f,
-		sinf(angle), 0.0f, cosf(angle), 0.0f,
+		s, 0.0f, c, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f
 	);
 }
 
 mat3 YRotation3x3(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat3(
-		cosf(angle), 0.0f, -sinf(angle),
+		c, 0.0f, -s,
 		0.0f, 1.0f, 0.0f,
-		sinf(angle), 0.0f, cosf(angle)
+		s, 0.0f, c
 	);
 }
 
 mat4 ZRotation(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat4(
-		cosf(angle), sinf(angle), 0.0f, 0.0f,
-		-sinf(angle), cosf(angle), 0.0f, 0.0f,
+		c, s, 0.0f, 0.0f,
+		-s, c, 0.0f, 0.0f,
 		0.0f, 0.0f, 1.0f, 0.0f,
 		0.0f, 0.0f, 0.0f, 1.0f
 	);
 }
 
 mat3 ZRotation3x3(float angle) {
-	angle = DEG2RAD(angle);
+	float s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
 	return mat3(
-		cosf(angle), sinf(angle), 0.0f,
-		-sinf(angle), cosf(angle), 0.0f,
+		c, s, 0.0f,
+		-s, c, 0.0f,
 		0.0f, 0.0f, 1.0f
 	);
 }
 
-mat4 Orthogonalize(const mat4& mat) {
-	vec3 xAxis(mat._11, mat._12, mat._13);
-	vec3 yAxis(mat._21, mat._22, mat._23);
-	vec3 zAxis = Cross(xAxis, yAxis);
+template <typename T>
+basic_mat4<T> Orthogonalize(const basic_mat4<T>& mat) {
+	basic_vec3<T> xAxis(mat._11, mat._12, mat._13);
+	basic_vec3<T> yAxis(mat._21, mat._22, mat._23);
+	basic_vec3<T> zAxis = Cross(xAxis, yAxis);
 
 	xAxis = Cross(yAxis, zAxis);
 	yAxis = Cross(zAxis, xAxis);
 	zAxis = Cross(xAxis, yAxis);
 
-	return mat4(
+	return basic_mat4<T>(
 		xAxis.x, xAxis.y, xAxis.z, mat._14,
 		yAxis.x, yAxis.y, yAxis.z, mat._24,
 		zAxis.x, zAxis.y, zAxis.z, mat._34,
@@ -593,115 +764,122 @@ mat4 Orthogonalize(const mat4& mat) {
 	);
 }
 
-mat3 Orthogonalize(const mat3& mat) {
-	vec3 xAxis(mat._11, mat._12, mat._13);
-	vec3 yAxis(mat._21, mat._22, mat._23);
-	vec3 zAxis = Cross(xAxis, yAxis);
+template <typename T>
+basic_mat3<T> Orthogonalize(const basic_mat3<T>& mat) {
+	basic_vec3<T> xAxis(mat._11, mat._12, mat._13);
+	basic_vec3<T> yAxis(mat._21, mat._22, mat._23);
+	basic_vec3<T> zAxis = Cross(xAxis, yAxis);
 
 	xAxis = Cross(yAxis, zAxis);
 	yAxis = Cross(zAxis, xAxis);
 	zAxis = Cross(xAxis, yAxis);
 
-	return mat3(
+	return basic_mat3<T>(
 		xAxis.x, xAxis.y, xAxis.z,
 		yAxis.x, yAxis.y, yAxis.z,
 		zAxis.x, zAxis.y, zAxis.z
 	);
 }
 
-mat4 AxisAngle(const vec3& axis, float angle) {
-	angle = DEG2RAD(angle);
-	float c = cosf(angle);
-	float s = sinf(angle);
-	float t = 1.0f - cosf(angle);
+template <typename T>
+basic_mat4<T> AxisAngle(const basic_vec3<T>& axis, float angle) {
+	T s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
+	T t = T(1) - c;
 
-	float x = axis.x;
-	float y = axis.y;
-	float z = axis.z;
-	if (!CMP(MagnitudeSq(axis), 1.0f)) {
-		float inv_len = 1.0f / Magnitude(axis);
+	T x = axis.x;
+	T y = axis.y;
+	T z = axis.z;
+	if (!CMP(MagnitudeSq(axis), T(1))) {
+		T inv_len = T(1) / Magnitude(axis);
 		x *= inv_len;
 		y *= inv_len;
 		z *= inv_len;
 	}
 
-	return mat4(
-		t * (x * x) + c, t * x * y + s * z, t * x * z - s * y, 0.0f,
-		t * x * y - s * z, t * (y * y) + c, t * y * z + s * x, 0.0f,
-		t * x * z + s * y, t * y * z - s * x, t * (z * z) + c, 0.0f,
-		0.0f, 0.0f, 0.0f, 1.0f
+	return basic_mat4<T>(
+		t * (x * x) + c, t * x * y + s * z, t * x * z - s * y, T(0),
+		t * x * y - s * z, t * (y * y) + c, t * y * z + s * x, T(0),
+		t * x * z + s * y, t * y * z - s * x, t * (z * z) + c, T(0),
+		T(0), T(0), T(0), T(1)
 	);
 }
 
-mat3 AxisAngle3x3(const vec3& axis, float angle) {
-	angle = DEG2RAD(angle);
-	float c = cosf(angle);
-	float s = sinf(angle);
-	float t = 1.0f - cosf(angle);
+template <typename T>
+basic_mat3<T> AxisAngle3x3(const basic_vec3<T>& axis, float angle) {
+	T s, c;
+	SinCos(Wrap(degrees(angle)), s, c);
+	T t = T(1) - c;
 
-	float x = axis.x;
-	float y = axis.y;
-	float z = axis.z;
-	if (!CMP(MagnitudeSq(axis), 1.0f)) {
-		float inv_len = 1.0f / Magnitude(axis);
+	T x = axis.x;
+	T y = axis.y;
+	T z = axis.z;
+	if (!CMP(MagnitudeSq(axis), T(1))) {
+		T inv_len = T(1) / Magnitude(axis);
 		x *= inv_len;
 		y *= inv_len;
 		z *= inv_len;
 	}
 
-	return mat3(
+	return basic_mat3<T>(
 		t * (x * x) + c, t * x * y + s * z, t * x * z - s * y, 
 		t * x * y - s * z, t * (y * y) + c, t * y * z + s * x, 
 		t * x * z + s * y, t * y * z - s * x, t * (z * z) + c
 	);
 }
 
-vec3 MultiplyPoint(const vec3& vec, const mat4& mat) {
-	vec3 result;
-	result.x = vec.x * mat._11 + vec.y * mat._21 + vec.z * mat._31 + 1.0f * mat._41;
-	result.y = vec.x * mat._12 + vec.y * mat._22 + vec.z * mat._32 + 1.0f * mat._42;
-	result.z = vec.x * mat._13 + vec.y * mat._23 + vec.z * mat._33 + 1.0f * mat._43;
+template <typename T>
+basic_vec3<T> MultiplyPoint(const basic_vec3<T>& vec, const basic_mat4<T>& mat) {
+	basic_vec3<T> result;
+	result.x = vec.x * mat._11 + vec.y * mat._21 + vec.z * mat._31 + T(1) * mat._41;
+	result.y = vec.x * mat._12 + vec.y * mat._22 + vec.z * mat._32 + T(1) * mat._42;
+	result.z = vec.x * mat._13 + vec.y * mat._23 + vec.z * mat._33 + T(1) * mat._43;
 	return result;
 }
 
-vec3 MultiplyVector(const vec3& vec, const mat4& mat) {
-	vec3 result;
-	result.x = vec.x * mat._11 + vec.y * mat._21 + vec.z * mat._31 + 0.0f * mat._41;
-	result.y = vec.x * mat._12 + vec.y * mat._22 + vec.z * mat._32 + 0.0f * mat._42;
-	result.z = vec.x * mat._13 + vec.y * mat._23 + vec.z * mat._33 + 0.0f * mat._43;
+template <typename T>
+basic_vec3<T> MultiplyVector(const basic_vec3<T>& vec, const basic_mat4<T>& mat) {
+	basic_vec3<T> result;
+	result.x = vec.x * mat._11 + vec.y * mat._21 + vec.z * mat._31 + T(0) * mat._41;
+	result.y = vec.x * mat._12 + vec.y * mat._22 + vec.z * mat._32 + T(0) * mat._42;
+	result.z = vec.x * mat._13 + vec.y * mat._23 + vec.z * mat._33 + T(0) * mat._43;
 	return result;
 }
 
-vec3 MultiplyVector(const vec3& vec, const mat3& mat) {
-	vec3 result;
-	result.x = Dot(vec, vec3{ mat._11, mat._21, mat._31 });
-	result.y = Dot(vec, vec3{ mat._12, mat._22, mat._32 });
-	result.z = Dot(vec, vec3{ mat._13, mat._23, mat._33 });
+template <typename T>
+basic_vec3<T> MultiplyVector(const basic_vec3<T>& vec, const basic_mat3<T>& mat) {
+	basic_vec3<T> result;
+	result.x = Dot(vec, basic_vec3<T>{ mat._11, mat._21, mat._31 });
+	result.y = Dot(vec, basic_vec3<T>{ mat._12, mat._22, mat._32 });
+	result.z = Dot(vec, basic_vec3<T>{ mat._13, mat._23, mat._33 });
 	return result;
 }
 
-mat4 Transform(const vec3& scale, const vec3& eulerRotation, const vec3& translate) {
+template <typename T>
+basic_mat4<T> Transform(const basic_vec3<T>& scale, const basic_vec3<T>& eulerRotation, const basic_vec3<T>& translate) {
 	return Scale(scale) *
-		Rotation(eulerRotation.x, eulerRotation.y, eulerRotation.z) *
+		basic_mat4<T>(Rotation(float(eulerRotation.x), float(eulerRotation.y), float(eulerRotation.z))) *
 		Translation(translate);
 }
 
-mat4 Transform(const vec3& scale, const vec3& rotationAxis, float rotationAngle, const vec3& translate) {
+template <typename T>
+basic_mat4<T> Transform(const basic_vec3<T>& scale, const basic_vec3<T>& rotationAxis, float rotationAngle, const basic_vec3<T>& translate) {
 	return Scale(scale) * 
 		AxisAngle(rotationAxis, rotationAngle) * 
 		Translation(translate);
 }
 
-mat4 LookAt(const vec3& position, const vec3& target, const vec3& up) {
-	vec3 forward = Normalized(target - position);
-	vec3 right = Normalized(Cross(up, forward));
-	vec3 newUp = Cross(forward, right);
+template <typename T>
+basic_mat4<T> LookAt(const basic_vec3<T>& position, const basic_vec3<T>& target, const basic_vec3<T>& up) {
+	basic_vec3<T> forward = Normalized(target - position);
+	basic_vec3<T> right = Normalized(Cross(up, forward));
+	basic_vec3<T> newUp = Cross(forward, right);
 
-	return mat4(
-		right.x, newUp.x, forward.x, 0.0f,
-		right.y, newUp.y, forward.y, 0.0f,
-		right.z, newUp.z, forward.z, 0.0f,
-		-Dot(right, position), -Dot(newUp, position), -Dot(forward, position), 1.0f
+	return basic_mat4<T>(
+		right.x, newUp.x, forward.x, T(0),
+		right.y, newUp.y, forward.y, T(0),
+		right.z, newUp.z, forward.z, T(0),
+		-Dot(right, position), -Dot(newUp, position), -Dot(forward, position), T(1)
 	);
 }
 
@@ -738,14 +916,15 @@ mat4 Ortho(float left, float right, float bottom, float top, float zNear, float
 	); 
 }
 
-vec3 Decompose(const mat3& rot1) {
-	mat3 rot = Transpose(rot1);
+template <typename T>
+basic_vec3<T> Decompose(const basic_mat3<T>& rot1) {
+	basic_mat3<T> rot = Transpose(rot1);
 
-	float sy = sqrt(rot._11 * rot._11 + rot._21 * rot._21);
+	T sy = sqrt(rot._11 * rot._11 + rot._21 * rot._21);
 
 	bool singular = sy < 1e-6;
 
-	float x, y, z;
+	T x, y, z;
 	if (!singular) {
 		x = atan2(rot._32, rot._33);
 		y = atan2(-rot._31, sy);
@@ -757,7 +936,81 @@ vec3 Decompose(const mat3& rot1) {
 		z = 0;
 	}
 
-	return vec3(x, y, z);
-}
+	return basic_vec3<T>(x, y, z);
+}
+
+#define INSTANTIATE_MATRIX_FUNCTIONS(T) \
+	template bool operator==(const basic_mat2<T>&, const basic_mat2<T>&); \
+	template bool operator==(const basic_mat3<T>&, const basic_mat3<T>&); \
+	template bool operator==(const basic_mat4<T>&, const basic_mat4<T>&); \
+	template bool operator!=(const basic_mat2<T>&, const basic_mat2<T>&); \
+	template bool operator!=(const basic_mat3<T>&, const basic_mat3<T>&); \
+	template bool operator!=(const basic_mat4<T>&, const basic_mat4<T>&); \
+	template bool ApproxEqual(const basic_mat2<T>&, const basic_mat2<T>&, T); \
+	template bool ApproxEqual(const basic_mat3<T>&, const basic_mat3<T>&, T); \
+	template bool ApproxEqual(const basic_mat4<T>&, const basic_mat4<T>&, T); \
+	template std::ostream& operator<<(std::ostream&, const basic_mat2<T>&); \
+	template std::ostream& operator<<(std::ostream&, const basic_mat3<T>&); \
+	template std::ostream& operator<<(std::ostream&, const basic_mat4<T>&); \
+	template void Transpose(const T*, T*, int, int); \
+	template basic_mat2<T> Transpose(const basic_mat2<T>&); \
+	template basic_mat3<T> Transpose(const basic_mat3<T>&); \
+	template basic_mat4<T> Transpose(const basic_mat4<T>&); \
+	template basic_mat2<T> operator*(const basic_mat2<T>&, T); \
+	template basic_mat3<T> operator*(const basic_mat3<T>&, T); \
+	template basic_mat4<T> operator*(const basic_mat4<T>&, T); \
+	template bool Multiply(T*, const T*, int, int, const T*, int, int); \
+	template basic_mat2<T> operator*(const basic_mat2<T>&, const basic_mat2<T>&); \
+	template basic_mat3<T> operator*(const basic_mat3<T>&, const basic_mat3<T>&); \
+	template basic_mat4<T> operator*(const basic_mat4<T>&, const basic_mat4<T>&); \
+	template basic_mat3<T> Cut(const basic_mat4<T>&, int, int); \
+	template basic_mat2<T> Cut(const basic_mat3<T>&, int, int); \
+	template void Cofactor(T*, const T*, int, int); \
+	template basic_mat2<T> Minor(const basic_mat2<T>&); \
+	template basic_mat2<T> Cofactor(const basic_mat2<T>&); \
+	template T Determinant(const basic_mat2<T>&); \
+	template basic_mat2<T> Adjugate(const basic_mat2<T>&); \
+	template basic_mat2<T> Inverse(const basic_mat2<T>&); \
+	template basic_mat3<T> Minor(const basic_mat3<T>&); \
+	template basic_mat3<T> Cofactor(const basic_mat3<T>&); \
+	template T Determinant(const basic_mat3<T>&); \
+	template basic_mat3<T> Adjugate(const basic_mat3<T>&); \
+	template basic_mat3<T> Inverse(const basic_mat3<T>&); \
+	template basic_mat4<T> Minor(const basic_mat4<T>&); \
+	template basic_mat4<T> Cofactor(const basic_mat4<T>&); \
+	template T Determinant(const basic_mat4<T>&); \
+	template basic_mat4<T> Adjugate(const basic_mat4<T>&); \
+	template basic_mat4<T> Inverse(const basic_mat4<T>&); \
+	template basic_mat4<T> ToColumnMajor(const basic_mat4<T>&); \
+	template basic_mat3<T> ToColumnMajor(const basic_mat3<T>&); \
+	template basic_mat4<T> FromColumnMajor(const basic_mat4<T>&); \
+	template basic_mat3<T> FromColumnMajor(const basic_mat3<T>&); \
+	template basic_mat4<T> Translation(const basic_vec3<T>&); \
+	template basic_vec3<T> GetTranslation(const basic_mat4<T>&); \
+	template basic_mat4<T> Translate(const basic_vec3<T>&); \
+	template basic_mat4<T> FromMat3(const basic_mat3<T>&); \
+	template basic_mat4<T> Scale(const basic_vec3<T>&); \
+	template basic_vec3<T> GetScale(const basic_mat4<T>&); \
+	template basic_mat4<T> Orthogonalize(const basic_mat4<T>&); \
+	template basic_mat3<T> Orthogonalize(const basic_mat3<T>&); \
+	template basic_mat4<T> AxisAngle(const basic_vec3<T>&, float); \
+	template basic_mat3<T> AxisAngle3x3(const basic_vec3<T>&, float); \
+	template basic_vec3<T> MultiplyPoint(const basic_vec3<T>&, const basic_mat4<T>&); \
+	template basic_vec3<T> MultiplyVector(const basic_vec3<T>&, const basic_mat4<T>&); \
+	template basic_vec3<T> MultiplyVector(const basic_vec3<T>&, const basic_mat3<T>&); \
+	template basic_mat4<T> Transform(const basic_vec3<T>&, const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_mat4<T> Transform(const basic_vec3<T>&, const basic_vec3<T>&, float, const basic_vec3<T>&); \
+	template basic_mat4<T> LookAt(const basic_vec3<T>&, const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T> Decompose(const basic_mat3<T>&); \
+	template basic_mat3<T> FastInverse(const basic_mat3<T>&); \
+	template basic_mat4<T> FastInverse(const basic_mat4<T>&); \
+	template basic_mat4<T> RigidInverse(const basic_mat4<T>&); \
+	template basic_mat4<T> AffineInverse(const basic_mat4<T>&); \
+	template basic_mat4<T> Inverse(const basic_mat4<T>&, transform_kind);
+
+INSTANTIATE_MATRIX_FUNCTIONS(float)
+INSTANTIATE_MATRIX_FUNCTIONS(double)
+
+#undef INSTANTIATE_MATRIX_FUNCTIONS
 
 }  // phys
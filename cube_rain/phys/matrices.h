@@ -57,158 +57,206 @@ The Projection and Orthographic projection functions product left
 handed matrices. That is, +Z goes INTO the screen. 
 */
 
-typedef struct mat2 {
+template <typename T>
+struct basic_mat2 {
+	typedef T value_type;
+
 	union {
 		struct {
-			float	_11, _12,
-					_21, _22;
+			T	_11, _12,
+				_21, _22;
 		};
-		float asArray[4];
+		T asArray[4];
 	};
 
-	inline mat2() { 
-		_11 = _22 = 1.0f;
-		_12 = _21 = 0.0f;
+	inline basic_mat2() { 
+		_11 = _22 = T(1);
+		_12 = _21 = T(0);
 	}
 
-	inline mat2(float f11, float f12,
-				float f21, float f22) {
+	inline basic_mat2(T f11, T f12,
+					  T f21, T f22) {
 		_11 = f11; _12 = f12;
 		_21 = f21; _22 = f22;
 	}
 
-	inline float* operator[](int i) {
+	template <typename U>
+	inline explicit basic_mat2(const basic_mat2<U>& m) {
+		for (int i = 0; i < 4; ++i) {
+			asArray[i] = T(m.asArray[i]);
+		}
+	}
+
+	inline T* operator[](int i) {
 		return &(asArray[i * 2]);
 	}
-} mat2;
+};
+
+template <typename T>
+struct basic_mat3 {
+	typedef T value_type;
 
-typedef struct mat3 {
 	union {
 		struct {
-			float	_11, _12, _13,
-					_21, _22, _23,
-					_31, _32, _33;
+			T	_11, _12, _13,
+				_21, _22, _23,
+				_31, _32, _33;
 		};
-		float asArray[9];
+		T asArray[9];
 	};
 
-	inline mat3() {
-		_11 = _22 = _33 = 1.0f;
-		_12 = _13 = _21 = 0.0f;
-		_23 = _31 = _32 = 0.0f;
+	inline basic_mat3() {
+		_11 = _22 = _33 = T(1);
+		_12 = _13 = _21 = T(0);
+		_23 = _31 = _32 = T(0);
 	}
 
-	inline mat3(float f11, float f12, float f13,
-				float f21, float f22, float f23,
-				float f31, float f32, float f33) {
+	inline basic_mat3(T f11, T f12, T f13,
+					  T f21, T f22, T f23,
+					  T f31, T f32, T f33) {
 		_11 = f11; _12 = f12; _13 = f13;
 		_21 = f21; _22 = f22; _23 = f23;
 		_31 = f31; _32 = f32; _33 = f33;
 	}
 
-	inline float* operator[](int i) {
+	template <typename U>
+	inline explicit basic_mat3(const basic_mat3<U>& m) {
+		for (int i = 0; i < 9; ++i) {
+			asArray[i] = T(m.asArray[i]);
+		}
+	}
+
+	inline T* operator[](int i) {
 		return &(asArray[i * 3]);
 	}
-} mat3;
+};
+
+template <typename T>
+struct basic_mat4 {
+	typedef T value_type;
 
-typedef struct mat4 {
 	union {
 		struct {
-			float	_11, _12, _13, _14,
-					_21, _22, _23, _24,
-					_31, _32, _33, _34,
-					_41, _42, _43, _44;
+			T	_11, _12, _13, _14,
+				_21, _22, _23, _24,
+				_31, _32, _33, _34,
+				_41, _42, _43, _44;
 		};
-		float asArray[16];
+		T asArray[16];
 	};
 
-	inline mat4() {
-		_11 = _22 = _33 = _44 = 1.0f;
-		_12 = _13 = _14 = _21 = 0.0f;
-		_23 = _24 = _31 = _32 = 0.0f;
-		_34 = _41 = _42 = _43 = 0.0f;
+	inline basic_mat4() {
+		_11 = _22 = _33 = _44 = T(1);
+		_12 = _13 = _14 = _21 = T(0);
+		_23 = _24 = _31 = _32 = T(0);
+		_34 = _41 = _42 = _43 = T(0);
 	}
 
-	inline mat4(float f11, float f12, float f13, float f14,
-				float f21, float f22, float f23, float f24,
-				float f31, float f32, float f33, float f34,
-				float f41, float f42, float f43, float f44) {
+	inline basic_mat4(T f11, T f12, T f13, T f14,
+					  T f21, T f22, T f23, T f24,
+					  T f31, T f32, T f33, T f34,
+					  T f41, T f42, T f43, T f44) {
 		_11 = f11; _12 = f12; _13 = f13; _14 = f14;
 		_21 = f21; _22 = f22; _23 = f23; _24 = f24;
 		_31 = f31; _32 = f32; _33 = f33; _34 = f34;
 		_41 = f41; _42 = f42; _43 = f43; _44 = f44;
 	}
 
-	inline float* operator[](int i) {
+	template <typename U>
+	inline explicit basic_mat4(const basic_mat4<U>& m) {
+		for (int i = 0; i < 16; ++i) {
+			asArray[i] = T(m.asArray[i]);
+		}
+	}
+
+	inline T* operator[](int i) {
 		return &(asArray[i * 4]);
 	}
-} mat4;
-
-bool operator==(const mat2& l, const mat2& r);
-bool operator==(const mat3& l, const mat3& r);
-bool operator==(const mat4& l, const mat4& r);
-
-bool operator!=(const mat2& l, const mat2& r);
-bool operator!=(const mat3& l, const mat3& r);
-bool operator!=(const mat4& l, const mat4& r);
-
-std::ostream& operator<<(std::ostream& os, const mat2& m);
-std::ostream& operator<<(std::ostream& os, const mat3& m);
-std::ostream& operator<<(std::ostream& os, const mat4& m);
-
-void Transpose(const float *srcMat, float *dstMat,  int srcRows,  int srcCols);
-mat2 Transpose(const mat2& matrix);
-mat3 Transpose(const mat3& matrix);
-mat4 Transpose(const mat4& matrix);
-
-mat2 operator*(const mat2& matrix, float scalar);
-mat3 operator*(const mat3& matrix, float scalar);
-mat4 operator*(const mat4& matrix, float scalar);
-
-bool Multiply(float* out, const float* matA, int aRows, int aCols, const float* matB, int bRows, int bCols);
-mat2 operator*(const mat2& matrixA, const mat2& matrixB);
-mat3 operator*(const mat3& matrixA, const mat3& matrixB);
-mat4 operator*(const mat4& matrixA, const mat4& matrixB);
-
-mat3 Cut(const mat4& mat, int row, int col);
-mat2 Cut(const mat3& mat, int row, int col);
-void Cofactor(float* out, const float* minor, int rows, int cols);
-
-mat2 Minor(const mat2& mat);
-mat2 Cofactor(const mat2& mat);
-float Determinant(const mat2& matrix);
-mat2 Adjugate(const mat2& mat);
-mat2 Inverse(const mat2& mat);
-
-mat3 Minor(const mat3& mat);
-mat3 Cofactor(const mat3& mat);
-float Determinant(const mat3& mat);
-mat3 Adjugate(const mat3& mat);
-mat3 Inverse(const mat3& mat);
-
-mat4 Minor(const mat4& mat);
-mat4 Cofactor(const mat4& mat);
-float Determinant(const mat4& mat);
-mat4 Adjugate(const mat4& mat);
-mat4 Inverse(const mat4& mat);
-
-mat4 ToColumnMajor(const mat4& mat);
-mat3 ToColumnMajor(const mat3& mat);
-mat4 FromColumnMajor(const mat4& mat);
-mat3 FromColumnMajor(const mat3& mat);
+};
+
+typedef basic_mat2<float> mat2;
+typedef basic_mat3<float> mat3;
+typedef basic_mat4<float> mat4;
+typedef basic_mat2<double> dmat2;
+typedef basic_mat3<double> dmat3;
+typedef basic_mat4<double> dmat4;
+
+/*
+Functions taking a vector or matrix are instantiated for float and double,
+factories taking only scalars (Rotation, Projection, ...) build float
+matrices, convert them e.g. dmat4(XRotation(30)) when mixing with double.
+*/
+
+template <typename T> bool operator==(const basic_mat2<T>& l, const basic_mat2<T>& r);
+template <typename T> bool operator==(const basic_mat3<T>& l, const basic_mat3<T>& r);
+template <typename T> bool operator==(const basic_mat4<T>& l, const basic_mat4<T>& r);
+
+template <typename T> bool operator!=(const basic_mat2<T>& l, const basic_mat2<T>& r);
+template <typename T> bool operator!=(const basic_mat3<T>& l, const basic_mat3<T>& r);
+template <typename T> bool operator!=(const basic_mat4<T>& l, const basic_mat4<T>& r);
+
+// exact like vector operator==, ApproxEqual() with absolute tolerance
+template <typename T> bool ApproxEqual(const basic_mat2<T>& l, const basic_mat2<T>& r, typename basic_mat2<T>::value_type tolerance = 0.005f);
+template <typename T> bool ApproxEqual(const basic_mat3<T>& l, const basic_mat3<T>& r, typename basic_mat3<T>::value_type tolerance = 0.005f);
+template <typename T> bool ApproxEqual(const basic_mat4<T>& l, const basic_mat4<T>& r, typename basic_mat4<T>::value_type tolerance = 0.005f);
+
+template <typename T> std::ostream& operator<<(std::ostream& os, const basic_mat2<T>& m);
+template <typename T> std::ostream& operator<<(std::ostream& os, const basic_mat3<T>& m);
+template <typename T> std::ostream& operator<<(std::ostream& os, const basic_mat4<T>& m);
+
+template <typename T> void Transpose(const T *srcMat, T *dstMat,  int srcRows,  int srcCols);
+template <typename T> basic_mat2<T> Transpose(const basic_mat2<T>& matrix);
+template <typename T> basic_mat3<T> Transpose(const basic_mat3<T>& matrix);
+template <typename T> basic_mat4<T> Transpose(const basic_mat4<T>& matrix);
+
+template <typename T> basic_mat2<T> operator*(const basic_mat2<T>& matrix, typename basic_mat2<T>::value_type scalar);
+template <typename T> basic_mat3<T> operator*(const basic_mat3<T>& matrix, typename basic_mat3<T>::value_type scalar);
+template <typename T> basic_mat4<T> operator*(const basic_mat4<T>& matrix, typename basic_mat4<T>::value_type scalar);
+
+template <typename T> bool Multiply(T* out, const T* matA, int aRows, int aCols, const T* matB, int bRows, int bCols);
+template <typename T> basic_mat2<T> operator*(const basic_mat2<T>& matrixA, const basic_mat2<T>& matrixB);
+template <typename T> basic_mat3<T> operator*(const basic_mat3<T>& matrixA, const basic_mat3<T>& matrixB);
+template <typename T> basic_mat4<T> operator*(const basic_mat4<T>& matrixA, const basic_mat4<T>& matrixB);
+
+template <typename T> basic_mat3<T> Cut(const basic_mat4<T>& mat, int row, int col);
+template <typename T> basic_mat2<T> Cut(const basic_mat3<T>& mat, int row, int col);
+template <typename T> void Cofactor(T* out, const T* minor, int rows, int cols);
+
+template <typename T> basic_mat2<T> Minor(const basic_mat2<T>& mat);
+template <typename T> basic_mat2<T> Cofactor(const basic_mat2<T>& mat);
+template <typename T> T Determinant(const basic_mat2<T>& matrix);
+template <typename T> basic_mat2<T> Adjugate(const basic_mat2<T>& mat);
+template <typename T> basic_mat2<T> Inverse(const basic_mat2<T>& mat);
+
+template <typename T> basic_mat3<T> Minor(const basic_mat3<T>& mat);
+template <typename T> basic_mat3<T> Cofactor(const basic_mat3<T>& mat);
+template <typename T> T Determinant(const basic_mat3<T>& mat);
+template <typename T> basic_mat3<T> Adjugate(const basic_mat3<T>& mat);
+template <typename T> basic_mat3<T> Inverse(const basic_mat3<T>& mat);
+
+template <typename T> basic_mat4<T> Minor(const basic_mat4<T>& mat);
+template <typename T> basic_mat4<T> Cofactor(const basic_mat4<T>& mat);
+template <typename T> T Determinant(const basic_mat4<T>& mat);
+template <typename T> basic_mat4<T> Adjugate(const basic_mat4<T>& mat);
+template <typename T> basic_mat4<T> Inverse(const basic_mat4<T>& mat);
+
+template <typename T> basic_mat4<T> ToColumnMajor(const basic_mat4<T>& mat);
+template <typename T> basic_mat3<T> ToColumnMajor(const basic_mat3<T>& mat);
+template <typename T> basic_mat4<T> FromColumnMajor(const basic_mat4<T>& mat);
+template <typename T> basic_mat3<T> FromColumnMajor(const basic_mat3<T>& mat);
 mat4 FromColumnMajor(const float* mat);
 
 mat4 Translation(float x, float y, float z);
-mat4 Translation(const vec3& pos);
-vec3 GetTranslation(const mat4& mat);
+template <typename T> basic_mat4<T> Translation(const basic_vec3<T>& pos);
+template <typename T> basic_vec3<T> GetTranslation(const basic_mat4<T>& mat);
 
 mat4 Translate(float x, float y, float z);
-mat4 Translate(const vec3& pos);
-mat4 FromMat3(const mat3& mat);
+template <typename T> basic_mat4<T> Translate(const basic_vec3<T>& pos);
+template <typename T> basic_mat4<T> FromMat3(const basic_mat3<T>& mat);
 
 mat4 Scale(float x, float y, float z);
-mat4 Scale(const vec3& vec);
-vec3 GetScale(const mat4& mat);
+template <typename T> basic_mat4<T> Scale(const basic_vec3<T>& vec);
+template <typename T> basic_vec3<T> GetScale(const basic_mat4<T>& mat);
 
 mat4 Rotation(float pitch, float yaw, float roll); // X, Y, Z
 mat3 Rotation3x3(float pitch, float yaw, float roll); // X, Y, Z
@@ -224,27 +272,199 @@ mat3 YRotation3x3(float angle);
 mat4 ZRotation(float angle);
 mat3 ZRotation3x3(float angle);
 
-mat4 Orthogonalize(const mat4& mat);
-mat3 Orthogonalize(const mat3& mat);
+template <typename T> basic_mat4<T> Orthogonalize(const basic_mat4<T>& mat);
+template <typename T> basic_mat3<T> Orthogonalize(const basic_mat3<T>& mat);
 
-mat4 AxisAngle(const vec3& axis, float angle);
-mat3 AxisAngle3x3(const vec3& axis, float angle);
+template <typename T> basic_mat4<T> AxisAngle(const basic_vec3<T>& axis, float angle);
+template <typename T> basic_mat3<T> AxisAngle3x3(const basic_vec3<T>& axis, float angle);
 
-vec3 MultiplyPoint(const vec3& vec, const mat4& mat);
-vec3 MultiplyVector(const vec3& vec, const mat4& mat);
-vec3 MultiplyVector(const vec3& vec, const mat3& mat);
+template <typename T> basic_vec3<T> MultiplyPoint(const basic_vec3<T>& vec, const basic_mat4<T>& mat);
+template <typename T> basic_vec3<T> MultiplyVector(const basic_vec3<T>& vec, const basic_mat4<T>& mat);
+template <typename T> basic_vec3<T> MultiplyVector(const basic_vec3<T>& vec, const basic_mat3<T>& mat);
 
-mat4 Transform(const vec3& scale, const vec3& eulerRotation, const vec3& translate);
-mat4 Transform(const vec3& scale, const vec3& rotationAxis, float rotationAngle, const vec3& translate);
+template <typename T> basic_mat4<T> Transform(const basic_vec3<T>& scale, const basic_vec3<T>& eulerRotation, const basic_vec3<T>& translate);
+template <typename T> basic_mat4<T> Transform(const basic_vec3<T>& scale, const basic_vec3<T>& rotationAxis, float rotationAngle, const basic_vec3<T>& translate);
 
-mat4 LookAt(const vec3& position, const vec3& target, const vec3& up);
+template <typename T> basic_mat4<T> LookAt(const basic_vec3<T>& position, const basic_vec3<T>& target, const basic_vec3<T>& up);
 mat4 Projection(float fov, float aspect, float zNear, float zFar);
 mat4 Ortho(float left, float right, float bottom, float top, float zNear, float zFar);
 
-vec3 Decompose(const mat3& rot);
+template <typename T> basic_vec3<T> Decompose(const basic_mat3<T>& rot);
 
-mat3 FastInverse(const mat3& mat);
-mat4 FastInverse(const mat4& mat);
+template <typename T> basic_mat3<T> FastInverse(const basic_mat3<T>& mat);
+template <typename T> basic_mat4<T> FastInverse(const basic_mat4<T>& mat);  // same as RigidInverse()
+
+/*
+Transform kinds!
+The general Inverse() expands 4x4 cofactors, matrices keeping the last column
+(0, 0, 0, 1) have cheaper inverses:
+
+rigid   rotation and translation: Translation(), *Rotation*(), AxisAngle(),
+        YawPitchRoll(), LookAt(), camera world
+affine  rigid plus scale or shear: Scale(), ScaleTranslate(), Transform()
+general anything else: Projection(), Ortho()
+
+A product is of the most general kind of its factors, see Combined(). The
+transform wrapper carries the kind along its matrix, Tagged*() builders set it
+and products and Inverse() keep it, so the cheap inverse is picked
+automatically:
+
+transform world = TaggedScale(s) * TaggedLookAt(eye, target, up);  // affine
+mat4 view = Inverse(world).matrix;  // AffineInverse()
+
+A bare matrix can still be inverted with Inverse(mat, kind), the matrix itself
+stays 16 floats for uploads. Rigid and affine inverses have no singularity
+branch (a singular linear part gives inf/NaN) and use simd_mat4 for float.
+*/
+enum class transform_kind {
+	rigid,
+	affine,
+	general
+};
+
+constexpr transform_kind Combined(transform_kind l, transform_kind r) {
+	return (l > r) ? l : r;
+}
+
+template <typename T> basic_mat4<T> RigidInverse(const basic_mat4<T>& mat);  // transposed rotation
+template <typename T> basic_mat4<T> AffineInverse(const basic_mat4<T>& mat);  // 3x3 inverse
+template <typename T> basic_mat4<T> Inverse(const basic_mat4<T>& mat, transform_kind kind);
+
+template <typename T>
+struct basic_transform {
+	typedef T value_type;
+
+	basic_mat4<T> matrix;
+	transform_kind kind = transform_kind::rigid;  // identity
+};
+
+typedef basic_transform<float> transform;
+typedef basic_transform<double> dtransform;
+
+// l then r, of the more general kind
+template <typename T>
+inline basic_transform<T> operator*(const basic_transform<T>& l, const basic_transform<T>& r) {
+	return {l.matrix * r.matrix, Combined(l.kind, r.kind)};
+}
+
+// inverse of the same kind
+template <typename T>
+inline basic_transform<T> Inverse(const basic_transform<T>& t) {
+	return {Inverse(t.matrix, t.kind), t.kind};
+}
+
+template <typename T>
+inline basic_transform<T> TaggedTranslation(const basic_vec3<T>& pos) {
+	return {Translation(pos), transform_kind::rigid};
+}
+
+template <typename T>
+inline basic_transform<T> TaggedScale(const basic_vec3<T>& vec) {
+	return {Scale(vec), transform_kind::affine};
+}
+
+// rigid for unit scale
+template <typename T>
+inline basic_transform<T> TaggedTransform(const basic_vec3<T>& scale, const basic_vec3<T>& eulerRotation, const basic_vec3<T>& translate) {
+	return {Transform(scale, eulerRotation, translate),
+		(scale == basic_vec3<T>(1, 1, 1)) ? transform_kind::rigid : transform_kind::affine};
+}
+
+template <typename T>
+inline basic_transform<T> TaggedLookAt(const basic_vec3<T>& position, const basic_vec3<T>& target, const basic_vec3<T>& up) {
+	return {LookAt(position, target, up), transform_kind::rigid};
+}
+
+/*
+Affine!
+Transforms without projection keep the last column (0, 0, 0, 1), affine
+stores only the 3x3 linear part and the translation row, so concatenation
+is 27 multiplies instead of 64 and needs no temporaries:
+
+affine world = AffineMul(local, parent);  // same as local * parent with mat4
+mat4 M = mat4(world);  // for upload
+
+Like the fused vector operations these are inline.
+*/
+
+template <typename T>
+struct basic_affine {
+	typedef T value_type;
+
+	basic_mat3<T> linear;
+	basic_vec3<T> translation;
+
+	inline basic_affine() { }  // identity
+
+	inline basic_affine(const basic_mat3<T>& l, const basic_vec3<T>& t) : linear(l), translation(t) { }
+
+	inline explicit basic_affine(const basic_mat4<T>& m)  // drops the last column
+		: linear(m._11, m._12, m._13, m._21, m._22, m._23, m._31, m._32, m._33)
+		, translation(m._41, m._42, m._43) { }
+
+	inline explicit operator basic_mat4<T>() const {
+		const basic_mat3<T>& l = linear;
+		return basic_mat4<T>(
+			l._11, l._12, l._13, T(0),
+			l._21, l._22, l._23, T(0),
+			l._31, l._32, l._33, T(0),
+			translation.x, translation.y, translation.z, T(1)
+		);
+	}
+};
+
+typedef basic_affine<float> affine;
+typedef basic_affine<double> daffine;
+
+// Scale(scale) * Translation(translate) built directly
+template <typename T>
+inline basic_mat4<T> ScaleTranslate(const basic_vec3<T>& scale, const basic_vec3<T>& translate) {
+	return basic_mat4<T>(
+		scale.x, T(0), T(0), T(0),
+		T(0), scale.y, T(0), T(0),
+		T(0), T(0), scale.z, T(0),
+		translate.x, translate.y, translate.z, T(1)
+	);
+}
+
+template <typename T>
+inline basic_mat4<T> ScaleTranslate(typename basic_vec3<T>::value_type scale, const basic_vec3<T>& translate) {
+	return ScaleTranslate(basic_vec3<T>(scale, scale, scale), translate);
+}
+
+// row vector times the linear part, translation added in the same chain
+template <typename T>
+inline basic_vec3<T> MultiplyPoint(const basic_vec3<T>& vec, const basic_affine<T>& a) {
+	const basic_mat3<T>& l = a.linear;
+	return {
+		Madd(vec.x, l._11, Madd(vec.y, l._21, Madd(vec.z, l._31, a.translation.x))),
+		Madd(vec.x, l._12, Madd(vec.y, l._22, Madd(vec.z, l._32, a.translation.y))),
+		Madd(vec.x, l._13, Madd(vec.y, l._23, Madd(vec.z, l._33, a.translation.z)))
+	};
+}
+
+template <typename T>
+inline basic_vec3<T> MultiplyVector(const basic_vec3<T>& vec, const basic_affine<T>& a) {
+	const basic_mat3<T>& l = a.linear;
+	return {
+		Madd(vec.x, l._11, Madd(vec.y, l._21, vec.z * l._31)),
+		Madd(vec.x, l._12, Madd(vec.y, l._22, vec.z * l._32)),
+		Madd(vec.x, l._13, Madd(vec.y, l._23, vec.z * l._33))
+	};
+}
+
+// l then r (l * r as mat4)
+template <typename T>
+inline basic_affine<T> AffineMul(const basic_affine<T>& l, const basic_affine<T>& r) {
+	basic_vec3<T> const x = MultiplyVector(basic_vec3<T>(l.linear._11, l.linear._12, l.linear._13), r),
+		y = MultiplyVector(basic_vec3<T>(l.linear._21, l.linear._22, l.linear._23), r),
+		z = MultiplyVector(basic_vec3<T>(l.linear._31, l.linear._32, l.linear._33), r);
+
+	return basic_affine<T>(
+		basic_mat3<T>(x.x, x.y, x.z, y.x, y.y, y.z, z.x, z.y, z.z),
+		MultiplyPoint(l.translation, r)
+	);
+}
 
 }  // phys
 
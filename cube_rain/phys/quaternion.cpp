@@ -0,0 +1,106 @@
+#include "Compare.h"
+#include "quaternion.h"
+#include <cmath>
+
+namespace phys {
+
+quat operator*(const quat& l, const quat& r) {
+	return quat(
+		l.w * r.x + l.x * r.w + l.y * r.z - l.z * r.y,
+		l.w * r.y - l.x * r.z + l.y * r.w + l.z * r.x,
+		l.w * r.z + l.x * r.y - l.y * r.x + l.z * r.w,
+		l.w * r.w - l.x * r.x - l.y * r.y - l.z * r.z
+	);
+}
+
+quat operator*(const quat& l, float r) {
+	return quat(l.x * r, l.y * r, l.z * r, l.w * r);
+}
+
+quat operator+(const quat& l, const quat& r) {
+	return quat(l.x + r.x, l.y + r.y, l.z + r.z, l.w + r.w);
+}
+
+bool operator==(const quat& l, const quat& r) {
+	return l.x == r.x && l.y == r.y && l.z == r.z && l.w == r.w;
+}
+
+bool operator!=(const quat& l, const quat& r) {
+	return !(l == r);
+}
+
+bool ApproxEqual(const quat& l, const quat& r, float tolerance) {
+	return ApproxEqual(l.x, r.x, tolerance) && ApproxEqual(l.y, r.y, tolerance)
+		&& ApproxEqual(l.z, r.z, tolerance) && ApproxEqual(l.w, r.w, tolerance);
+}
+
+std::ostream& operator<<(std::ostream& os, const quat& q) {
+	os << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+	return os;
+}
+
+float Dot(const quat& l, const quat& r) {
+	return l.x * r.x + l.y * r.y + l.z * r.z + l.w * r.w;
+}
+
+float MagnitudeSq(const quat& q) {
+	return Dot(q, q);
+}
+
+float Magnitude(const quat& q) {
+	return sqrtf(Dot(q, q));
+}
+
+void Normalize(quat& q) {
+	q = q * (1.0f / Magnitude(q));
+}
+
+quat Normalized(const quat& q) {
+	return q * (1.0f / Magnitude(q));
+}
+
+quat Conjugate(const quat& q) {
+	return quat(-q.x, -q.y, -q.z, q.w);
+}
+
+quat AngleAxis(const vec3& axis, float angle) {
+	vec3 n = axis;
+	if (!CMP(MagnitudeSq(n), 1.0f)) {
+		n = n * (1.0f / Magnitude(n));
+	}
+
+	float s, c;
+	SinCos(Wrap(degrees(angle)) / 2.0f, s, c);
+	return quat(n.x * s, n.y * s, n.z * s, c);
+}
+
+vec3 MultiplyVector(const vec3& vec, const quat& q) {
+	// v + 2w(u x v) + 2u x (u x v) where u is vector part of q
+	vec3 u(q.x, q.y, q.z);
+	vec3 t = Cross(u, vec) * 2.0f;
+	return vec + t * q.w + Cross(u, t);
+}
+
+mat3 ToMat3(const quat& q) {
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	return mat3(
+		1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy),
+		2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx),
+		2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)
+	);
+}
+
+mat4 ToMat4(const quat& q) {
+	return FromMat3(ToMat3(q));
+}
+
+quat Integrate(const quat& q, const vec3& angularVelocity, float dt) {
+	// dq/dt = 0.5 * (angularVelocity, 0) * q
+	quat spin = quat(angularVelocity.x, angularVelocity.y, angularVelocity.z, 0.0f) * q;
+	return Normalized(q + spin * (0.5f * dt));
+}
+
+}  // phys
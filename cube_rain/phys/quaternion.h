@@ -0,0 +1,63 @@
+#ifndef _H_QUATERNION_
+#define _H_QUATERNION_
+
+#include "vectors.h"
+#include "matrices.h"
+
+namespace phys {
+
+// Unit quaternions represent rotations, matrices built from them follow the
+// row vector convention used by matrices.h (rows are rotated local axes).
+typedef struct quat {
+	union {
+		struct {
+			float x;
+			float y;
+			float z;
+			float w;
+		};
+		float asArray[4];
+	};
+
+	inline float& operator[](int i) {
+		return asArray[i];
+	}
+
+	inline quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) { } // identity
+	inline quat(float _x, float _y, float _z, float _w) :
+		x(_x), y(_y), z(_z), w(_w) { }
+} quat;
+
+// l * r rotates by r first and then by l, same as ToMat3(r) * ToMat3(l)
+quat operator*(const quat& l, const quat& r);
+quat operator*(const quat& l, float r);
+quat operator+(const quat& l, const quat& r);
+
+bool operator==(const quat& l, const quat& r);
+bool operator!=(const quat& l, const quat& r);
+
+// operator== is exact like for vectors, ApproxEqual() tolerance is absolute and
+// q and -q (the same rotation) are not equal
+bool ApproxEqual(const quat& l, const quat& r, float tolerance = 0.005f);
+
+std::ostream& operator<<(std::ostream& os, const quat& q);
+
+float Dot(const quat& l, const quat& r);
+float MagnitudeSq(const quat& q);
+float Magnitude(const quat& q);
+void Normalize(quat& q);
+quat Normalized(const quat& q);
+quat Conjugate(const quat& q); // inverse of unit quaternion
+
+quat AngleAxis(const vec3& axis, float angle); // degrees, same rotation as AxisAngle3x3()
+vec3 MultiplyVector(const vec3& vec, const quat& q);
+mat3 ToMat3(const quat& q);
+mat4 ToMat4(const quat& q);
+
+// First order integration of world space angular velocity (radians per
+// second), result is normalized.
+quat Integrate(const quat& q, const vec3& angularVelocity, float dt);
+
+}  // phys
+
+#endif
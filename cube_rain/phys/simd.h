@@ -0,0 +1,377 @@
+#ifndef _H_MATH_SIMD_
+#define _H_MATH_SIMD_
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+#endif
+#include <cmath>
+#include "vectors.h"
+#include "matrices.h"
+
+namespace phys {
+
+/*
+SIMD register types!
+simd_vec4 keeps x, y, z, w in one 16 byte aligned register (SSE2, AArch64
+NEON or plain floats otherwise), simd_mat4 keeps rows of a row major mat4
+in four of them. All functions are inline and work on whole registers, so
+hot code (camera, culling, transforms) can opt in by converting at its
+boundaries:
+
+simd_mat4 VP(cam.GetViewProjectionMatrix());
+simd_vec4 clip = simd_vec4(p, 1.0f) * VP;
+
+Conversions are lossless, vec3 takes x, y, z lanes (w is given, 0 for
+directions and 1 for points). Vector functions treat w as a regular lane,
+keep it 0 for directions.
+*/
+
+#if defined(__SSE2__)
+typedef __m128 simd_float4;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+typedef float32x4_t simd_float4;
+#else
+typedef struct simd_float4 {
+	float f[4];
+} simd_float4;
+#endif
+
+typedef struct alignas(16) simd_vec4 {
+	simd_float4 v;
+
+	inline simd_vec4() : simd_vec4(0.0f) { }
+	inline simd_vec4(float x, float y, float z, float w);
+	inline explicit simd_vec4(float s);  // all lanes
+	inline explicit simd_vec4(const vec3& xyz, float w = 0.0f);
+	inline explicit simd_vec4(simd_float4 native) : v(native) { }
+
+	inline float operator[](int i) const;
+	inline explicit operator vec3() const;  // drops w
+	inline void Store(float* out) const;  // 4 floats, unaligned
+} simd_vec4;
+
+typedef struct alignas(16) simd_mat4 {
+	simd_vec4 row[4];
+
+	inline simd_mat4();  // identity
+	inline simd_mat4(const simd_vec4& r0, const simd_vec4& r1, const simd_vec4& r2, const simd_vec4& r3) :
+		row{ r0, r1, r2, r3 } { }
+	inline explicit simd_mat4(const mat4& m);
+
+	inline explicit operator mat4() const;
+} simd_mat4;
+
+// lane i in all lanes
+template <int i> simd_vec4 Splat(const simd_vec4& v);
+
+#if defined(__SSE2__)
+
+inline simd_vec4::simd_vec4(float x, float y, float z, float w) : v(_mm_setr_ps(x, y, z, w)) { }
+inline simd_vec4::simd_vec4(float s) : v(_mm_set1_ps(s)) { }
+inline simd_vec4::simd_vec4(const vec3& xyz, float w) : v(_mm_setr_ps(xyz.x, xyz.y, xyz.z, w)) { }
+
+inline void simd_vec4::Store(float* out) const {
+	_mm_storeu_ps(out, v);
+}
+
+inline simd_vec4 operator+(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_add_ps(l.v, r.v)); }
+inline simd_vec4 operator-(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_sub_ps(l.v, r.v)); }
+inline simd_vec4 operator*(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_mul_ps(l.v, r.v)); }
+inline simd_vec4 operator/(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_div_ps(l.v, r.v)); }
+inline simd_vec4 operator-(const simd_vec4& v) { return simd_vec4(_mm_xor_ps(v.v, _mm_set1_ps(-0.0f))); }
+
+inline simd_vec4 Min(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_min_ps(l.v, r.v)); }
+inline simd_vec4 Max(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(_mm_max_ps(l.v, r.v)); }
+inline simd_vec4 Sqrt(const simd_vec4& v) { return simd_vec4(_mm_sqrt_ps(v.v)); }
+
+inline bool operator==(const simd_vec4& l, const simd_vec4& r) {
+	return _mm_movemask_ps(_mm_cmpeq_ps(l.v, r.v)) == 0xf;
+}
+
+template <int i>
+inline simd_vec4 Splat(const simd_vec4& v) {
+	return simd_vec4(_mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(i, i, i, i)));
+}
+
+inline simd_vec4 Cross(const simd_vec4& l, const simd_vec4& r) {
+	// (l * r.yzx - l.yzx * r).yzx, w = 0
+	__m128 const l_yzx = _mm_shuffle_ps(l.v, l.v, _MM_SHUFFLE(3, 0, 2, 1)),
+		r_yzx = _mm_shuffle_ps(r.v, r.v, _MM_SHUFFLE(3, 0, 2, 1)),
+		c = _mm_sub_ps(_mm_mul_ps(l.v, r_yzx), _mm_mul_ps(l_yzx, r.v));
+	return simd_vec4(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)));
+}
+
+inline simd_vec4 DotSplat(const simd_vec4& l, const simd_vec4& r) {
+	__m128 const m = _mm_mul_ps(l.v, r.v),
+		s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));  // x+y x+y z+w z+w
+	return simd_vec4(_mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+inline float Dot(const simd_vec4& l, const simd_vec4& r) {
+	return _mm_cvtss_f32(DotSplat(l, r).v);
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+inline simd_vec4::simd_vec4(float x, float y, float z, float w) {
+	float const f[4] = { x, y, z, w };
+	v = vld1q_f32(f);
+}
+
+inline simd_vec4::simd_vec4(float s) : v(vdupq_n_f32(s)) { }
+
+inline simd_vec4::simd_vec4(const vec3& xyz, float w) : simd_vec4(xyz.x, xyz.y, xyz.z, w) { }
+
+inline void simd_vec4::Store(float* out) const {
+	vst1q_f32(out, v);
+}
+
+inline simd_vec4 operator+(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vaddq_f32(l.v, r.v)); }
+inline simd_vec4 operator-(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vsubq_f32(l.v, r.v)); }
+inline simd_vec4 operator*(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vmulq_f32(l.v, r.v)); }
+inline simd_vec4 operator/(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vdivq_f32(l.v, r.v)); }
+inline simd_vec4 operator-(const simd_vec4& v) { return simd_vec4(vnegq_f32(v.v)); }
+
+inline simd_vec4 Min(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vminq_f32(l.v, r.v)); }
+inline simd_vec4 Max(const simd_vec4& l, const simd_vec4& r) { return simd_vec4(vmaxq_f32(l.v, r.v)); }
+inline simd_vec4 Sqrt(const simd_vec4& v) { return simd_vec4(vsqrtq_f32(v.v)); }
+
+inline bool operator==(const simd_vec4& l, const simd_vec4& r) {
+	return vminvq_u32(vceqq_f32(l.v, r.v)) != 0;
+}
+
+template <int i>
+inline simd_vec4 Splat(const simd_vec4& v) {
+	return simd_vec4(vdupq_laneq_f32(v.v, i));
+}
+
+inline simd_vec4 Cross(const simd_vec4& l, const simd_vec4& r) {
+	// (l * r.yzx - l.yzx * r).yzx, w = 0
+	auto yzx = [](float32x4_t v) {  // y z w x -> y z x w
+		float32x4_t const r = vextq_f32(v, v, 1);
+		return vsetq_lane_f32(vgetq_lane_f32(v, 3), vsetq_lane_f32(vgetq_lane_f32(v, 0), r, 2), 3);
+	};
+	float32x4_t const c = vsubq_f32(vmulq_f32(l.v, yzx(r.v)), vmulq_f32(yzx(l.v), r.v));
+	return simd_vec4(yzx(c));
+}
+
+inline simd_vec4 DotSplat(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(vaddvq_f32(vmulq_f32(l.v, r.v)));
+}
+
+inline float Dot(const simd_vec4& l, const simd_vec4& r) {
+	return vaddvq_f32(vmulq_f32(l.v, r.v));
+}
+
+#else  // scalar
+
+inline simd_vec4::simd_vec4(float x, float y, float z, float w) : v{ { x, y, z, w } } { }
+inline simd_vec4::simd_vec4(float s) : v{ { s, s, s, s } } { }
+inline simd_vec4::simd_vec4(const vec3& xyz, float w) : v{ { xyz.x, xyz.y, xyz.z, w } } { }
+
+inline void simd_vec4::Store(float* out) const {
+	for (int i = 0; i < 4; ++i) {
+		out[i] = v.f[i];
+	}
+}
+
+inline simd_vec4 operator+(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(l.v.f[0] + r.v.f[0], l.v.f[1] + r.v.f[1], l.v.f[2] + r.v.f[2], l.v.f[3] + r.v.f[3]);
+}
+
+inline simd_vec4 operator-(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(l.v.f[0] - r.v.f[0], l.v.f[1] - r.v.f[1], l.v.f[2] - r.v.f[2], l.v.f[3] - r.v.f[3]);
+}
+
+inline simd_vec4 operator*(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(l.v.f[0] * r.v.f[0], l.v.f[1] * r.v.f[1], l.v.f[2] * r.v.f[2], l.v.f[3] * r.v.f[3]);
+}
+
+inline simd_vec4 operator/(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(l.v.f[0] / r.v.f[0], l.v.f[1] / r.v.f[1], l.v.f[2] / r.v.f[2], l.v.f[3] / r.v.f[3]);
+}
+
+inline simd_vec4 operator-(const simd_vec4& v) {
+	return simd_vec4(-v.v.f[0], -v.v.f[1], -v.v.f[2], -v.v.f[3]);
+}
+
+inline simd_vec4 Min(const simd_vec4& l, const simd_vec4& r) {
+	simd_vec4 result;
+	for (int i = 0; i < 4; ++i) {
+		result.v.f[i] = (r.v.f[i] < l.v.f[i]) ? r.v.f[i] : l.v.f[i];
+	}
+	return result;
+}
+
+inline simd_vec4 Max(const simd_vec4& l, const simd_vec4& r) {
+	simd_vec4 result;
+	for (int i = 0; i < 4; ++i) {
+		result.v.f[i] = (r.v.f[i] > l.v.f[i]) ? r.v.f[i] : l.v.f[i];
+	}
+	return result;
+}
+
+inline simd_vec4 Sqrt(const simd_vec4& v) {
+	return simd_vec4(std::sqrt(v.v.f[0]), std::sqrt(v.v.f[1]), std::sqrt(v.v.f[2]), std::sqrt(v.v.f[3]));
+}
+
+inline bool operator==(const simd_vec4& l, const simd_vec4& r) {
+	return l.v.f[0] == r.v.f[0] && l.v.f[1] == r.v.f[1] && l.v.f[2] == r.v.f[2] && l.v.f[3] == r.v.f[3];
+}
+
+template <int i>
+inline simd_vec4 Splat(const simd_vec4& v) {
+	return simd_vec4(v.v.f[i]);
+}
+
+inline simd_vec4 Cross(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(
+		l.v.f[1] * r.v.f[2] - l.v.f[2] * r.v.f[1],
+		l.v.f[2] * r.v.f[0] - l.v.f[0] * r.v.f[2],
+		l.v.f[0] * r.v.f[1] - l.v.f[1] * r.v.f[0],
+		0.0f);
+}
+
+inline float Dot(const simd_vec4& l, const simd_vec4& r) {
+	return l.v.f[0] * r.v.f[0] + l.v.f[1] * r.v.f[1] + l.v.f[2] * r.v.f[2] + l.v.f[3] * r.v.f[3];
+}
+
+inline simd_vec4 DotSplat(const simd_vec4& l, const simd_vec4& r) {
+	return simd_vec4(Dot(l, r));
+}
+
+#endif
+
+// common code on top of the above
+
+inline float simd_vec4::operator[](int i) const {
+	alignas(16) float f[4];
+	Store(f);
+	return f[i];
+}
+
+inline simd_vec4::operator vec3() const {
+	alignas(16) float f[4];
+	Store(f);
+	return vec3(f[0], f[1], f[2]);
+}
+
+inline simd_vec4 operator*(const simd_vec4& l, float r) { return l * simd_vec4(r); }
+inline simd_vec4 operator*(float l, const simd_vec4& r) { return simd_vec4(l) * r; }
+inline simd_vec4 operator/(const simd_vec4& l, float r) { return l / simd_vec4(r); }
+
+inline simd_vec4& operator+=(simd_vec4& l, const simd_vec4& r) { return l = l + r; }
+inline simd_vec4& operator-=(simd_vec4& l, const simd_vec4& r) { return l = l - r; }
+inline simd_vec4& operator*=(simd_vec4& l, const simd_vec4& r) { return l = l * r; }
+inline simd_vec4& operator*=(simd_vec4& l, float r) { return l = l * r; }
+inline simd_vec4& operator/=(simd_vec4& l, const simd_vec4& r) { return l = l / r; }
+inline simd_vec4& operator/=(simd_vec4& l, float r) { return l = l / r; }
+
+// exact (lane by lane) comparison
+inline bool operator!=(const simd_vec4& l, const simd_vec4& r) { return !(l == r); }
+
+inline float MagnitudeSq(const simd_vec4& v) { return Dot(v, v); }
+inline float Magnitude(const simd_vec4& v) { return std::sqrt(Dot(v, v)); }
+inline float DistanceSq(const simd_vec4& p1, const simd_vec4& p2) { return MagnitudeSq(p1 - p2); }
+inline float Distance(const simd_vec4& p1, const simd_vec4& p2) { return Magnitude(p1 - p2); }
+
+inline simd_vec4 Normalized(const simd_vec4& v) {
+	return v / Sqrt(DotSplat(v, v));
+}
+
+inline void Normalize(simd_vec4& v) {
+	v = Normalized(v);
+}
+
+// reciprocal square root estimate with Newton-Raphson refinement, see NormalizedFast(const vec3&)
+inline simd_vec4 NormalizedFast(const simd_vec4& v) {
+#if defined(__SSE2__)
+	__m128 const x = DotSplat(v, v).v,
+		r = _mm_rsqrt_ps(x);
+	return simd_vec4(_mm_mul_ps(v.v, _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f),
+		_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(r, r))))));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	float32x4_t const x = DotSplat(v, v).v;
+	float32x4_t r = vrsqrteq_f32(x);  // 8 bits, needs two steps
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(x, r), r));
+	return simd_vec4(vmulq_f32(v.v, r));
+#else
+	return Normalized(v);
+#endif
+}
+
+inline simd_mat4::simd_mat4() :
+	row{ simd_vec4(1, 0, 0, 0), simd_vec4(0, 1, 0, 0), simd_vec4(0, 0, 1, 0), simd_vec4(0, 0, 0, 1) } { }
+
+inline simd_mat4::simd_mat4(const mat4& m) :
+	row{ simd_vec4(m._11, m._12, m._13, m._14), simd_vec4(m._21, m._22, m._23, m._24),
+		simd_vec4(m._31, m._32, m._33, m._34), simd_vec4(m._41, m._42, m._43, m._44) } { }
+
+inline simd_mat4::operator mat4() const {
+	mat4 result;
+	for (int i = 0; i < 4; ++i) {
+		row[i].Store(&result.asArray[i * 4]);
+	}
+	return result;
+}
+
+// row vector times matrix (w included)
+inline simd_vec4 operator*(const simd_vec4& vec, const simd_mat4& mat) {
+	return Splat<0>(vec) * mat.row[0] + Splat<1>(vec) * mat.row[1] +
+		Splat<2>(vec) * mat.row[2] + Splat<3>(vec) * mat.row[3];
+}
+
+// vec as point (w = 1), result w is kept for perspective divide
+inline simd_vec4 MultiplyPoint(const simd_vec4& vec, const simd_mat4& mat) {
+	return Splat<0>(vec) * mat.row[0] + Splat<1>(vec) * mat.row[1] +
+		Splat<2>(vec) * mat.row[2] + mat.row[3];
+}
+
+// vec as direction (w = 0)
+inline simd_vec4 MultiplyVector(const simd_vec4& vec, const simd_mat4& mat) {
+	return Splat<0>(vec) * mat.row[0] + Splat<1>(vec) * mat.row[1] +
+		Splat<2>(vec) * mat.row[2];
+}
+
+inline simd_mat4 operator*(const simd_mat4& matrixA, const simd_mat4& matrixB) {
+	return simd_mat4(matrixA.row[0] * matrixB, matrixA.row[1] * matrixB,
+		matrixA.row[2] * matrixB, matrixA.row[3] * matrixB);
+}
+
+inline simd_mat4 operator*(const simd_mat4& matrix, float scalar) {
+	simd_vec4 const s(scalar);
+	return simd_mat4(matrix.row[0] * s, matrix.row[1] * s, matrix.row[2] * s, matrix.row[3] * s);
+}
+
+inline simd_mat4 operator+(const simd_mat4& l, const simd_mat4& r) {
+	return simd_mat4(l.row[0] + r.row[0], l.row[1] + r.row[1], l.row[2] + r.row[2], l.row[3] + r.row[3]);
+}
+
+inline simd_mat4 operator-(const simd_mat4& l, const simd_mat4& r) {
+	return simd_mat4(l.row[0] - r.row[0], l.row[1] - r.row[1], l.row[2] - r.row[2], l.row[3] - r.row[3]);
+}
+
+inline simd_mat4& operator*=(simd_mat4& l, const simd_mat4& r) { return l = l * r; }
+
+inline bool operator==(const simd_mat4& l, const simd_mat4& r) {
+	return l.row[0] == r.row[0] && l.row[1] == r.row[1] && l.row[2] == r.row[2] && l.row[3] == r.row[3];
+}
+
+inline bool operator!=(const simd_mat4& l, const simd_mat4& r) { return !(l == r); }
+
+inline simd_mat4 Transpose(const simd_mat4& matrix) {
+#if defined(__SSE2__)
+	simd_mat4 result = matrix;
+	_MM_TRANSPOSE4_PS(result.row[0].v, result.row[1].v, result.row[2].v, result.row[3].v);
+	return result;
+#else
+	return simd_mat4(Transpose(mat4(matrix)));
+#endif
+}
+
+}  // phys
+
+#endif
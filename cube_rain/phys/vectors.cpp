@@ -2,294 +2,455 @@
 #include "vectors.h"
 #include <cmath>
 #include <cfloat>
+#ifdef __SSE2__
+	#include <emmintrin.h>
+#endif
 
 namespace phys {
 
-float CorrectDegrees(float degrees) {
-	while (degrees > 360.0f) {
-		degrees -= 360.0f;
-	}
-	while (degrees < -360.0f) {
-		degrees += 360.0f;
-	}
-	return degrees;
+template <typename T>
+bool operator==(const basic_vec2<T>& l, const basic_vec2<T>& r) { 
+	return l.x == r.x && l.y == r.y;
 }
 
-#ifndef RAD2DEG
-float RAD2DEG(float radians) {
-	float degrees = radians * 57.295754f;
-	degrees = CorrectDegrees(degrees);
-	return degrees;
-}
-#endif
-#ifndef DEG2RAD
-float DEG2RAD(float degrees) {
-	degrees = CorrectDegrees(degrees);
-	float radians = degrees * 0.0174533f;
-	return radians;
+template <typename T>
+bool operator==(const basic_vec3<T>& l, const basic_vec3<T>& r) {
+	return l.x == r.x && l.y == r.y && l.z == r.z;
 }
-#endif
 
-bool operator==(const vec2& l, const vec2& r) { 
-	return CMP(l.x, r.x) && CMP(l.y, r.y);
+template <typename T>
+bool operator!=(const basic_vec2<T>& l, const basic_vec2<T>& r) {
+	return !(l == r);
 }
 
-bool operator==(const vec3& l, const vec3& r) {
-	return CMP(l.x, r.x) && CMP(l.y, r.y) && CMP(l.z, r.z);
+template <typename T>
+bool operator!=(const basic_vec3<T>& l, const basic_vec3<T>& r) {
+	return !(l == r);
 }
 
-bool operator!=(const vec2& l, const vec2& r) {
-	return !(l == r);
+template <typename T>
+bool ApproxEqual(const basic_vec2<T>& l, const basic_vec2<T>& r, typename basic_vec2<T>::value_type tolerance) {
+	return ApproxEqual(l.x, r.x, tolerance) && ApproxEqual(l.y, r.y, tolerance);
 }
 
-bool operator!=(const vec3& l, const vec3& r) {
-	return !(l == r);
+template <typename T>
+bool ApproxEqual(const basic_vec3<T>& l, const basic_vec3<T>& r, typename basic_vec3<T>::value_type tolerance) {
+	return ApproxEqual(l.x, r.x, tolerance) && ApproxEqual(l.y, r.y, tolerance) && ApproxEqual(l.z, r.z, tolerance);
 }
 
-vec2 operator+(const vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T> operator+(const basic_vec2<T>& l, const basic_vec2<T>& r) {
 	return { l.x + r.x, l.y + r.y };
 }
 
-vec3 operator+(const vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T> operator+(const basic_vec3<T>& l, const basic_vec3<T>& r) {
 	return { l.x + r.x, l.y + r.y, l.z + r.z };
 }
 
-vec2 operator-(const vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T> operator-(const basic_vec2<T>& l, const basic_vec2<T>& r) {
 	return { l.x - r.x, l.y - r.y };
 }
 
-vec3 operator-(const vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T> operator-(const basic_vec3<T>& l, const basic_vec3<T>& r) {
 	return { l.x - r.x, l.y - r.y, l.z - r.z };
 }
 
-vec2 operator*(const vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T> operator*(const basic_vec2<T>& l, const basic_vec2<T>& r) {
 	return { l.x * r.x, l.y * r.y };
 }
 
-vec3 operator*(const vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T> operator*(const basic_vec3<T>& l, const basic_vec3<T>& r) {
 	return { l.x * r.x, l.y * r.y, l.z * r.z };
 }
 
-vec2 operator*(const vec2& l, float r) {
+template <typename T>
+basic_vec2<T> operator*(const basic_vec2<T>& l, typename basic_vec2<T>::value_type r) {
 	return { l.x * r, l.y * r };
 }
 
-vec3 operator*(const vec3& l, float r) {
+template <typename T>
+basic_vec3<T> operator*(const basic_vec3<T>& l, typename basic_vec3<T>::value_type r) {
 	return { l.x * r, l.y * r, l.z * r };
 }
 
-vec2 operator/(const vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T> operator/(const basic_vec2<T>& l, const basic_vec2<T>& r) {
 	return{ l.x / r.x, l.y / r.y };
 }
 
-vec3 operator/(const vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T> operator/(const basic_vec3<T>& l, const basic_vec3<T>& r) {
 	return{ l.x / r.x, l.y / r.y, l.z / r.z };
 }
 
-vec2 operator/(const vec2& l, float r) {
+template <typename T>
+basic_vec2<T> operator/(const basic_vec2<T>& l, typename basic_vec2<T>::value_type r) {
 	return{ l.x / r, l.y / r };
 }
 
-vec3 operator/(const vec3& l, float r) {
+template <typename T>
+basic_vec3<T> operator/(const basic_vec3<T>& l, typename basic_vec3<T>::value_type r) {
 	return{ l.x / r, l.y / r, l.z / r };
 }
 
-std::ostream& operator<<(std::ostream& os, const vec2& m) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const basic_vec2<T>& m) {
 	os << "(" << m.x << ", " << m.y << ")";
 	return os;
 }
 
-std::ostream& operator<<(std::ostream& os, const vec3& m) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const basic_vec3<T>& m) {
 	os << "(" << m.x << ", " << m.y << ", " << m.z << ")";
 	return os;
 }
 
-float Dot(const vec2& l, const vec2& r) {
+template <typename T>
+T Dot(const basic_vec2<T>& l, const basic_vec2<T>& r) {
 	return l.x * r.x + l.y * r.y;
 }
 
-float Dot(const vec3& l, const vec3& r) {
+template <typename T>
+T Dot(const basic_vec3<T>& l, const basic_vec3<T>& r) {
 	return l.x * r.x + l.y * r.y + l.z * r.z;
 }
 
-vec2& operator+=(vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T>& operator+=(basic_vec2<T>& l, const basic_vec2<T>& r) {
 	l.x += r.x;
 	l.y += r.y;
 	return l;
 }
 
-vec2& operator-=(vec2& l, const vec2& r) {
-	l.x -= r.y;
+template <typename T>
+basic_vec2<T>& operator-=(basic_vec2<T>& l, const basic_vec2<T>& r) {
+	l.x -= r.x;
 	l.y -= r.y;
 	return l;
 }
 
-vec2& operator*=(vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T>& operator*=(basic_vec2<T>& l, const basic_vec2<T>& r) {
 	l.x *= r.x;
 	l.y *= r.y;
 	return l;
 }
 
-vec2& operator*=(vec2& l, const float r) {
+template <typename T>
+basic_vec2<T>& operator*=(basic_vec2<T>& l, const typename basic_vec2<T>::value_type r) {
 	l.x *= r;
 	l.y *= r;
 	return l;
 }
 
-vec2& operator/=(vec2& l, const vec2& r) {
+template <typename T>
+basic_vec2<T>& operator/=(basic_vec2<T>& l, const basic_vec2<T>& r) {
 	l.x /= r.x;
 	l.y /= r.y;
 	return l;
 }
 
-vec2& operator/=(vec2& l, const float r) {
+template <typename T>
+basic_vec2<T>& operator/=(basic_vec2<T>& l, const typename basic_vec2<T>::value_type r) {
 	l.x /= r;
 	l.y /= r;
 	return l;
 }
 
-vec3& operator+=(vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T>& operator+=(basic_vec3<T>& l, const basic_vec3<T>& r) {
 	l.x += r.x;
 	l.y += r.y;
 	l.z += r.z;
 	return l;
 }
 
-vec3& operator-=(vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T>& operator-=(basic_vec3<T>& l, const basic_vec3<T>& r) {
 	l.x -= r.x;
 	l.y -= r.y;
 	l.z -= r.z;
 	return l;
 }
 
-vec3& operator*=(vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T>& operator*=(basic_vec3<T>& l, const basic_vec3<T>& r) {
 	l.x *= r.x;
 	l.y *= r.y;
 	l.z *= r.z;
 	return l;
 }
 
-vec3& operator*=(vec3& l, const float r) {
+template <typename T>
+basic_vec3<T>& operator*=(basic_vec3<T>& l, const typename basic_vec3<T>::value_type r) {
 	l.x *= r;
 	l.y *= r;
 	l.z *= r;
 	return l;
 }
 
-vec3& operator/=(vec3& l, const vec3& r) {
+template <typename T>
+basic_vec3<T>& operator/=(basic_vec3<T>& l, const basic_vec3<T>& r) {
 	l.x /= r.x;
 	l.y /= r.y;
 	l.z /= r.z;
 	return l;
 }
 
-vec3& operator/=(vec3& l, const float r) {
+template <typename T>
+basic_vec3<T>& operator/=(basic_vec3<T>& l, const typename basic_vec3<T>::value_type r) {
 	l.x /= r;
 	l.y /= r;
 	l.z /= r;
 	return l;
 }
 
-float Magnitude(const vec2& v) {
-	return sqrtf(Dot(v, v));
+template <typename T>
+T Magnitude(const basic_vec2<T>& v) {
+	return std::sqrt(Dot(v, v));
 }
 
-float Magnitude(const vec3& v) {
-	return sqrtf(Dot(v, v));
+template <typename T>
+T Magnitude(const basic_vec3<T>& v) {
+	return std::sqrt(Dot(v, v));
 }
 
-float MagnitudeSq(const vec2& v) {
+template <typename T>
+T MagnitudeSq(const basic_vec2<T>& v) {
 	return Dot(v, v);
 }
 
-float MagnitudeSq(const vec3& v) {
+template <typename T>
+T MagnitudeSq(const basic_vec3<T>& v) {
 	return Dot(v, v);
 }
 
-float Distance(const vec2& p1, const vec2& p2) {
+template <typename T>
+T Distance(const basic_vec2<T>& p1, const basic_vec2<T>& p2) {
 	return Magnitude(p1 - p2);
 }
 
-float Distance(const vec3& p1, const vec3& p2) {
+template <typename T>
+T Distance(const basic_vec3<T>& p1, const basic_vec3<T>& p2) {
 	return Magnitude(p1 - p2);
 }
 
-float DistanceSq(const vec2& p1, const vec2& p2) {
+template <typename T>
+T DistanceSq(const basic_vec2<T>& p1, const basic_vec2<T>& p2) {
 	return MagnitudeSq(p1 - p2);
 }
 
-float DistanceSq(const vec3& p1, const vec3& p2) {
+template <typename T>
+T DistanceSq(const basic_vec3<T>& p1, const basic_vec3<T>& p2) {
 	return MagnitudeSq(p1 - p2);
 }
 
-vec2 RotateVector(const vec2& vector, float degrees) {
-	degrees = DEG2RAD(degrees);
-	float s = sinf(degrees);
-	float c = cosf(degrees);
+template <typename T>
+basic_vec2<T> RotateVector(const basic_vec2<T>& vector, float degrees) {
+	T s, c;
+	SinCos(Wrap(phys::degrees(degrees)), s, c);
 
-	return vec2(
+	return basic_vec2<T>(
 		vector.x * c - vector.y * s,
 		vector.x * s + vector.y * c
 	);
 }
 
-void Normalize(vec2& v) {
-	v = v * (1.0f / Magnitude(v));
+template <typename T>
+void Normalize(basic_vec2<T>& v) {
+	v = v * (T(1) / Magnitude(v));
+}
+
+template <typename T>
+void Normalize(basic_vec3<T>& v) {
+	v = v * (T(1) / Magnitude(v));
+}
+
+template <typename T>
+basic_vec2<T> Normalized(const basic_vec2<T>& v) {
+	return v * (T(1) / Magnitude(v));
 }
 
-void Normalize(vec3& v) {
-	v = v * (1.0f / Magnitude(v));
+template <typename T>
+basic_vec3<T> Normalized(const basic_vec3<T>& v) {
+	return v * (T(1) / Magnitude(v));
 }
 
-vec2 Normalized(const vec2& v) {
-	return v * (1.0f / Magnitude(v));
+#ifdef __SSE2__
+// one Newton-Raphson step r * (1.5 - 0.5 * x * r^2) on top of the estimate
+static inline __m128 ReciprocalSqrt(__m128 x) {
+	__m128 const r = _mm_rsqrt_ps(x);
+	return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f),
+		_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(r, r))));
 }
-vec3 Normalized(const vec3& v) {
-	return v * (1.0f / Magnitude(v));
+#endif
+
+vec3 NormalizedFast(const vec3& v) {
+#ifdef __SSE2__
+	float const r = _mm_cvtss_f32(ReciprocalSqrt(_mm_set_ss(Dot(v, v))));
+	return vec3(v.x * r, v.y * r, v.z * r);
+#else
+	return Normalized(v);
+#endif
 }
 
-vec3 Cross(const vec3& l, const vec3& r) {
-	vec3 result;
+void NormalizeArray(vec3* v, size_t count) {
+	size_t i = 0;
+#ifdef __SSE2__
+	float* f = &v[0].x;
+	for (; i + 4 <= count; i += 4, f += 12) {
+		// x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+		__m128 a = _mm_loadu_ps(f),
+			b = _mm_loadu_ps(f + 4),
+			c = _mm_loadu_ps(f + 8);
+
+		__m128 const x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0)),
+			y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)),
+			z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+
+		__m128 const r = ReciprocalSqrt(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+
+		// back to per component scale r0 r0 r0 r1 | r1 r1 r2 r2 | r2 r3 r3 r3
+		a = _mm_mul_ps(a, _mm_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 0, 0)));
+		b = _mm_mul_ps(b, _mm_shuffle_ps(r, r, _MM_SHUFFLE(2, 2, 1, 1)));
+		c = _mm_mul_ps(c, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 2)));
+
+		_mm_storeu_ps(f, a);
+		_mm_storeu_ps(f + 4, b);
+		_mm_storeu_ps(f + 8, c);
+	}
+#endif
+	for (; i < count; ++i) {
+		v[i] = NormalizedFast(v[i]);
+	}
+}
+
+template <typename T>
+basic_vec3<T> Cross(const basic_vec3<T>& l, const basic_vec3<T>& r) {
+	basic_vec3<T> result;
 	result.x = l.y * r.z - l.z * r.y;
 	result.y = l.z * r.x - l.x * r.z;
 	result.z = l.x * r.y - l.y * r.x;
 	return result;
 }
 
-float Angle(const vec2& l, const vec2& r) {
-	return acosf(Dot(l, r) / sqrtf(MagnitudeSq(l) * MagnitudeSq(r)));
+template <typename T>
+T Angle(const basic_vec2<T>& l, const basic_vec2<T>& r) {
+	return std::acos(Dot(l, r) / std::sqrt(MagnitudeSq(l) * MagnitudeSq(r)));
 }
 
-float Angle(const vec3& l, const vec3& r) {
-	return acosf(Dot(l, r) / sqrtf(MagnitudeSq(l) * MagnitudeSq(r)));
+template <typename T>
+T Angle(const basic_vec3<T>& l, const basic_vec3<T>& r) {
+	return std::acos(Dot(l, r) / std::sqrt(MagnitudeSq(l) * MagnitudeSq(r)));
 }
 
-vec2 Project(const vec2& length, const vec2& direction) {
-	float dot = Dot(length, direction);
-	float magSq = MagnitudeSq(direction);
+template <typename T>
+basic_vec2<T> Project(const basic_vec2<T>& length, const basic_vec2<T>& direction) {
+	T dot = Dot(length, direction);
+	T magSq = MagnitudeSq(direction);
 	return direction * (dot / magSq);
 }
 
-vec3 Project(const vec3& length, const vec3& direction) {
-	float dot = Dot(length, direction);
-	float magSq = MagnitudeSq(direction);
+template <typename T>
+basic_vec3<T> Project(const basic_vec3<T>& length, const basic_vec3<T>& direction) {
+	T dot = Dot(length, direction);
+	T magSq = MagnitudeSq(direction);
 	return direction * (dot / magSq);
 }
 
-vec2 Perpendicular(const vec2& length, const vec2& direction) {
+template <typename T>
+basic_vec2<T> Perpendicular(const basic_vec2<T>& length, const basic_vec2<T>& direction) {
 	return length - Project(length, direction);
 }
 
-vec3 Perpendicular(const vec3& length, const vec3& direction) {
+template <typename T>
+basic_vec3<T> Perpendicular(const basic_vec3<T>& length, const basic_vec3<T>& direction) {
 	return length - Project(length, direction);
 }
 
-vec2 Reflection(const vec2& sourceVector, const vec2& normal) {
-	return sourceVector - normal * (Dot(sourceVector, normal) *  2.0f );
-}
-
-vec3 Reflection(const vec3& sourceVector, const vec3& normal) {
-	return sourceVector - normal * (Dot(sourceVector, normal) *  2.0f);
-}
+template <typename T>
+basic_vec2<T> Reflection(const basic_vec2<T>& sourceVector, const basic_vec2<T>& normal) {
+	return sourceVector - normal * (Dot(sourceVector, normal) * T(2));
+}
+
+template <typename T>
+basic_vec3<T> Reflection(const basic_vec3<T>& sourceVector, const basic_vec3<T>& normal) {
+	return sourceVector - normal * (Dot(sourceVector, normal) * T(2));
+}
+
+// arithmetic for int, float and double vectors
+#define INSTANTIATE_VECTOR_ARITHMETIC(T) \
+	template basic_vec2<T> operator+(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> operator+(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> operator-(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> operator-(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> operator*(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> operator*(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> operator*(const basic_vec2<T>&, T); \
+	template basic_vec3<T> operator*(const basic_vec3<T>&, T); \
+	template basic_vec2<T> operator/(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> operator/(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> operator/(const basic_vec2<T>&, T); \
+	template basic_vec3<T> operator/(const basic_vec3<T>&, T); \
+	template std::ostream& operator<<(std::ostream&, const basic_vec2<T>&); \
+	template std::ostream& operator<<(std::ostream&, const basic_vec3<T>&); \
+	template bool operator==(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template bool operator==(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template bool operator!=(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template bool operator!=(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T>& operator+=(basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec2<T>& operator-=(basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec2<T>& operator*=(basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec2<T>& operator*=(basic_vec2<T>&, const T); \
+	template basic_vec2<T>& operator/=(basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec2<T>& operator/=(basic_vec2<T>&, const T); \
+	template basic_vec3<T>& operator+=(basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T>& operator-=(basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T>& operator*=(basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T>& operator*=(basic_vec3<T>&, const T); \
+	template basic_vec3<T>& operator/=(basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T>& operator/=(basic_vec3<T>&, const T); \
+	template T Dot(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template T Dot(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template T MagnitudeSq(const basic_vec2<T>&); \
+	template T MagnitudeSq(const basic_vec3<T>&); \
+	template T DistanceSq(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template T DistanceSq(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec3<T> Cross(const basic_vec3<T>&, const basic_vec3<T>&);
+
+// the rest for float and double vectors
+#define INSTANTIATE_VECTOR_FUNCTIONS(T) \
+	INSTANTIATE_VECTOR_ARITHMETIC(T) \
+	template bool ApproxEqual(const basic_vec2<T>&, const basic_vec2<T>&, T); \
+	template bool ApproxEqual(const basic_vec3<T>&, const basic_vec3<T>&, T); \
+	template T Magnitude(const basic_vec2<T>&); \
+	template T Magnitude(const basic_vec3<T>&); \
+	template T Distance(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template T Distance(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> RotateVector(const basic_vec2<T>&, float); \
+	template void Normalize(basic_vec2<T>&); \
+	template void Normalize(basic_vec3<T>&); \
+	template basic_vec2<T> Normalized(const basic_vec2<T>&); \
+	template basic_vec3<T> Normalized(const basic_vec3<T>&); \
+	template T Angle(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template T Angle(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> Project(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> Project(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> Perpendicular(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> Perpendicular(const basic_vec3<T>&, const basic_vec3<T>&); \
+	template basic_vec2<T> Reflection(const basic_vec2<T>&, const basic_vec2<T>&); \
+	template basic_vec3<T> Reflection(const basic_vec3<T>&, const basic_vec3<T>&);
+
+INSTANTIATE_VECTOR_FUNCTIONS(float)
+INSTANTIATE_VECTOR_FUNCTIONS(double)
+INSTANTIATE_VECTOR_ARITHMETIC(int)
+
+#undef INSTANTIATE_VECTOR_FUNCTIONS
+#undef INSTANTIATE_VECTOR_ARITHMETIC
 
 }  // phys
@@ -1,133 +1,223 @@
 #ifndef _H_MATH_VECTORS_
 #define _H_MATH_VECTORS_
 #include <ostream>
+#include <cstddef>
+#include <cmath>
+#include <type_traits>
+#include "angles.h"
 
 namespace phys {
 
-//#define RAD2DEG(x) ((x) * 57.295754f)
-//#define DEG2RAD(x) ((x) * 0.0174533f)
+/*
+Precision generic!
+Vectors and matrices are templates over the component type, the float
+types (vec2, vec3, mat4, ...) are aliases of float instances and the only
+ones GPU uploads know about. Use double (dvec3, dmat4, ...) where float
+precision runs out (large world positions, accumulation) and int (ivec2,
+ivec3) for packed integer data, convert with explicit constructors e.g.
+vec3(dpos) just before upload.
 
-#ifndef RAD2DEG
-float RAD2DEG(float radians);
-#endif 
-#ifndef DEG2RAD
-float DEG2RAD(float degrees);
-#endif
-float CorrectDegrees(float degrees);
+Functions are instantiated for float and double, int vectors support
+arithmetic, comparison, Dot, MagnitudeSq, DistanceSq and Cross.
+*/
+
+template <typename T>
+struct basic_vec2 {
+	typedef T value_type;
 
-typedef struct vec2 {
 	union {
 		struct {
-			float x;
-			float y;
+			T x;
+			T y;
 		};
-		float asArray[2];
+		T asArray[2];
 	};
 
-	inline float& operator[](int i) {
+	inline T& operator[](int i) {
 		return asArray[i];
 	}
 
-	inline vec2() : x(0.0f), y(0.0f) { }
-	inline vec2(float _x, float _y) : x(_x), y(_y) { }
-} vec2;
+	inline basic_vec2() : x(T(0)), y(T(0)) { }
+	inline basic_vec2(T _x, T _y) : x(_x), y(_y) { }
+
+	template <typename U>
+	inline explicit basic_vec2(const basic_vec2<U>& v) : x(T(v.x)), y(T(v.y)) { }
+};
+
+template <typename T>
+struct basic_vec3 {
+	typedef T value_type;
 
-typedef struct vec3 {
 	union {
 		struct {
-			float x;
-			float y;
-			float z;
+			T x;
+			T y;
+			T z;
 		};
-		float asArray[3];
+		T asArray[3];
 	};
 
-	inline float& operator[](int i) {
+	inline T& operator[](int i) {
 		return asArray[i];
 	}
 
-	inline vec3() : x(0.0f), y(0.0f), z(0.0f) { }
-	inline vec3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) { }
+	inline basic_vec3() : x(T(0)), y(T(0)), z(T(0)) { }
+	inline basic_vec3(T _x, T _y, T _z) : x(_x), y(_y), z(_z) { }
+
+	template <typename U>
+	inline explicit basic_vec3(const basic_vec3<U>& v) : x(T(v.x)), y(T(v.y)), z(T(v.z)) { }
+};
+
+typedef basic_vec2<float> vec2;
+typedef basic_vec3<float> vec3;
+typedef basic_vec2<double> dvec2;
+typedef basic_vec3<double> dvec3;
+typedef basic_vec2<int> ivec2;
+typedef basic_vec3<int> ivec3;
 
-} vec3;
+// scalar parameters are not deduced, so vec3 * 2 works
+template <typename T> basic_vec2<T> operator+(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec3<T> operator+(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 operator+(const vec2& l, const vec2& r);
-vec3 operator+(const vec3& l, const vec3& r);
+template <typename T> basic_vec2<T> operator-(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec3<T> operator-(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 operator-(const vec2& l, const vec2& r);
-vec3 operator-(const vec3& l, const vec3& r);
+template <typename T> basic_vec2<T> operator*(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec3<T> operator*(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 operator*(const vec2& l, const vec2& r);
-vec3 operator*(const vec3& l, const vec3& r);
+template <typename T> basic_vec2<T> operator*(const basic_vec2<T>& l, typename basic_vec2<T>::value_type r);
+template <typename T> basic_vec3<T> operator*(const basic_vec3<T>& l, typename basic_vec3<T>::value_type r);
 
-vec2 operator*(const vec2& l, float r);
-vec3 operator*(const vec3& l, float r);
+template <typename T> basic_vec2<T> operator/(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec3<T> operator/(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 operator/(const vec2& l, const vec2& r);
-vec3 operator/(const vec3& l, const vec3& r);
+template <typename T> basic_vec2<T> operator/(const basic_vec2<T>& l, typename basic_vec2<T>::value_type r);
+template <typename T> basic_vec3<T> operator/(const basic_vec3<T>& l, typename basic_vec3<T>::value_type r);
 
-vec2 operator/(const vec2& l, float r);
-vec3 operator/(const vec3& l, float r);
+template <typename T> std::ostream& operator<<(std::ostream& os, const basic_vec2<T>& m);
+template <typename T> std::ostream& operator<<(std::ostream& os, const basic_vec3<T>& m);
 
-std::ostream& operator<<(std::ostream& os, const vec2& m);
-std::ostream& operator<<(std::ostream& os, const vec3& m);
+template <typename T> bool operator==(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> bool operator==(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-bool operator==(const vec2& l, const vec2& r);
-bool operator==(const vec3& l, const vec3& r);
+template <typename T> bool operator!=(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> bool operator!=(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-bool operator!=(const vec2& l, const vec2& r);
-bool operator!=(const vec3& l, const vec3& r);
+// operator== is exact (cheap change detection), compare computed values with
+// ApproxEqual(), tolerance is absolute (CMP uses 0.005)
+template <typename T> bool ApproxEqual(const basic_vec2<T>& l, const basic_vec2<T>& r, typename basic_vec2<T>::value_type tolerance = 0.005f);
+template <typename T> bool ApproxEqual(const basic_vec3<T>& l, const basic_vec3<T>& r, typename basic_vec3<T>::value_type tolerance = 0.005f);
 
-vec2& operator+=(vec2& l, const vec2& r);
-vec2& operator-=(vec2& l, const vec2& r);
-vec2& operator*=(vec2& l, const vec2& r);
-vec2& operator*=(vec2& l, const float r);
-vec2& operator/=(vec2& l, const vec2& r);
-vec2& operator/=(vec2& l, const float r);
+template <typename T> basic_vec2<T>& operator+=(basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec2<T>& operator-=(basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec2<T>& operator*=(basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec2<T>& operator*=(basic_vec2<T>& l, const typename basic_vec2<T>::value_type r);
+template <typename T> basic_vec2<T>& operator/=(basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> basic_vec2<T>& operator/=(basic_vec2<T>& l, const typename basic_vec2<T>::value_type r);
 
-vec3& operator+=(vec3& l, const vec3& r);
-vec3& operator-=(vec3& l, const vec3& r);
-vec3& operator*=(vec3& l, const vec3& r);
-vec3& operator*=(vec3& l, const float r);
-vec3& operator/=(vec3& l, const vec3& r);
-vec3& operator/=(vec3& l, const float r);
+template <typename T> basic_vec3<T>& operator+=(basic_vec3<T>& l, const basic_vec3<T>& r);
+template <typename T> basic_vec3<T>& operator-=(basic_vec3<T>& l, const basic_vec3<T>& r);
+template <typename T> basic_vec3<T>& operator*=(basic_vec3<T>& l, const basic_vec3<T>& r);
+template <typename T> basic_vec3<T>& operator*=(basic_vec3<T>& l, const typename basic_vec3<T>::value_type r);
+template <typename T> basic_vec3<T>& operator/=(basic_vec3<T>& l, const basic_vec3<T>& r);
+template <typename T> basic_vec3<T>& operator/=(basic_vec3<T>& l, const typename basic_vec3<T>::value_type r);
 
-float Dot(const vec2& l, const vec2& r);
-float Dot(const vec3& l, const vec3& r);
+template <typename T> T Dot(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> T Dot(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-float Magnitude(const vec2& v);
-float Magnitude(const vec3& v);
+template <typename T> T Magnitude(const basic_vec2<T>& v);
+template <typename T> T Magnitude(const basic_vec3<T>& v);
 
-float MagnitudeSq(const vec2& v);
-float MagnitudeSq(const vec3& v);
+template <typename T> T MagnitudeSq(const basic_vec2<T>& v);
+template <typename T> T MagnitudeSq(const basic_vec3<T>& v);
 
-float Distance(const vec2& p1, const vec2& p2);
-float Distance(const vec3& p1, const vec3& p2);
+template <typename T> T Distance(const basic_vec2<T>& p1, const basic_vec2<T>& p2);
+template <typename T> T Distance(const basic_vec3<T>& p1, const basic_vec3<T>& p2);
 
-float DistanceSq(const vec2& p1, const vec2& p2);
-float DistanceSq(const vec3& p1, const vec3& p2);
+template <typename T> T DistanceSq(const basic_vec2<T>& p1, const basic_vec2<T>& p2);
+template <typename T> T DistanceSq(const basic_vec3<T>& p1, const basic_vec3<T>& p2);
 
-vec2 RotateVector(const vec2& vector, float degrees);
+template <typename T> basic_vec2<T> RotateVector(const basic_vec2<T>& vector, float degrees);
 
-void Normalize(vec2& v);
-void Normalize(vec3& v);
+template <typename T> void Normalize(basic_vec2<T>& v);
+template <typename T> void Normalize(basic_vec3<T>& v);
 
-vec2 Normalized(const vec2& v);
-vec3 Normalized(const vec3& v);
+template <typename T> basic_vec2<T> Normalized(const basic_vec2<T>& v);
+template <typename T> basic_vec3<T> Normalized(const basic_vec3<T>& v);
 
-vec3 Cross(const vec3& l, const vec3& r);
+/*
+Fast normalization for float vectors: reciprocal square root estimate
+(rsqrtps, 12 bits) refined by one Newton-Raphson step. Length of the result
+is within 4e-7 of 1 (exact Normalized() within 2e-7). Zero vectors give NaN
+the same way, so do vectors shorter than 1e-19 (denormal squared length).
+Without SSE2 they are exact.
+*/
+vec3 NormalizedFast(const vec3& v);
+void NormalizeArray(vec3* v, size_t count);  // in place, 4 vectors at once
 
-float Angle(const vec2& l, const vec2& r);
-float Angle(const vec3& l, const vec3& r);
+template <typename T> basic_vec3<T> Cross(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 Project(const vec2& length, const vec2& direction);
-vec3 Project(const vec3& length, const vec3& direction);
+template <typename T> T Angle(const basic_vec2<T>& l, const basic_vec2<T>& r);
+template <typename T> T Angle(const basic_vec3<T>& l, const basic_vec3<T>& r);
 
-vec2 Perpendicular(const vec2& length, const vec2& direction);
-vec3 Perpendicular(const vec3& length, const vec3& direction);
+template <typename T> basic_vec2<T> Project(const basic_vec2<T>& length, const basic_vec2<T>& direction);
+template <typename T> basic_vec3<T> Project(const basic_vec3<T>& length, const basic_vec3<T>& direction);
 
-vec2 Reflection(const vec2& sourceVector, const vec2& normal);
-vec3 Reflection(const vec3& sourceVector, const vec3& normal);
+template <typename T> basic_vec2<T> Perpendicular(const basic_vec2<T>& length, const basic_vec2<T>& direction);
+template <typename T> basic_vec3<T> Perpendicular(const basic_vec3<T>& length, const basic_vec3<T>& direction);
+
+template <typename T> basic_vec2<T> Reflection(const basic_vec2<T>& sourceVector, const basic_vec2<T>& normal);
+template <typename T> basic_vec3<T> Reflection(const basic_vec3<T>& sourceVector, const basic_vec3<T>& normal);
+
+/*
+Fused operations!
+Inline so chains like position + direction * (speed * dt) compile to straight
+line code without temporaries, a * b + c is a single FMA instruction when the
+target has one (-mfma) and a multiply and an add otherwise.
+
+target = Madd(right, -pan * dt, target);
+*/
+
+template <typename T>
+inline T Madd(T a, T b, T c) {
+#ifdef __FMA__
+	if constexpr (std::is_floating_point<T>::value) {
+		return std::fma(a, b, c);
+	}
+#endif
+	return a * b + c;
+}
+
+template <typename T>
+inline basic_vec2<T> Madd(const basic_vec2<T>& a, const basic_vec2<T>& b, const basic_vec2<T>& c) {
+	return { Madd(a.x, b.x, c.x), Madd(a.y, b.y, c.y) };
+}
+
+template <typename T>
+inline basic_vec3<T> Madd(const basic_vec3<T>& a, const basic_vec3<T>& b, const basic_vec3<T>& c) {
+	return { Madd(a.x, b.x, c.x), Madd(a.y, b.y, c.y), Madd(a.z, b.z, c.z) };
+}
+
+template <typename T>
+inline basic_vec2<T> Madd(const basic_vec2<T>& a, typename basic_vec2<T>::value_type b, const basic_vec2<T>& c) {
+	return { Madd(a.x, b, c.x), Madd(a.y, b, c.y) };
+}
+
+template <typename T>
+inline basic_vec3<T> Madd(const basic_vec3<T>& a, typename basic_vec3<T>::value_type b, const basic_vec3<T>& c) {
+	return { Madd(a.x, b, c.x), Madd(a.y, b, c.y), Madd(a.z, b, c.z) };
+}
+
+// a + (b - a) * t, exact a for t = 0
+template <typename T>
+inline basic_vec2<T> Lerp(const basic_vec2<T>& a, const basic_vec2<T>& b, typename basic_vec2<T>::value_type t) {
+	return { Madd(b.x - a.x, t, a.x), Madd(b.y - a.y, t, a.y) };
+}
+
+template <typename T>
+inline basic_vec3<T> Lerp(const basic_vec3<T>& a, const basic_vec3<T>& b, typename basic_vec3<T>::value_type t) {
+	return { Madd(b.x - a.x, t, a.x), Madd(b.y - a.y, t, a.y), Madd(b.z - a.z, t, a.z) };
+}
 
 }  // phys
 
@@ -0,0 +1,130 @@
+#include <utility>
+#include "glt/cpu_profiler.hpp"
+#include "render_thread.hpp"
+
+using std::mutex,
+	std::unique_lock,
+	std::lock_guard,
+	std::move;
+
+gui_frame::~gui_frame()
+{
+	for (ImDrawList * list : _lists)
+		IM_DELETE(list);
+}
+
+void gui_frame::copy(ImDrawData const * src)
+{
+	if (!src || !src->Valid)
+	{
+		_data.Clear();
+		return;
+	}
+
+	// reuse lists allocated in previous frames
+	for (int i = (int)_lists.size(); i < src->CmdListsCount; ++i)
+		_lists.push_back(IM_NEW(ImDrawList)(src->CmdLists[i]->_Data));
+
+	for (int i = 0; i < src->CmdListsCount; ++i)
+	{
+		ImDrawList const * from = src->CmdLists[i];
+		ImDrawList * to = _lists[i];
+		to->CmdBuffer = from->CmdBuffer;
+		to->IdxBuffer = from->IdxBuffer;
+		to->VtxBuffer = from->VtxBuffer;
+		to->Flags = from->Flags;
+	}
+
+	_data = *src;
+	_data.CmdLists = _lists.data();
+}
+
+ImDrawData * gui_frame::draw_data()
+{
+	return _data.Valid ? &_data : nullptr;
+}
+
+render_thread::render_thread(GLFWwindow * window, init_function init,
+	render_function render, shutdown_function shutdown)
+	: _window{window}
+	, _init{move(init)}
+	, _render{move(render)}
+	, _shutdown{move(shutdown)}
+	, _write{0}
+	, _pending{-1}
+	, _busy{false}
+	, _quit{false}
+{
+	_thread = std::thread{&render_thread::loop, this};
+}
+
+render_thread::~render_thread()
+{
+	stop();
+}
+
+render_packet & render_thread::packet()
+{
+	return _packets[_write];
+}
+
+void render_thread::submit()
+{
+	GLT_PROFILE_ZONE("wait render thread");
+
+	unique_lock<mutex> lock{_locker};
+	_cond.wait(lock, [this]{return _pending == -1 && !_busy;});  // previous frame done
+
+	_pending = _write;
+	_write = 1 - _write;
+	_cond.notify_all();
+}
+
+void render_thread::stop()
+{
+	if (!_thread.joinable())
+		return;
+
+	{
+		lock_guard<mutex> lock{_locker};
+		_quit = true;
+	}
+	_cond.notify_all();
+
+	_thread.join();
+}
+
+void render_thread::loop()
+{
+	glt::profile::thread_name("render");
+
+	glfwMakeContextCurrent(_window);
+	_init();
+
+	while (true)
+	{
+		int idx = -1;
+		{
+			GLT_PROFILE_ZONE("wait packet");
+			unique_lock<mutex> lock{_locker};
+			_cond.wait(lock, [this]{return _pending != -1 || _quit;});
+			if (_pending == -1)
+				break;  // quit and nothing to draw
+
+			idx = _pending;
+			_pending = -1;
+			_busy = true;
+		}
+
+		_render(_packets[idx]);
+
+		{
+			lock_guard<mutex> lock{_locker};
+			_busy = false;
+		}
+		_cond.notify_all();
+	}
+
+	_shutdown();
+	glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "imgui/imgui.h"
+#include "glt/opengl.hpp"
+#include "phys/matrices.h"
+
+//! Deep copy of ImGui draw data, so it can be rendered from other thread.
+class gui_frame
+{
+public:
+	gui_frame() = default;
+	~gui_frame();
+	void copy(ImDrawData const * src);
+	ImDrawData * draw_data();  //!< \return nullptr if nothing to draw
+
+	gui_frame(gui_frame const &) = delete;
+	void operator=(gui_frame const &) = delete;
+
+private:
+	std::vector<ImDrawList *> _lists;  //!< reused between frames
+	ImDrawData _data;
+};
+
+//! Falling cube instance data (matches instance attribute of gles2::instanced_shaded_shader).
+struct cube_instance
+{
+	phys::vec3 position;
+	float scale;
+};
+
+/*! Falling cube rotation matrix rows, local x, y and z axes in world space
+(matches rotation attributes of gles2::instanced_shaded_shader). */
+struct cube_rotation
+{
+	phys::vec3 x, y, z;
+};
+
+/*! Cube level of detail, packet cubes are grouped by LOD in this order. Mid
+range cubes are drawn with only 3 faces visible from the camera, the faces
+are picked by octant of camera position relative to cube (x, y and z in bits
+0, 1 and 2 set for camera in positive direction). */
+namespace cube_lod {
+
+constexpr unsigned full = 0,
+	faces = 1,  //!< faces + octant
+	impostor = 9,
+	count = 10;
+
+}  // cube_lod
+
+//! Everything render thread needs to draw a frame.
+struct render_packet
+{
+	phys::mat4 world_to_screen;
+	phys::vec3 light_direction;
+	bool overdraw;  //!< overdraw debug mode (additive blending, fragments counted)
+	bool ground;  //!< draw ground plane
+	std::vector<cube_instance> cubes;  //!< grouped by LOD
+	std::vector<cube_rotation> rotations;  //!< rotations of cubes (same order) or empty for axis aligned cubes
+	int highlight;  //!< index of highlighted (picked) cube in cubes or -1, instanced drawing only
+	unsigned lod_counts[cube_lod::count];  //!< number of cubes per LOD
+	float point_scale;  //!< size in pixels of the unit at unit depth (for impostors)
+	unsigned gpu_cubes;  //!< number of cubes simulated on GPU (cubes and lod_counts are not used if nonzero)
+	float dt;  //!< GPU simulation time step
+	gui_frame gui;
+};
+
+/*! Render thread owning OpenGL context.
+
+Main thread fills packet() for frame N+1 while render thread submits frame N,
+then calls submit() which waits until render thread is done with frame N (so
+latency is bounded to one frame) and hands the packet over. Packets are double
+buffered.
+
+\note Context needs to be released (glfwMakeContextCurrent(nullptr)) by the
+calling thread before render_thread is created. */
+class render_thread
+{
+public:
+	using init_function = std::function<void ()>;
+	using render_function = std::function<void (render_packet &)>;  //!< packet is owned by render thread during the call
+	using shutdown_function = std::function<void ()>;
+
+	/*! Init and shutdown are called from render thread with context current
+	(create/destroy GL resources there). */
+	render_thread(GLFWwindow * window, init_function init, render_function render,
+		shutdown_function shutdown);
+	~render_thread();
+
+	render_packet & packet();  //!< packet to fill by main thread
+	void submit();  //!< hands packet() over to render thread
+	void stop();  //!< finishes submitted packet and joins render thread
+
+	render_thread(render_thread const &) = delete;
+	void operator=(render_thread const &) = delete;
+
+private:
+	void loop();
+
+	GLFWwindow * _window;
+	init_function _init;
+	render_function _render;
+	shutdown_function _shutdown;
+
+	render_packet _packets[2];
+	unsigned _write;  //!< index of packet filled by main thread
+	int _pending;  //!< index of submitted packet or -1
+	bool _busy,  //!< render thread is drawing a packet
+		_quit;
+	std::mutex _locker;
+	std::condition_variable _cond;
+	std::thread _thread;
+};
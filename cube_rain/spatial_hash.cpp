@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <cmath>
+#include "glt/cpu_profiler.hpp"
+#include "spatial_hash.hpp"
+
+using std::vector,
+	std::fill,
+	std::floor;
+using phys::vec3;
+
+constexpr unsigned min_key_bits = 6,
+	max_key_bits = 20;
+
+spatial_hash::spatial_hash(float cell_size)
+	: _inv_cell_size{1.0f / cell_size}
+	, _key_bits{min_key_bits}
+{}
+
+void spatial_hash::build(job_system & jobs, vector<vec3> const & positions,
+	vector<uint32_t> const & bodies)
+{
+	GLT_PROFILE_ZONE("spatial_hash::build");
+
+	// table with at least twice as many buckets as bodies
+	_key_bits = min_key_bits;
+	while ((1u << _key_bits) < 2*bodies.size() && _key_bits < max_key_bits)
+		++_key_bits;
+
+	_items.resize(bodies.size());
+	jobs.parallel_for(bodies.size(), 1024, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+			_items[i] = sort_item{key(cell_of(positions[bodies[i]])), bodies[i]};
+	});
+
+	parallel_radix_sort(jobs, _items, _temp, _key_bits);
+
+	// first item of each key
+	_starts.resize((1u << _key_bits) + 1);
+	fill(begin(_starts), end(_starts), 0);
+	for (sort_item const & item : _items)
+		++_starts[item.key + 1];
+
+	for (size_t i = 1; i < _starts.size(); ++i)
+		_starts[i] += _starts[i-1];
+
+	_cells.resize(_items.size());
+	jobs.parallel_for(_items.size(), 1024, [&](size_t first, size_t last){
+		for (size_t i = first; i < last; ++i)
+			_cells[i] = cell_of(positions[_items[i].index]);
+	});
+}
+
+size_t spatial_hash::size() const
+{
+	return _items.size();
+}
+
+spatial_hash::cell spatial_hash::cell_of(vec3 const & p) const
+{
+	return cell{
+		(int)floor(p.x * _inv_cell_size),
+		(int)floor(p.y * _inv_cell_size),
+		(int)floor(p.z * _inv_cell_size)};
+}
+
+uint32_t spatial_hash::key(cell const & c) const
+{
+	// large primes hash (Teschner et al. 2003)
+	uint32_t const h = (uint32_t(c.x) * 73856093u) ^ (uint32_t(c.y) * 19349663u)
+		^ (uint32_t(c.z) * 83492791u);
+	return h & ((1u << _key_bits) - 1);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "phys/vectors.h"
+#include "job_system.hpp"
+#include "parallel_sort.hpp"
+
+/*! Uniform grid spatial hash of points (e.g. body centers).
+
+Each build() computes hashed cell key for every point in parallel, sorts
+points by key with parallel_radix_sort() (counting sort passes) and finds
+first point of each hash bucket, no per frame allocation once buffers grow.
+Objects smaller than cell size which overlap are in neighbouring cells, see
+query().
+
+\code
+spatial_hash grid{0.6f};
+grid.build(jobs, positions, bodies);
+grid.query(p, [](uint32_t body){...});  // bodies in 3x3x3 cells around p
+\endcode */
+class spatial_hash
+{
+public:
+	explicit spatial_hash(float cell_size);
+
+	/*! \param positions indexed by body
+	\param bodies indices of bodies to insert */
+	void build(job_system & jobs, std::vector<phys::vec3> const & positions,
+		std::vector<uint32_t> const & bodies);
+
+	/*! Calls f(body) for each body in 3x3x3 cells around p.
+	\note Can be called from more threads at once. */
+	template <typename F>
+	void query(phys::vec3 const & p, F && f) const;
+
+	size_t size() const;  //!< number of bodies in hash
+
+private:
+	struct cell
+	{
+		int x, y, z;
+	};
+
+	cell cell_of(phys::vec3 const & p) const;
+	uint32_t key(cell const & c) const;
+
+	float _inv_cell_size;
+	unsigned _key_bits;
+	std::vector<sort_item> _items,  //!< (key, body) sorted by key
+		_temp;
+	std::vector<uint32_t> _starts;  //!< first item for key, 1 << _key_bits + 1 elements
+	std::vector<cell> _cells;  //!< cell of item (to skip hash collisions)
+};
+
+template <typename F>
+void spatial_hash::query(phys::vec3 const & p, F && f) const
+{
+	if (_items.empty())
+		return;
+
+	cell const c = cell_of(p);
+	for (int dz = -1; dz <= 1; ++dz)
+		for (int dy = -1; dy <= 1; ++dy)
+			for (int dx = -1; dx <= 1; ++dx)
+			{
+				cell const n{c.x + dx, c.y + dy, c.z + dz};
+				uint32_t const k = key(n);
+				for (uint32_t i = _starts[k]; i < _starts[k+1]; ++i)
+				{
+					cell const & ic = _cells[i];
+					if (ic.x == n.x && ic.y == n.y && ic.z == n.z)  // not a collision
+						f(_items[i].index);
+				}
+			}
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include "glt/cpu_profiler.hpp"
+#include "sweep_and_prune.hpp"
+
+using std::vector,
+	std::sort;
+using phys::vec3;
+
+constexpr float axis_hysteresis = 2.0f;  // other axis needs to be that much more spread to switch
+
+sweep_and_prune::sweep_and_prune()
+	: _centers{nullptr}
+	, _half_sizes{nullptr}
+	, _margin{0}
+	, _axis{1}  // y for falling cubes
+	, _swaps{0}
+{}
+
+void sweep_and_prune::update(vector<vec3> const & centers, vector<float> const & half_sizes,
+	float margin)
+{
+	GLT_PROFILE_ZONE("sweep_and_prune::update");
+
+	_centers = &centers;
+	_half_sizes = &half_sizes;
+	_margin = margin;
+	_swaps = 0;
+
+	unsigned const axis = select_axis(centers);
+	bool resort = axis != _axis || _endpoints.size() != centers.size();
+	_axis = axis;
+
+	if (_endpoints.size() != centers.size())  // boxes added or removed
+	{
+		_endpoints.resize(centers.size());
+		for (uint32_t i = 0; i < _endpoints.size(); ++i)
+			_endpoints[i].box = i;
+	}
+
+	for (endpoint & e : _endpoints)
+		e.min = centers[e.box].asArray[_axis] - half_sizes[e.box] - margin;
+
+	if (resort)
+	{
+		sort(begin(_endpoints), end(_endpoints),
+			[](endpoint const & a, endpoint const & b){return a.min < b.min;});
+		return;
+	}
+
+	// insertion sort, boxes move only a bit between updates
+	for (size_t i = 1; i < _endpoints.size(); ++i)
+	{
+		endpoint const e = _endpoints[i];
+		size_t j = i;
+		for (; j > 0 && _endpoints[j-1].min > e.min; --j)
+			_endpoints[j] = _endpoints[j-1];
+
+		_endpoints[j] = e;
+		_swaps += i - j;
+	}
+}
+
+vector<sweep_and_prune::pair> const & sweep_and_prune::find_pairs(vector<uint8_t> const & passive)
+{
+	GLT_PROFILE_ZONE("sweep_and_prune::find_pairs");
+
+	_pairs.clear();
+	vector<vec3> const & centers = *_centers;
+	vector<float> const & half_sizes = *_half_sizes;
+	unsigned const u = (_axis + 1) % 3,  // remaining axes
+		v = (_axis + 2) % 3;
+
+	for (size_t i = 0; i < _endpoints.size(); ++i)
+	{
+		uint32_t const a = _endpoints[i].box;
+		vec3 const & ca = centers[a];
+		// only endpoints are inflated, so boxes pair when closer than margin (same as spatial hash)
+		float const ra = half_sizes[a],
+			max = ca.asArray[_axis] + ra;
+
+		for (size_t j = i + 1; j < _endpoints.size() && _endpoints[j].min < max; ++j)
+		{
+			uint32_t const b = _endpoints[j].box;
+			if (passive[a] && passive[b])
+				continue;
+
+			vec3 const & cb = centers[b];
+			float const r = ra + half_sizes[b] + _margin;
+			if (fabsf(ca.asArray[u] - cb.asArray[u]) < r && fabsf(ca.asArray[v] - cb.asArray[v]) < r)
+				_pairs.push_back(pair{a, b});
+		}
+	}
+
+	return _pairs;
+}
+
+unsigned sweep_and_prune::axis() const
+{
+	return _axis;
+}
+
+unsigned sweep_and_prune::swaps() const
+{
+	return _swaps;
+}
+
+unsigned sweep_and_prune::select_axis(vector<vec3> const & centers) const
+{
+	if (centers.empty())
+		return _axis;
+
+	// variance of centers per axis
+	vec3 sum, sum_sq;
+	for (vec3 const & c : centers)
+	{
+		sum = sum + c;
+		sum_sq = sum_sq + c*c;
+	}
+
+	float const n = centers.size();
+	float variance[3];
+	for (int a = 0; a < 3; ++a)
+		variance[a] = sum_sq.asArray[a]/n - (sum.asArray[a]/n)*(sum.asArray[a]/n);
+
+	unsigned best = _axis;
+	for (unsigned a = 0; a < 3; ++a)
+		if (variance[a] > axis_hysteresis * variance[best])
+			best = a;
+
+	return best;
+}
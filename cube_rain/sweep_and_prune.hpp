@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "phys/vectors.h"
+
+/*! Sweep and prune broadphase for cubes (axis aligned boxes given by center
+and half size).
+
+Boxes are kept sorted by their minimum along sweep axis across updates, the
+order is repaired with insertion sort which is close to O(n) for coherent
+motion. Then sorted list is swept and boxes overlapping along sweep axis are
+tested on the remaining two axes. Sweep axis is the axis with the biggest
+spread of box centers (switched with hysteresis, full sort then). Buffers are
+reused, there is no allocation once they grow.
+
+\code
+sweep_and_prune sap;
+// each step
+sap.update(centers, half_sizes, margin);
+for (sweep_and_prune::pair const & p : sap.find_pairs(passive))
+	...
+\endcode */
+class sweep_and_prune
+{
+public:
+	struct pair
+	{
+		uint32_t a, b;
+	};
+
+	sweep_and_prune();
+
+	/*! Updates box order, box i is given by centers[i] and half_sizes[i].
+	\param margin boxes closer than margin are paired too (gap along all axes) */
+	void update(std::vector<phys::vec3> const & centers, std::vector<float> const & half_sizes,
+		float margin);
+
+	/*! \param passive pairs of two passive boxes (e.g. sleeping) are skipped
+	\return overlapping boxes (valid till next call) */
+	std::vector<pair> const & find_pairs(std::vector<uint8_t> const & passive);
+
+	unsigned axis() const;  //!< sweep axis (0 for x, 1 for y, 2 for z)
+	unsigned swaps() const;  //!< insertion sort swaps in last update()
+
+private:
+	struct endpoint
+	{
+		float min;  //!< box minimum along sweep axis
+		uint32_t box;
+	};
+
+	unsigned select_axis(std::vector<phys::vec3> const & centers) const;
+
+	std::vector<endpoint> _endpoints;  //!< sorted by min
+	std::vector<phys::vec3> const * _centers;
+	std::vector<float> const * _half_sizes;
+	std::vector<pair> _pairs;
+	float _margin;
+	unsigned _axis,
+		_swaps;
+};
@@ -31,6 +31,7 @@ using phys::mat4,
 	phys::Projection, 
 	phys::Translation,
 	phys::Scale,
+	phys::ScaleTranslate,
 	phys::YRotation,
 	phys::ZRotation,
 	phys::Inverse,
@@ -357,7 +358,7 @@ int main(int argc, char * argv[])
 		// light source
 		constexpr float light_distance = 5.f;
 		flat.model_color(light_source_color);
-		mat4 M_light = Scale(vec3{0.1f, 0.1f, 0.1f}) * Translation(light_direction * light_distance);
+		mat4 M_light = ScaleTranslate(0.1f, light_direction * light_distance);
 		flat.local_to_world(M_light);
 		draw_triangles(cube_positions_vbo, flat.position_location(), 12);
 
@@ -0,0 +1,75 @@
+// phys angles test, fused sine/cosine against std::sin/cos and range reduction
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cassert>
+#include "phys/angles.h"
+
+using std::cout, std::endl;
+using std::vector;
+using phys::radians,
+	phys::degrees,
+	phys::SinCos,
+	phys::Wrap,
+	phys::CorrectDegrees,
+	phys::PI;
+using namespace phys::literals;
+
+constexpr float sincos_error = 2e-7f;  // documented bound for |angle| < 8192
+
+static_assert(radians{180_deg}.value == PI);
+static_assert(degrees{0.5_rad}.value > 28.64f && degrees{0.5_rad}.value < 28.65f);
+
+float error(float value, double expected)
+{
+	return (float)std::fabs((double)value - expected);
+}
+
+int main(int argc, char * argv[])
+{
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> angle{-8192, 8192};
+
+	vector<float> as(1003);  // not multiple of 4, tail is padded
+	for (float & a : as)
+		a = angle(rand);
+	as[0] = 0.0f;
+	as[1] = PI/2;
+	as[2] = -PI;
+
+	vector<float> s(as.size()), c(as.size());
+	SinCos(as.data(), s.data(), c.data(), as.size());
+
+	for (size_t i = 0; i < as.size(); ++i)
+	{
+		double const expected_s = std::sin((double)as[i]),
+			expected_c = std::cos((double)as[i]);
+
+		float one_s, one_c;
+		SinCos(radians{as[i]}, one_s, one_c);
+		assert(error(one_s, expected_s) <= sincos_error);
+		assert(error(one_c, expected_c) <= sincos_error);
+		assert(error(s[i], expected_s) <= sincos_error);
+		assert(error(c[i], expected_c) <= sincos_error);
+	}
+
+	// wrap is constant time and keeps huge angles accurate
+	assert(Wrap(degrees{540.0f}).value == 180.0f || Wrap(degrees{540.0f}).value == -180.0f);
+	assert(Wrap(degrees{-30.0f}).value == -30.0f);
+	assert(Wrap(degrees{1e6f}).value == -80.0f);  // 1e6 = 2778*360 - 80
+	assert(std::fabs(Wrap(radians{3*PI + 0.25f}).value - (0.25f - PI)) < 1e-5f);
+	assert(Wrap(degrees{1e30f}).value >= -180.0f && Wrap(degrees{1e30f}).value <= 180.0f);
+
+	assert(CorrectDegrees(725.0f) == 5.0f);
+	assert(CorrectDegrees(-725.0f) == -5.0f);
+	assert(std::fabs(CorrectDegrees(1e9f)) < 360.0f);
+
+	float big_s, big_c;
+	SinCos(Wrap(degrees{1e6f}), big_s, big_c);  // sin(-80 deg)
+	assert(error(big_s, std::sin(-80.0 * M_PI/180.0)) <= sincos_error);
+	assert(error(big_c, std::cos(-80.0 * M_PI/180.0)) <= sincos_error);
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,57 @@
+// phys collision module test, box overlaps and minimum translation
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include "phys/Compare.h"
+#include "phys/collision.h"
+
+using std::cout, std::endl;
+using phys::vec3,
+	phys::AABB,
+	phys::OBB,
+	phys::Ray,
+	phys::CollisionManifold,
+	phys::YRotation3x3,
+	phys::ApproxEqual,
+	phys::AlmostEqualRelativeAndAbs;  // CMP
+
+int main(int argc, char * argv[])
+{
+	AABB const a{vec3{0,0,0}, vec3{1,1,1}};
+
+	assert(AABBAABB(a, AABB{vec3{1.5f,0,0}, vec3{1,1,1}}));
+	assert(!AABBAABB(a, AABB{vec3{2.5f,0,0}, vec3{1,1,1}}));
+
+	// box rotated by 45 degrees reaches further (half diagonal is sqrt(2))
+	OBB const rotated{vec3{2.3f,0,0}, vec3{1,1,1}, YRotation3x3(45)};
+	assert(AABBOBB(a, rotated));
+	assert(!AABBOBB(a, OBB{vec3{2.3f,0,0}, vec3{1,1,1}}));
+	assert(OBBOBB(OBB{vec3{0,0,0}, vec3{1,1,1}}, rotated));
+	assert(!OBBOBB(OBB{vec3{0,0,0}, vec3{1,1,1}}, OBB{vec3{0,3.5f,0}, vec3{1,1,1}, YRotation3x3(45)}));
+
+	// resting cube sunk 0.1 into the one bellow is pushed up
+	CollisionManifold m = FindCollisionFeatures(a, AABB{vec3{0.2f,1.9f,0}, vec3{1,1,1}});
+	assert(m.colliding);
+	assert(ApproxEqual(m.normal, vec3(0,1,0)));
+	assert(CMP(m.depth, 0.1f));
+
+	m = FindCollisionFeatures(a, AABB{vec3{-1.7f,0.5f,0}, vec3{1,1,1}});
+	assert(m.colliding && m.normal == vec3(-1,0,0) && CMP(m.depth, 0.3f));
+
+	m = FindCollisionFeatures(a, AABB{vec3{0,2.01f,0}, vec3{1,1,1}});
+	assert(!m.colliding);
+
+	// rays hit the nearest face, start inside the box or miss
+	assert(CMP(Raycast(a, Ray{vec3{-5,0.5f,0}, vec3{1,0,0}}), 4.0f));
+	assert(CMP(Raycast(a, Ray{vec3{0,0,0}, vec3{0,1,0}}), 0.0f));
+	assert(Raycast(a, Ray{vec3{-5,0,0}, vec3{-1,0,0}}) < 0);
+	assert(Raycast(a, Ray{vec3{-5,1.5f,0}, vec3{1,0,0}}) < 0);
+	assert(CMP(Raycast(a, FromPoints(vec3{3,3,0}, vec3{0,0,0})), sqrtf(8)));
+
+	// rotated box corner reaches sqrt(2) along x
+	assert(CMP(Raycast(rotated, Ray{vec3{-2,0,0}, vec3{1,0,0}}), 4.3f - sqrtf(2)));
+	assert(Raycast(OBB{vec3{2.3f,0,0}, vec3{1,1,1}, YRotation3x3(45)}, Ray{vec3{-2,1.2f,0}, vec3{1,0,0}}) < 0);
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,111 @@
+// cube physics test, cube sleeping on a sleeping pile falls when the pile respawns
+// and both broadphases find the same neighbours
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "job_system.hpp"
+#include "cube_physics.hpp"
+
+using std::cout, std::endl;
+using std::vector;
+using phys::vec3;
+
+constexpr float dt = 1/60.f,
+	h = cube_rules::half_size;  // unit scale cubes
+
+//! steps simulation for given time
+void step_for(cube_physics & physics, vector<cube_object> & cubes, float seconds)
+{
+	vector<uint8_t> respawned;
+	for (float t = 0; t < seconds; t += dt)
+		physics.step(cubes, dt, respawned);
+}
+
+void test_stacked_for_each_broadphase(cube_physics::broadphase_method method)
+{
+	job_system jobs{2};
+	cube_physics physics{jobs};
+	physics.broadphase(method);
+
+	// bottom cube lands and falls asleep on its own island
+	vector<cube_object> cubes = {cube_object{vec3{0, 1, 0}, 1.0f}};
+	step_for(physics, cubes, 1.0f);
+	assert(physics.stats().sleeping == 1);
+	assert(std::fabs(cubes[0].position.y - h) < 0.01f);
+
+	// the second cube lands on the sleeping one and falls asleep too
+	cubes.push_back(cube_object{vec3{0, 1, 0}, 1.0f});
+	step_for(physics, cubes, 1.0f);
+	assert(physics.stats().sleeping == 2);
+	assert(std::fabs(cubes[1].position.y - 3*h) < 0.01f);
+
+	// bottom cube respawns first (see sleep_lifetime), the top one needs to fall down
+	vector<uint8_t> respawned;
+	float t = 0;
+	for (; t < 2*cube_physics::sleep_lifetime; t += dt)
+	{
+		physics.step(cubes, dt, respawned);
+		if (respawned[0])
+			break;
+	}
+	assert(respawned[0] && !respawned[1]);
+
+	step_for(physics, cubes, 0.5f);
+	assert(std::fabs(cubes[1].position.y - h) < 0.01f && "cube left floating above respawned pile");
+}
+
+//! cubes in a row with growing gaps (up to 0.2, broadphase margin is 0.05) in the air
+unsigned contacts_for_broadphase(cube_physics::broadphase_method method)
+{
+	job_system jobs{2};
+	cube_physics physics{jobs};
+	physics.broadphase(method);
+
+	vector<cube_object> cubes;
+	float x = 0;
+	for (int i = 0; i < 20; ++i)
+	{
+		cubes.push_back(cube_object{vec3{x, 5, 0}, 1.0f});
+		x += 2*h + 0.0045f + 0.01f*i;
+	}
+
+	vector<uint8_t> respawned;
+	physics.step(cubes, dt, respawned);
+	return physics.stats().contacts;
+}
+
+//! deep overlap is pushed out over more steps, cube stays in culling bounds
+void test_correction_limit()
+{
+	job_system jobs{2};
+	cube_physics physics{jobs};
+
+	vector<cube_object> cubes = {cube_object{vec3{0, 5, 0}, 1.3f}, cube_object{vec3{0.01f, 5, 0}, 1.3f}};
+	vector<cube_object> const start = cubes;
+	vector<uint8_t> respawned;
+	physics.step(cubes, dt, respawned);
+
+	float const limit = cube_fall(start[0], dt) + cube_physics::max_correction(dt) + 1e-5f;
+	for (size_t i = 0; i < cubes.size(); ++i)
+	{
+		vec3 const d = cubes[i].position - start[i].position;
+		assert(std::fabs(d.x) <= limit && std::fabs(d.y) <= limit && std::fabs(d.z) <= limit);
+	}
+
+	step_for(physics, cubes, 0.5f);
+	assert(std::fabs(cubes[0].position.x - cubes[1].position.x) >= 2*1.3f*h - 0.01f);
+}
+
+int main(int argc, char * argv[])
+{
+	test_correction_limit();
+
+	assert(contacts_for_broadphase(cube_physics::broadphase_method::spatial_hash) ==
+		contacts_for_broadphase(cube_physics::broadphase_method::sweep_and_prune));
+
+	test_stacked_for_each_broadphase(cube_physics::broadphase_method::spatial_hash);
+	test_stacked_for_each_broadphase(cube_physics::broadphase_method::sweep_and_prune);
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,79 @@
+// phys matrices test, rigid and affine inverses against the general one
+#include <iostream>
+#include <random>
+#include <cmath>
+#include <cassert>
+#include "phys/matrices.h"
+
+using std::cout, std::endl;
+using phys::vec3,
+	phys::mat4,
+	phys::dmat4,
+	phys::transform,
+	phys::transform_kind,
+	phys::Combined,
+	phys::Inverse,
+	phys::RigidInverse,
+	phys::AffineInverse,
+	phys::Transform,
+	phys::LookAt,
+	phys::TaggedTranslation,
+	phys::TaggedScale,
+	phys::TaggedTransform,
+	phys::TaggedLookAt,
+	phys::ApproxEqual;
+
+static_assert(Combined(transform_kind::rigid, transform_kind::affine) == transform_kind::affine);
+static_assert(Combined(transform_kind::general, transform_kind::rigid) == transform_kind::general);
+
+int main(int argc, char * argv[])
+{
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> coord{-50, 50}, angle{0, 360}, scale{0.1f, 4};
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		vec3 const position{coord(rand), coord(rand), coord(rand)},
+			rotation{angle(rand), angle(rand), angle(rand)};
+
+		mat4 const rigid = Transform(vec3{1, 1, 1}, rotation, position),
+			affine = Transform(vec3{scale(rand), scale(rand), scale(rand)}, rotation, position),
+			view = LookAt(position, vec3{coord(rand), coord(rand), coord(rand)}, vec3{0, 1, 0});
+
+		assert(ApproxEqual(RigidInverse(rigid), Inverse(rigid)));
+		assert(ApproxEqual(RigidInverse(view), Inverse(view)));
+		assert(ApproxEqual(AffineInverse(rigid), Inverse(rigid)));
+		assert(ApproxEqual(AffineInverse(affine), Inverse(affine)));
+		assert(ApproxEqual(affine * AffineInverse(affine), mat4{}));
+
+		assert(Inverse(affine, transform_kind::affine) == AffineInverse(affine));
+		assert(Inverse(view, transform_kind::rigid) == RigidInverse(view));
+		assert(Inverse(affine, transform_kind::general) == Inverse(affine));
+
+		// kind carried by transform
+		transform const tagged_rigid = TaggedTransform(vec3{1, 1, 1}, rotation, position),
+			tagged_view = TaggedLookAt(position, vec3{0, 0, 0}, vec3{0, 1, 0}),
+			tagged_affine = TaggedScale(vec3{scale(rand), scale(rand), scale(rand)}) * tagged_rigid;
+		assert(tagged_rigid.kind == transform_kind::rigid && tagged_rigid.matrix == rigid);
+		assert((tagged_view * TaggedTranslation(position)).kind == transform_kind::rigid);
+		assert(tagged_affine.kind == transform_kind::affine);
+		assert(Inverse(tagged_view).kind == transform_kind::rigid);
+		assert(Inverse(tagged_view).matrix == RigidInverse(tagged_view.matrix));
+		assert(Inverse(tagged_affine).matrix == AffineInverse(tagged_affine.matrix));
+		assert(ApproxEqual(Inverse(tagged_affine).matrix, Inverse(tagged_affine.matrix)));
+
+		// double precision path
+		dmat4 const daffine{affine};
+		assert(ApproxEqual(daffine * AffineInverse(daffine), dmat4{}, 1e-9));
+		assert(ApproxEqual(mat4(RigidInverse(dmat4{rigid})), RigidInverse(rigid)));
+	}
+
+	assert(transform{}.kind == transform_kind::rigid && transform{}.matrix == mat4{});
+
+	// singular linear part is not checked (no branch), inverse is not finite
+	mat4 const flat = Transform(vec3{1, 0, 1}, vec3{0, 0, 0}, vec3{1, 2, 3});
+	assert(!std::isfinite(AffineInverse(flat)._11) || !std::isfinite(AffineInverse(flat)._22));
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,37 @@
+// software occlusion culler test, big box in front of the camera hides small boxes behind it
+#include <iostream>
+#include <cassert>
+#include "phys/matrices.h"
+#include "occlusion_culler.hpp"
+
+using std::cout, std::endl;
+using phys::vec3,
+	phys::mat4,
+	phys::LookAt,
+	phys::Projection;
+
+int main(int argc, char * argv[])
+{
+	mat4 V = LookAt(vec3{0,0,-10}, vec3{0,0,0}, vec3{0,1,0}),
+		P = Projection(60, 2.0f, 0.01f, 1000.0f);
+
+	occlusion_culler c;
+	c.begin(V*P);
+	c.draw_occluder(occlusion_culler::box{vec3{-2,-2,-1}, vec3{2,2,1}});
+	c.build_hiz();
+
+	float const * depth = c.depth();
+	float const center = depth[(occlusion_culler::height/2)*occlusion_culler::width + occlusion_culler::width/2];
+	assert(center < 1.0f && "occluder not rasterized");
+	assert(depth[0] == 1.0f && "occluder too big");
+
+	assert(!c.visible(occlusion_culler::box{vec3{-0.5f,-0.5f,4}, vec3{0.5f,0.5f,5}}));  // hidden behind
+	assert(c.visible(occlusion_culler::box{vec3{-0.5f,-0.5f,-5}, vec3{0.5f,0.5f,-4}}));  // in front
+	assert(c.visible(occlusion_culler::box{vec3{6,-0.5f,4}, vec3{7,0.5f,5}}));  // next to occluder
+	assert(c.visible(occlusion_culler::box{vec3{-5,-0.5f,4}, vec3{5,0.5f,5}}));  // partially hidden
+	assert(!c.visible(occlusion_culler::box{vec3{-0.5f,-0.5f,-20}, vec3{0.5f,0.5f,-19}}));  // behind camera
+	assert(c.visible(occlusion_culler::box{vec3{-0.5f,-0.5f,-11}, vec3{0.5f,0.5f,-9}}));  // crosses near plane
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,59 @@
+// phys quaternion test, rotations need to match matrices.h
+#include <iostream>
+#include <cassert>
+#include "phys/Compare.h"
+#include "phys/quaternion.h"
+
+using std::cout, std::endl;
+using phys::vec3,
+	phys::mat3,
+	phys::quat,
+	phys::AngleAxis,
+	phys::AxisAngle3x3,
+	phys::YRotation3x3,
+	phys::ToMat3,
+	phys::MultiplyVector,
+	phys::Integrate,
+	phys::DEG2RAD,
+	phys::ApproxEqual,
+	phys::AlmostEqualRelativeAndAbs;  // CMP
+
+bool equal(mat3 const & a, mat3 const & b)
+{
+	for (int i = 0; i < 9; ++i)
+		if (!CMP(a.asArray[i], b.asArray[i]))
+			return false;
+	return true;
+}
+
+int main(int argc, char * argv[])
+{
+	vec3 const axis = Normalized(vec3{1, 2, 3});
+	quat const q = AngleAxis(axis, 50);
+	assert(ApproxEqual(Magnitude(q), 1.0f, 0.005f));
+	assert(q == q && q != Conjugate(q));
+	assert(ApproxEqual(q * Conjugate(q), quat{}));
+	assert(equal(ToMat3(q), AxisAngle3x3(axis, 50)));
+	assert(equal(ToMat3(quat{}), mat3{}));
+
+	// rotated vector matches row vector times matrix
+	vec3 const v{0.5f, -1, 2};
+	assert(ApproxEqual(MultiplyVector(v, q), MultiplyVector(v, ToMat3(q))));
+	assert(ApproxEqual(MultiplyVector(MultiplyVector(v, q), Conjugate(q)), v));
+
+	// l * r rotates by r first
+	quat const r = AngleAxis(vec3{0,1,0}, 30);
+	assert(equal(ToMat3(q * r), ToMat3(r) * ToMat3(q)));
+	assert(equal(ToMat3(r), YRotation3x3(30)));
+
+	// 90 degrees per second around y for one second in small steps
+	quat spin;
+	for (int i = 0; i < 1000; ++i)
+		spin = Integrate(spin, vec3{0, DEG2RAD(90), 0}, 0.001f);
+	assert(ApproxEqual(Magnitude(spin), 1.0f, 0.005f));
+	assert(ApproxEqual(spin, AngleAxis(vec3{0,1,0}, 90)));
+	assert(ApproxEqual(MultiplyVector(vec3{1,0,0}, spin), MultiplyVector(vec3{1,0,0}, AngleAxis(vec3{0,1,0}, 90))));
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,80 @@
+// render queue sort and submit order test
+#include <random>
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include "glt/render_queue.hpp"
+
+using std::vector;
+using std::default_random_engine,
+	std::uniform_real_distribution;
+using std::cout, std::endl;
+using glt::render_queue,
+	glt::state_cache;
+
+namespace sort_key = glt::sort_key;
+
+vector<int> binds;  // program (1xx), mesh (2xx) and material (3xx) binds in order
+vector<float> depths;  // drawn item depths in order
+
+void draw(state_cache &, void const * data)
+{
+	depths.push_back(*(float const *)data);
+}
+
+int main(int argc, char * argv[])
+{
+	render_queue q;
+	unsigned p1 = q.add_program([](state_cache &){binds.push_back(101);}),
+		p2 = q.add_program([](state_cache &){binds.push_back(102);}),
+		m1 = q.add_mesh([](state_cache &){binds.push_back(201);}),
+		mat1 = q.add_material([](state_cache &){binds.push_back(301);});
+
+	assert(sort_key::program(sort_key::make(3, p2, m1, mat1, 0.5f)) == p2);
+	assert(sort_key::mesh(sort_key::make(3, p2, m1, mat1, 0.5f)) == m1);
+	assert(sort_key::material(sort_key::make(3, p2, m1, mat1, 0.5f)) == mat1);
+	assert(sort_key::layer(sort_key::make(3, p2, m1, mat1, 0.5f)) == 3);
+
+	default_random_engine rand{1};
+	uniform_real_distribution<float> depth_dist{0, 1};
+	vector<float> item_depths(1000);
+	for (float & d : item_depths)
+		d = depth_dist(rand);
+
+	// interleave two programs, overlay layer pushed first
+	float overlay_depth = 0;
+	q.push(sort_key::make(1, 0, 0, 0, overlay_depth), draw, &overlay_depth);
+	for (size_t i = 0; i < item_depths.size(); ++i)
+		q.push(sort_key::make(0, (i % 2) ? p2 : p1, m1, mat1, item_depths[i]), draw, &item_depths[i]);
+
+	q.sort();
+
+	for (size_t i = 1; i < q.items().size(); ++i)
+		assert(q.items()[i-1].key <= q.items()[i].key);
+
+	state_cache state;  // not touched by our bind and draw functions
+	q.submit(state);
+
+	// each program (and its mesh and material) bound only once
+	assert((binds == vector<int>{101, 201, 301, 102, 201, 301}));
+
+	// front to back within a program, overlay last
+	assert(depths.size() == item_depths.size() + 1);
+	for (size_t i = 1; i < 500; ++i)
+		assert(depths[i-1] <= depths[i]);
+	assert(depths.back() == overlay_depth);
+
+	// pass around each program run
+	vector<int> passes;  // begin (+program) and end (-program) in order
+	binds.clear();
+	depths.clear();
+	q.submit(state, [&](unsigned program, bool begin){
+		passes.push_back(begin ? int(program) : -int(program));
+		assert(binds.empty() || !begin || binds.back() != int(100 + program));  // before program bind
+	});
+	assert((passes == vector<int>{int(p1), -int(p1), int(p2), -int(p2), 0, 0}));
+	assert(depths.size() == item_depths.size() + 1);
+
+	cout << "done!" << endl;
+	return 0;
+}
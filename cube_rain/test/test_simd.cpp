@@ -0,0 +1,64 @@
+// phys SIMD types test, results need to match scalar vectors.h and matrices.h
+#include <iostream>
+#include <cassert>
+#include "phys/Compare.h"
+#include "phys/simd.h"
+
+using std::cout, std::endl;
+using phys::vec3,
+	phys::mat4,
+	phys::simd_vec4,
+	phys::simd_mat4,
+	phys::Splat,
+	phys::Transform,
+	phys::LookAt,
+	phys::Projection,
+	phys::ApproxEqual,
+	phys::AlmostEqualRelativeAndAbs;  // CMP
+
+int main(int argc, char * argv[])
+{
+	vec3 const a{1, 2, 3},
+		b{-4, 5, 0.5f};
+	simd_vec4 const sa{a},
+		sb{b};
+
+	// conversions are lossless
+	simd_vec4 const p{a, 1};
+	assert(p[0] == a.x && p[1] == a.y && p[2] == a.z && p[3] == 1);
+	assert(p == simd_vec4(1, 2, 3, 1) && p != sa);
+	assert(Splat<2>(p) == simd_vec4{3});
+
+	assert(vec3(sa + sb) == a + b);
+	assert(vec3(sa - sb) == a - b);
+	assert(vec3(sa * sb) == a * b);
+	assert(vec3(sa / sb) == a / b);
+	assert(vec3(sa * 2.0f) == a * 2.0f);
+	assert(vec3(-sa) == a * -1.0f);
+	assert(Dot(sa, sb) == Dot(a, b));
+	assert(vec3(Cross(sa, sb)) == Cross(a, b) && Cross(sa, sb)[3] == 0);
+	assert(ApproxEqual(vec3(Normalized(sa)), Normalized(a)));
+	assert(Magnitude(sa) == Magnitude(a));
+
+	mat4 const M = Transform(vec3{1, 2, 3}, vec3{0, 1, 0}, 30.0f, vec3{5, 6, 7}),
+		VP = LookAt(vec3{1, 2, 3}, vec3{4, 0, -1}, vec3{0, 1, 0}) * Projection(60, 1.5f, 0.1f, 100);
+	simd_mat4 const sM{M},
+		sVP{VP};
+
+	mat4 const back = mat4(sM);
+	for (int i = 0; i < 16; ++i)
+		assert(back.asArray[i] == M.asArray[i]);
+	assert(simd_mat4{} == simd_mat4{mat4{}});
+
+	assert(ApproxEqual(mat4(sM * sVP), M * VP));
+	assert(mat4(Transpose(sM)) == Transpose(M));
+	assert(ApproxEqual(vec3(MultiplyPoint(sa, sM)), MultiplyPoint(a, M)));
+	assert(ApproxEqual(vec3(MultiplyVector(sa, sM)), MultiplyVector(a, M)));
+
+	// row vector times matrix keeps w for perspective divide
+	simd_vec4 const clip = p * sVP;
+	assert(CMP(clip[3], a.x*VP._14 + a.y*VP._24 + a.z*VP._34 + VP._44));
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,90 @@
+// stream buffer test, maps past capacity in one frame keep earlier frame data (hidden OpenGL ES 3.0 window)
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+#include <cassert>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "glt/features.hpp"
+#include "glt/stream_buffer.hpp"
+
+using std::cout, std::endl;
+using std::vector;
+using glt::stream_buffer;
+
+//! reads count floats at offset back from buffer
+vector<float> read_back(stream_buffer const & buf, GLintptr offset, size_t count)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buf.id());
+	float const * p = (float const *)glMapBufferRange(GL_ARRAY_BUFFER, offset, count*sizeof(float),
+		GL_MAP_READ_BIT);
+	assert(p);
+	vector<float> result{p, p + count};
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	return result;
+}
+
+//! maps count floats set to value
+GLintptr write(stream_buffer & buf, size_t count, float value)
+{
+	glt::span<float> data = buf.map<float>(count);
+	for (float & f : data)
+		f = value;
+	return buf.unmap();
+}
+
+int main(int argc, char * argv[])
+{
+	glfwInit();
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_ES_API);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+	GLFWwindow * window = glfwCreateWindow(64, 64, __FILE__, nullptr, nullptr);
+	assert(window && "OpenGL ES 3.0 context needed");
+	glfwMakeContextCurrent(window);
+	glewInit();
+	glt::init_features();
+
+	{
+		stream_buffer buf{GL_ARRAY_BUFFER, 64*sizeof(float)};
+		size_t const n = 100;  // each map alone is past capacity
+
+		for (int frame = 0; frame < 2*stream_buffer::region_count; ++frame)
+		{
+			buf.reserve(2*stream_buffer::map_size<float>(n));
+			GLintptr const first = write(buf, n, 1.0f + frame),
+				second = write(buf, n, 100.0f + frame);
+
+			assert(buf.region_size() >= 2*stream_buffer::map_size<float>(n));
+			assert((read_back(buf, first, n) == vector<float>(n, 1.0f + frame)));
+			assert((read_back(buf, second, n) == vector<float>(n, 100.0f + frame)));
+			buf.end_frame();
+		}
+
+		// without reserve() second map past capacity would orphan the first one
+		size_t const region = buf.region_size();
+		write(buf, region/sizeof(float)/2, 1.0f);
+		bool thrown = false;
+		try {
+			write(buf, region/sizeof(float), 2.0f);
+		}
+		catch (std::length_error const &) {
+			thrown = true;
+		}
+		assert(thrown && buf.region_size() == region);
+		buf.end_frame();
+
+		// the first map in a frame grows buffer itself
+		GLintptr const offset = write(buf, region/sizeof(float)*2, 3.0f);
+		assert(buf.region_size() > region);
+		assert((read_back(buf, offset, region/sizeof(float)*2) == vector<float>(region/sizeof(float)*2, 3.0f)));
+		buf.end_frame();
+	}
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,90 @@
+// phys vectors test, fast normalization against the exact one and fused operations
+#include <iostream>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cassert>
+#include "phys/simd.h"
+
+using std::cout, std::endl;
+using std::vector;
+using phys::vec3,
+	phys::simd_vec4,
+	phys::NormalizedFast,
+	phys::NormalizeArray,
+	phys::Madd,
+	phys::Lerp;
+using phys::mat4,
+	phys::affine,
+	phys::Transform,
+	phys::Scale,
+	phys::Translation,
+	phys::ScaleTranslate,
+	phys::AffineMul;
+
+constexpr float fast_error = 4e-7f;  // documented bound for fast normalization
+
+bool close(vec3 const & a, vec3 const & b)
+{
+	return std::fabs(a.x - b.x) <= 2*fast_error
+		&& std::fabs(a.y - b.y) <= 2*fast_error
+		&& std::fabs(a.z - b.z) <= 2*fast_error;
+}
+
+float length_error(vec3 const & n)
+{
+	return (float)std::fabs(std::sqrt((double)n.x*n.x + (double)n.y*n.y + (double)n.z*n.z) - 1.0);
+}
+
+int main(int argc, char * argv[])
+{
+	std::default_random_engine rand;
+	std::uniform_real_distribution<float> coord{-1, 1},
+		exponent{-20, 20};
+
+	vector<vec3> vs(1001);  // not multiple of 4, tail goes scalar path
+	for (vec3 & v : vs)
+	{
+		float const scale = std::exp2(exponent(rand));
+		v = vec3{coord(rand), coord(rand), coord(rand)} * scale;
+	}
+
+	vector<vec3> batch = vs;
+	NormalizeArray(batch.data(), batch.size());
+
+	for (size_t i = 0; i < vs.size(); ++i)
+	{
+		vec3 const exact = Normalized(vs[i]),
+			fast = NormalizedFast(vs[i]);
+
+		assert(length_error(exact) <= 2e-7f);
+		assert(length_error(fast) <= fast_error);
+		assert(close(fast, exact));
+		assert(length_error(batch[i]) <= fast_error);
+		assert(close(batch[i], exact));
+
+		vec3 const simd = vec3(NormalizedFast(simd_vec4{vs[i]}));
+		assert(length_error(simd) <= fast_error);
+		assert(close(simd, exact));
+	}
+
+	// zero vector is NaN like the exact version
+	vec3 const zero = NormalizedFast(vec3{0, 0, 0});
+	assert(std::isnan(zero.x) && std::isnan(Normalized(vec3{0, 0, 0}).x));
+
+	// fused operations match the operator chains they replace
+	vec3 const a{1, -2, 3}, b{0.5f, 4, -1};
+	assert(ApproxEqual(Madd(a, 0.25f, b), a * 0.25f + b));
+	assert(ApproxEqual(Madd(a, b, b), a * b + b));
+	assert(Lerp(a, b, 0.0f) == a && ApproxEqual(Lerp(a, b, 1.0f), b));
+	assert(ApproxEqual(Lerp(a, b, 0.5f), (a + b) * 0.5f));
+
+	mat4 const R = Transform(vec3{1, 1, 1}, vec3{0, 1, 0}, 30.0f, vec3{1, 2, 3});
+	assert(ScaleTranslate(vec3{2, 3, 4}, b) == Scale(vec3{2, 3, 4}) * Translation(b));
+	assert(ApproxEqual(mat4(AffineMul(affine{R}, affine{Scale(vec3{2, 2, 2})})), R * Scale(vec3{2, 2, 2})));
+	assert(ApproxEqual(MultiplyPoint(a, affine{R}), MultiplyPoint(a, R)));
+	assert(mat4(affine{R}) == R);
+
+	cout << "done!" << endl;
+	return 0;
+}
@@ -0,0 +1,33 @@
+#include <vector>
+#include "triangle_normals.hpp"
+
+using std::vector;
+using phys::vec3,
+	phys::NormalizeArray;
+
+void calc_triangle_normals(float const * positions, size_t triangle_count, float * normals)
+{
+	vector<vec3> face_normals(triangle_count);
+	for (size_t i = 0; i < triangle_count; ++i)
+	{
+		size_t idx = 3*3*i;
+		vec3 v1{positions[idx], positions[idx+1], positions[idx+2]},
+			v2{positions[idx+3], positions[idx+4], positions[idx+5]},
+			v3{positions[idx+6], positions[idx+7], positions[idx+8]};
+			
+		face_normals[i] = Cross(v3 - v1, v2 - v1);  // do oposite cross for left hand coordinate system
+	}
+
+	NormalizeArray(face_normals.data(), triangle_count);
+
+	float * p = normals;
+	for (vec3 const & n : face_normals)
+	{
+		for (size_t j = 0; j < 3; ++j)  // for all three vertices
+		{
+			*p++ = n.x;
+			*p++ = n.y;
+			*p++ = n.z;
+		}
+	}
+}
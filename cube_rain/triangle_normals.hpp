@@ -0,0 +1,9 @@
+#pragma once
+#include <cstddef>
+#include "phys/vectors.h"
+
+/*! Flat shading normals, each of the three triangle vertices gets the triangle
+normal (left hand coordinate system).
+\param positions triangle_count*9 floats (xyz for each vertex)
+\param normals output of the same size as positions */
+void calc_triangle_normals(float const * positions, size_t triangle_count, float * normals);